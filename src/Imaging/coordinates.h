@@ -1,7 +1,11 @@
 #if !defined(COORDINATES_H)
 #define COORDINATES_H
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
 
 #include "utilities.h"
 
@@ -146,6 +150,14 @@ namespace Imaging
 		Region<T, U> operator*(const Point2D<double> &zm) const;
 		Region<T, U> operator*(double zm) const;
 
+		/** Returns the intersection with another region, which is empty if the regions do
+		not overlap. */
+		Region<T, U> operator&(const Region<T, U> &rhs) const;
+
+		/** Returns the bounding box of this region and another region. An empty region
+		is ignored. */
+		Region<T, U> operator|(const Region<T, U> &rhs) const;
+
 		////////////////////////////////////////////////////////////////////////////////////
 		// Methods.
 
@@ -158,11 +170,80 @@ namespace Imaging
 		void Zoom(const Point2D<double> &zm);
 		void Zoom(double zm);
 
+		bool IsEmpty(void) const;
+		bool Contains(const Point2D<T> &pt) const;
+		bool Contains(const Region<T, U> &roi) const;
+		bool Intersects(const Region<T, U> &roi) const;
+
+		/** Shrinks this region to the intersection with the bounds. */
+		void Clip(const Region<T, U> &bounds);
+
+		/** Shrinks this region to an image of the given size placed at (0, 0). */
+		void Clip(U width, U height);
+
 		////////////////////////////////////////////////////////////////////////////////////
 		// Data.
 		Point2D<T> origin;
 		Size2D<U> size;
 	};
+
+	/** A tile of a filter, where the pixels of region are computed from the pixels of
+	input, i.e., region with a halo clipped by the image. */
+	template <typename T, typename U>
+	struct RegionTile
+	{
+		Region<T, U> region;
+		Region<T, U> input;
+	};
+
+	/** The number of bytes of a tile including its halo, which is a half of a typical L2
+	cache so the source and the destination of a tile stay in the cache. */
+	const ::size_t DEFAULT_TILE_BYTES = 128 * 1024;
+
+	/** Returns the number of tiles of an ROI, placed from the origin of the ROI.
+
+	@exception std::invalid_argument	if a side of the tile is zero */
+	template <typename T, typename U>
+	::size_t GetTileCount(const Region<T, U> &roi, const Size2D<U> &tileSize);
+
+	/** Returns the tile at an index in row-major order, where the tiles at the right and
+	the bottom edges are clipped by the ROI. */
+	template <typename T, typename U>
+	Region<T, U> GetTile(const Region<T, U> &roi, const Size2D<U> &tileSize,
+		::size_t index);
+
+	/** Splits an ROI into tiles in row-major order. */
+	template <typename T, typename U>
+	std::vector<Region<T, U> > SplitIntoTiles(const Region<T, U> &roi,
+		const Size2D<U> &tileSize);
+
+	/** Splits an ROI into tiles for a filter reading halo pixels around every pixel, where
+	the input of a tile is clipped by the bounds, e.g., the entire image. */
+	template <typename T, typename U>
+	std::vector<RegionTile<T, U> > SplitIntoTiles(const Region<T, U> &roi,
+		const Size2D<U> &tileSize, U halo, const Region<T, U> &bounds);
+
+	/** Returns a tile size for an ROI so a tile with its halo fits in nBytesCache bytes.
+
+	A tile spans the entire width of the ROI if the tile has 8 rows or more, so the lines
+	of a tile are continuous in memory. Otherwise, a tile is a square. */
+	template <typename U>
+	Size2D<U> GetCacheTileSize(const Size2D<U> &roiSize, ::size_t nBytesPerPixel,
+		U halo = 0, ::size_t nBytesCache = DEFAULT_TILE_BYTES);
+
+	/** Sorts regions in raster order of their origins, so the lines of an image are
+	accessed forward. */
+	template <typename T, typename U>
+	void SortRegions(std::vector<Region<T, U> > &rois);
+
+	/** Merges regions which overlap or are separated by up to maxGap pixels into their
+	bounding boxes, until no two boxes are that close. The boxes are returned in raster
+	order.
+
+	A small gap trades reading a few extra pixels for fewer and larger reads. */
+	template <typename T, typename U>
+	std::vector<Region<T, U> > MergeRegions(const std::vector<Region<T, U> > &rois,
+		U maxGap = 0);
 }
 
 #include "coordinates_inl.h"
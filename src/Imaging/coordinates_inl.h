@@ -254,6 +254,37 @@ namespace Imaging
 		return dst;
 	}
 
+	template <typename T, typename U>
+	Region<T, U> Region<T, U>::operator&(const Region<T, U> &rhs) const
+	{
+		const T x0 = std::max(this->origin.x, rhs.origin.x);
+		const T y0 = std::max(this->origin.y, rhs.origin.y);
+		const T x1 = std::min(this->origin.x + static_cast<T>(this->size.width),
+			rhs.origin.x + static_cast<T>(rhs.size.width));
+		const T y1 = std::min(this->origin.y + static_cast<T>(this->size.height),
+			rhs.origin.y + static_cast<T>(rhs.size.height));
+		if (x1 <= x0 || y1 <= y0)
+			return Region<T, U>(x0, y0, 0, 0);
+		return Region<T, U>(x0, y0, static_cast<U>(x1 - x0), static_cast<U>(y1 - y0));
+	}
+
+	template <typename T, typename U>
+	Region<T, U> Region<T, U>::operator|(const Region<T, U> &rhs) const
+	{
+		if (rhs.IsEmpty())
+			return *this;
+		if (this->IsEmpty())
+			return rhs;
+
+		const T x0 = std::min(this->origin.x, rhs.origin.x);
+		const T y0 = std::min(this->origin.y, rhs.origin.y);
+		const T x1 = std::max(this->origin.x + static_cast<T>(this->size.width),
+			rhs.origin.x + static_cast<T>(rhs.size.width));
+		const T y1 = std::max(this->origin.y + static_cast<T>(this->size.height),
+			rhs.origin.y + static_cast<T>(rhs.size.height));
+		return Region<T, U>(x0, y0, static_cast<U>(x1 - x0), static_cast<U>(y1 - y0));
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////
 	// Methods.
 
@@ -282,5 +313,206 @@ namespace Imaging
 	{
 		RoundAs(this->size * zm, this->size);
 	}
+
+	template <typename T, typename U>
+	bool Region<T, U>::IsEmpty(void) const
+	{
+		return !(this->size.width > 0 && this->size.height > 0);
+	}
+
+	template <typename T, typename U>
+	bool Region<T, U>::Contains(const Point2D<T> &pt) const
+	{
+		return pt.x >= this->origin.x && pt.y >= this->origin.y &&
+			pt.x < this->origin.x + static_cast<T>(this->size.width) &&
+			pt.y < this->origin.y + static_cast<T>(this->size.height);
+	}
+
+	template <typename T, typename U>
+	bool Region<T, U>::Contains(const Region<T, U> &roi) const
+	{
+		return roi.IsEmpty() || (roi.origin.x >= this->origin.x &&
+			roi.origin.y >= this->origin.y &&
+			roi.origin.x + static_cast<T>(roi.size.width) <=
+			this->origin.x + static_cast<T>(this->size.width) &&
+			roi.origin.y + static_cast<T>(roi.size.height) <=
+			this->origin.y + static_cast<T>(this->size.height));
+	}
+
+	template <typename T, typename U>
+	bool Region<T, U>::Intersects(const Region<T, U> &roi) const
+	{
+		return !(*this & roi).IsEmpty();
+	}
+
+	template <typename T, typename U>
+	void Region<T, U>::Clip(const Region<T, U> &bounds)
+	{
+		*this = *this & bounds;
+	}
+
+	template <typename T, typename U>
+	void Region<T, U>::Clip(U width, U height)
+	{
+		this->Clip(Region<T, U>(0, 0, width, height));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	template <typename T, typename U>
+	::size_t GetTileCount(const Region<T, U> &roi, const Size2D<U> &tileSize)
+	{
+		if (!(tileSize.width > 0 && tileSize.height > 0))
+			throw std::invalid_argument("A side of the tile is zero.");
+		if (roi.IsEmpty())
+			return 0;
+
+		const ::size_t nTilesX = static_cast< ::size_t>((roi.size.width - 1) / tileSize.width) + 1;
+		const ::size_t nTilesY =
+			static_cast< ::size_t>((roi.size.height - 1) / tileSize.height) + 1;
+		return nTilesX * nTilesY;
+	}
+
+	template <typename T, typename U>
+	Region<T, U> GetTile(const Region<T, U> &roi, const Size2D<U> &tileSize,
+		::size_t index)
+	{
+		const ::size_t nTilesX = static_cast< ::size_t>((roi.size.width - 1) / tileSize.width) + 1;
+		const U x = static_cast<U>(index % nTilesX) * tileSize.width;
+		const U y = static_cast<U>(index / nTilesX) * tileSize.height;
+		return Region<T, U>(roi.origin.x + static_cast<T>(x), roi.origin.y + static_cast<T>(y),
+			std::min(tileSize.width, static_cast<U>(roi.size.width - x)),
+			std::min(tileSize.height, static_cast<U>(roi.size.height - y)));
+	}
+
+	template <typename T, typename U>
+	std::vector<Region<T, U> > SplitIntoTiles(const Region<T, U> &roi,
+		const Size2D<U> &tileSize)
+	{
+		const ::size_t nTiles = GetTileCount(roi, tileSize);
+		std::vector<Region<T, U> > tiles;
+		tiles.reserve(nTiles);
+		for (::size_t N = 0; N != nTiles; ++N)
+			tiles.push_back(GetTile(roi, tileSize, N));
+		return tiles;
+	}
+
+	/** The halo is subtracted only if the origin stays in the bounds, so an unsigned origin
+	never wraps around. */
+	template <typename T, typename U>
+	std::vector<RegionTile<T, U> > SplitIntoTiles(const Region<T, U> &roi,
+		const Size2D<U> &tileSize, U halo, const Region<T, U> &bounds)
+	{
+		const ::size_t nTiles = GetTileCount(roi, tileSize);
+		std::vector<RegionTile<T, U> > tiles;
+		tiles.reserve(nTiles);
+		for (::size_t N = 0; N != nTiles; ++N)
+		{
+			RegionTile<T, U> tile;
+			tile.region = GetTile(roi, tileSize, N);
+
+			const Region<T, U> &rgn = tile.region;
+			const T x0 = rgn.origin.x > bounds.origin.x + static_cast<T>(halo) ?
+				rgn.origin.x - static_cast<T>(halo) : bounds.origin.x;
+			const T y0 = rgn.origin.y > bounds.origin.y + static_cast<T>(halo) ?
+				rgn.origin.y - static_cast<T>(halo) : bounds.origin.y;
+			const T x1 = rgn.origin.x + static_cast<T>(rgn.size.width + halo);
+			const T y1 = rgn.origin.y + static_cast<T>(rgn.size.height + halo);
+			tile.input = Region<T, U>(x0, y0, 0, 0);
+			if (x1 > x0 && y1 > y0)
+				tile.input = Region<T, U>(x0, y0, static_cast<U>(x1 - x0),
+					static_cast<U>(y1 - y0)) & bounds;
+			tiles.push_back(tile);
+		}
+		return tiles;
+	}
+
+	template <typename U>
+	Size2D<U> GetCacheTileSize(const Size2D<U> &roiSize, ::size_t nBytesPerPixel, U halo,
+		::size_t nBytesCache)
+	{
+		if (nBytesPerPixel == 0)
+			throw std::invalid_argument("A pixel has no bytes.");
+
+		const ::size_t nRowsMin = 8;
+		const ::size_t width = std::max< ::size_t>(static_cast< ::size_t>(roiSize.width), 1);
+		const ::size_t height = std::max< ::size_t>(static_cast< ::size_t>(roiSize.height), 1);
+		const ::size_t nHalo = 2 * static_cast< ::size_t>(halo);
+		const ::size_t nPixels = std::max< ::size_t>(nBytesCache / nBytesPerPixel, 1);
+
+		// Entire lines.
+		const ::size_t nRows = nPixels / (width + nHalo);
+		if (nRows >= nRowsMin + nHalo)
+			return Size2D<U>(static_cast<U>(width), static_cast<U>(std::min(height,
+				nRows - nHalo)));
+
+		// A square.
+		const ::size_t side = static_cast< ::size_t>(std::sqrt(static_cast<double>(nPixels)));
+		const ::size_t sideTile = side >= nRowsMin + nHalo ? side - nHalo : nRowsMin;
+		return Size2D<U>(static_cast<U>(std::min(width, sideTile)),
+			static_cast<U>(std::min(height, sideTile)));
+	}
+
+	template <typename T, typename U>
+	void SortRegions(std::vector<Region<T, U> > &rois)
+	{
+		std::sort(rois.begin(), rois.end(), [](const Region<T, U> &a, const Region<T, U> &b)
+		{
+			if (a.origin.y != b.origin.y)
+				return a.origin.y < b.origin.y;
+			if (a.origin.x != b.origin.x)
+				return a.origin.x < b.origin.x;
+			if (a.size.height != b.size.height)
+				return a.size.height < b.size.height;
+			return a.size.width < b.size.width;
+		});
+	}
+
+	/** The boxes are sorted by the left edges, so a box is compared with the following
+	boxes starting up to maxGap pixels after its right edge. A merged box may come close to
+	a box already passed, so the sweep is repeated until nothing is merged. */
+	template <typename T, typename U>
+	std::vector<Region<T, U> > MergeRegions(const std::vector<Region<T, U> > &rois,
+		U maxGap)
+	{
+		std::vector<Region<T, U> > dst;
+		dst.reserve(rois.size());
+		for (auto it = rois.begin(); it != rois.end(); ++it)
+			if (!it->IsEmpty())
+				dst.push_back(*it);
+
+		const T gap = static_cast<T>(maxGap);
+		bool isMerged = true;
+		while (isMerged)
+		{
+			isMerged = false;
+			std::sort(dst.begin(), dst.end(), [](const Region<T, U> &a, const Region<T, U> &b)
+			{
+				return a.origin.x < b.origin.x;
+			});
+			for (::size_t I = 0; I < dst.size(); ++I)
+			{
+				::size_t J = I + 1;
+				while (J < dst.size() &&
+					dst[J].origin.x <= dst[I].origin.x + static_cast<T>(dst[I].size.width) + gap)
+				{
+					if (dst[J].origin.y <= dst[I].origin.y + static_cast<T>(dst[I].size.height) +
+						gap && dst[I].origin.y <= dst[J].origin.y +
+						static_cast<T>(dst[J].size.height) + gap)
+					{
+						dst[I] = dst[I] | dst[J];
+						dst.erase(dst.begin() + J);
+						isMerged = true;
+					}
+					else
+						++J;
+				}
+			}
+		}
+
+		SortRegions(dst);
+		return dst;
+	}
 }
 #endif
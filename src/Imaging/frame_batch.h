@@ -0,0 +1,93 @@
+#if !defined(FRAME_BATCH_H)
+#define FRAME_BATCH_H
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "image2.h"
+#include "image_processing.h"
+#include "out_of_core_block.h"
+#include "thread_pool.h"
+
+namespace Imaging
+{
+	/** Applies an operation to every frame of a block, or to selected frames, and writes
+	the results into the frames of a destination block, where destination frame n is the
+	result of source frame frames[n].
+
+	Every frame is a task of the shared thread pool, so the pool balances frames of
+	different costs, and an operation running its own parallel loop, e.g., Resize() of a
+	large frame, shares the same threads.
+
+	This overload calls func(frameSrc, frameDst), where func sizes the destination frame
+	by itself. The destination block must not be the source block.
+	@exception std::out_of_range	if a selected frame is out of range */
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src, ImageBlock<U> &dst, Function func);
+
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src,
+		const std::vector<typename ImageBlock<T>::SizeType> &frames, ImageBlock<U> &dst,
+		Function func);
+
+	/** Allocates the destination frames of szDst in advance, and calls func(viewSrc,
+	viewDst) for the views of the frames, so no frame is allocated by the tasks. */
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src, ImageBlock<U> &dst,
+		const Size3D<typename ImageFrame<U>::SizeType> &szDst, Function func);
+
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src,
+		const std::vector<typename ImageBlock<T>::SizeType> &frames, ImageBlock<U> &dst,
+		const Size3D<typename ImageFrame<U>::SizeType> &szDst, Function func);
+
+	/** Reads the selected frames of an out-of-core block batch by batch in order, calls
+	prepare(n0, n1) for a batch of [n0, n1), and then calls func(n, viewSrc) for every
+	frame n of the batch in parallel. The prefetch depth of the block is raised to a batch
+	during the call, so the next batch is read while the batch is processed. */
+	template <typename T, typename Prepare, typename Function>
+	void ForEachFrameBatch(OutOfCoreBlock<T> &src, const std::vector< ::size_t> &frames,
+		::size_t nBatch, Prepare prepare, Function func);
+
+	/** Processes frames of an out-of-core block by ForEachFrameBatch(), where a batch is
+	twice as many frames as the threads, so the block reads the next batch in advance while
+	the threads process a batch. The memory budget should hold two batches, or the pinned
+	frames of a batch exceed the budget. */
+	template <typename T, typename U, typename Function>
+	void TransformFrames(OutOfCoreBlock<T> &src,
+		const std::vector<typename OutOfCoreBlock<T>::SizeType> &frames, ImageBlock<U> &dst,
+		const Size3D<typename ImageFrame<U>::SizeType> &szDst, Function func);
+
+	/** Writes the results into the first frames of another out-of-core block, which
+	writes them back to its file. The destination frames are overwritten without being
+	read, so func must write every element of viewDst.
+
+	@exception std::out_of_range	if the destination block has fewer frames */
+	template <typename T, typename U, typename Function>
+	void TransformFrames(OutOfCoreBlock<T> &src,
+		const std::vector<typename OutOfCoreBlock<T>::SizeType> &frames,
+		OutOfCoreBlock<U> &dst, Function func);
+
+	/** Resizes every frame by the same zoom, where the taps are computed once for all
+	frames by a ResizePlan.
+
+	@exception std::invalid_argument	if the frames have different sizes */
+	template <typename T>
+	void ResizeFrames(const ImageBlock<T> &src, const Point2D<double> &zm,
+		ImageBlock<T> &dst, Interpolation interp = Interpolation::LINEAR);
+
+	/** Returns every step-th frame of n frames from first, e.g., every other band of a
+	cube, or all frames by GetFrames(n).
+
+	@exception std::invalid_argument	if step is zero */
+	std::vector< ::size_t> GetFrames(::size_t n, ::size_t first = 0, ::size_t step = 1);
+
+	/** Throws std::out_of_range if a selected frame is not one of n frames. */
+	void CheckFrames(const std::vector< ::size_t> &frames, ::size_t n);
+}
+
+#include "frame_batch_inl.h"
+
+#endif
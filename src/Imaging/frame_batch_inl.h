@@ -0,0 +1,176 @@
+#if !defined(FRAME_BATCH_INL_H)
+#define FRAME_BATCH_INL_H
+
+namespace Imaging
+{
+	//////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src, ImageBlock<U> &dst, Function func)
+	{
+		TransformFrames(src, GetFrames(src.GetFrameCount()), dst, func);
+	}
+
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src,
+		const std::vector<typename ImageBlock<T>::SizeType> &frames, ImageBlock<U> &dst,
+		Function func)
+	{
+		CheckFrames(frames, src.GetFrameCount());
+		dst.Resize(frames.size());
+		ParallelFor(0, frames.size(), [&](::size_t N)
+		{
+			func(src[frames[N]], dst[N]);
+		}, 1);
+	}
+
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src, ImageBlock<U> &dst,
+		const Size3D<typename ImageFrame<U>::SizeType> &szDst, Function func)
+	{
+		TransformFrames(src, GetFrames(src.GetFrameCount()), dst, szDst, func);
+	}
+
+	template <typename T, typename U, typename Function>
+	void TransformFrames(const ImageBlock<T> &src,
+		const std::vector<typename ImageBlock<T>::SizeType> &frames, ImageBlock<U> &dst,
+		const Size3D<typename ImageFrame<U>::SizeType> &szDst, Function func)
+	{
+		CheckFrames(frames, src.GetFrameCount());
+		dst.Resize(szDst, frames.size(), ResizeMode::UNINITIALIZED);
+		ParallelFor(0, frames.size(), [&](::size_t N)
+		{
+			func(src[frames[N]].GetView(), dst[N].GetView());
+		}, 1);
+	}
+
+	/** The prefetch depth of the block is restored at the end, even if func throws. */
+	template <typename T, typename Prepare, typename Function>
+	void ForEachFrameBatch(OutOfCoreBlock<T> &src, const std::vector< ::size_t> &frames,
+		::size_t nBatch, Prepare prepare, Function func)
+	{
+		const ::size_t nPrefetch = src.GetPrefetchDepth();
+		src.SetPrefetchDepth(std::max(nPrefetch, nBatch));
+		try
+		{
+			std::vector<std::shared_ptr<const ImageFrame<T> > > batch;
+			for (::size_t N0 = 0; N0 < frames.size(); N0 += nBatch)
+			{
+				const ::size_t N1 = std::min(N0 + nBatch, frames.size());
+				batch.clear();
+				for (::size_t N = N0; N != N1; ++N)
+					batch.push_back(src.Read(frames[N]));
+				prepare(N0, N1);
+				ParallelFor(N0, N1, [&](::size_t N)
+				{
+					func(N, batch[N - N0]->GetView());
+				}, 1);
+			}
+		}
+		catch (...)
+		{
+			src.SetPrefetchDepth(nPrefetch);
+			throw;
+		}
+		src.SetPrefetchDepth(nPrefetch);
+	}
+
+	template <typename T, typename U, typename Function>
+	void TransformFrames(OutOfCoreBlock<T> &src,
+		const std::vector<typename OutOfCoreBlock<T>::SizeType> &frames, ImageBlock<U> &dst,
+		const Size3D<typename ImageFrame<U>::SizeType> &szDst, Function func)
+	{
+		CheckFrames(frames, src.GetFrameCount());
+		dst.Resize(szDst, frames.size(), ResizeMode::UNINITIALIZED);
+		ForEachFrameBatch(src, frames, 2 * GetThreadCount(), [](::size_t, ::size_t) {},
+			[&](::size_t N, const ImageView<const T> &view)
+		{
+			func(view, dst[N].GetView());
+		});
+	}
+
+	/** The destination frames of a batch are taken by Overwrite() on the calling thread
+	before the batch is processed, so they are allocated without being read from the file. */
+	template <typename T, typename U, typename Function>
+	void TransformFrames(OutOfCoreBlock<T> &src,
+		const std::vector<typename OutOfCoreBlock<T>::SizeType> &frames,
+		OutOfCoreBlock<U> &dst, Function func)
+	{
+		CheckFrames(frames, src.GetFrameCount());
+		if (frames.size() > dst.GetFrameCount())
+		{
+			std::ostringstream errMsg;
+			errMsg << frames.size() << " frames cannot be written to a block of " <<
+				dst.GetFrameCount() << " frames.";
+			throw std::out_of_range(errMsg.str());
+		}
+
+		const ::size_t nBatch = 2 * GetThreadCount();
+		std::vector<std::shared_ptr<ImageFrame<U> > > batch;
+		ForEachFrameBatch(src, frames, nBatch, [&](::size_t N0, ::size_t N1)
+		{
+			batch.clear();
+			for (::size_t N = N0; N != N1; ++N)
+				batch.push_back(dst.Overwrite(N));
+		}, [&](::size_t N, const ImageView<const T> &view)
+		{
+			func(view, batch[N % nBatch]->GetView());
+		});
+	}
+
+	template <typename T>
+	void ResizeFrames(const ImageBlock<T> &src, const Point2D<double> &zm, ImageBlock<T> &dst,
+		Interpolation interp)
+	{
+		if (src.GetFrameCount() == 0)
+		{
+			dst.Clear();
+			return;
+		}
+
+		const Size3D<typename ImageFrame<T>::SizeType> &sz = src[0].size;
+		for (::size_t N = 1; N != src.GetFrameCount(); ++N)
+			if (src[N].size != sz)
+			{
+				std::ostringstream errMsg;
+				errMsg << "Frame " << N << " of " << src[N].size.width << " x " <<
+					src[N].size.height << " x " << src[N].size.depth <<
+					" has a different size from frame 0.";
+				throw std::invalid_argument(errMsg.str());
+			}
+
+		const ResizePlan<T> plan(Size2D< ::size_t>(sz.width, sz.height), zm, interp);
+		const Size2D< ::size_t> &szDst = plan.GetDestinationSize();
+		TransformFrames(src, dst, Size3D<typename ImageFrame<T>::SizeType>(szDst.width,
+			szDst.height, sz.depth), [&](const ImageView<const T> &viewSrc,
+			const ImageView<T> &viewDst)
+		{
+			plan.Execute(viewSrc, viewDst);
+		});
+	}
+
+	inline std::vector< ::size_t> GetFrames(::size_t n, ::size_t first, ::size_t step)
+	{
+		if (step == 0)
+			throw std::invalid_argument("The step of frames is zero.");
+
+		std::vector< ::size_t> frames;
+		for (::size_t N = first; N < n; N += step)
+			frames.push_back(N);
+		return frames;
+	}
+
+	inline void CheckFrames(const std::vector< ::size_t> &frames, ::size_t n)
+	{
+		for (auto it = frames.begin(); it != frames.end(); ++it)
+			if (*it >= n)
+			{
+				std::ostringstream errMsg;
+				errMsg << "Frame " << *it << " is out of range.";
+				throw std::out_of_range(errMsg.str());
+			}
+	}
+}
+
+#endif
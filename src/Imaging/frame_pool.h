@@ -0,0 +1,119 @@
+#if !defined(FRAME_POOL_H)
+#define FRAME_POOL_H
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "utilities.h"
+
+namespace Imaging
+{
+	/** The default number of blocks cached by a FramePool for each size class. */
+	const ::size_t FRAME_POOL_CACHE_LIMIT = 16;
+
+	/** Recycles memory blocks of image buffers, so images of the same size and data type
+	are allocated without calling the heap after the first few frames.
+
+	A released block is cached for its size class, i.e., the pair of the size in bytes and
+	the alignment, and it is handed out again for the next request of the same size class.
+	Since images of the same dimension, data type and line alignment request the same size
+	class, a steady stream of frames never calls AlignedMalloc() nor touches a new page.
+
+	The pool is a MemoryResource, so an image uses the pool by its allocator, e.g.,
+	ImageFrame<T> frame(sz, 0, AlignedAllocator<T>(&pool));
+	and the buffer returns to the pool when the image is destroyed or resized.
+	The methods are thread-safe.
+
+	A size class caches up to a limit of blocks, and a block returned beyond the limit or
+	while the cache cannot grow is freed at once, so Deallocate() never throws and the
+	cache does not grow with a burst of images of a size which is not used again.
+
+	@NOTE The pool must outlive all images using it. Cached blocks are released at the
+	destructor or by Release(), but blocks in use are never released by the pool. */
+	class FramePool : public MemoryResource
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+
+		/** Occupancy and hit rate of the pool. */
+		struct Statistics
+		{
+			Statistics(void);
+
+			/** Returns nHits / (nHits + nMisses), or zero if nothing has been allocated. */
+			double GetHitRate(void) const;
+
+			::size_t nHits;			// requests served by a cached block
+			::size_t nMisses;		// requests served by AlignedMalloc()
+			::size_t nBlocksInUse;
+			::size_t nBytesInUse;
+			::size_t nBlocksCached;
+			::size_t nBytesCached;
+		};
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		FramePool(void);
+		~FramePool(void);
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** @param [in] nBlocksLimit	the number of blocks cached for each size class */
+		explicit FramePool(::size_t nBlocksLimit);
+
+		//////////////////////////////////////////////////
+		// Methods.
+		void *Allocate(::size_t nBytes, ::size_t alignment);
+
+		/** Caches a block for its size class, or frees it if the cache is full or cannot
+		grow. It never throws, since it is called by the destructors of images. */
+		void Deallocate(void *p, ::size_t nBytes, ::size_t alignment);
+
+		/** Allocates n blocks of given size class in advance, and writes zeros to them so
+		that the pages are committed before the first frame arrives.
+
+		Reserved blocks are counted as neither hits nor misses, and they are cached even
+		beyond the limit. */
+		void Reserve(::size_t nBytes, ::size_t n, ::size_t alignment = DEFAULT_ALIGNMENT);
+
+		/** Releases all cached blocks to the heap. */
+		void Release(void);
+
+		::size_t GetCacheLimit(void) const;
+
+		/** Changes the number of blocks cached for each size class, and releases the
+		cached blocks exceeding it. */
+		void SetCacheLimit(::size_t nBlocksLimit);
+
+		Statistics GetStatistics(void) const;
+
+		/** Resets the hit and miss counts. */
+		void ResetStatistics(void);
+
+	protected:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef std::pair< ::size_t, ::size_t> SizeClass;	// (nBytes, alignment)
+
+		//////////////////////////////////////////////////
+		// Data.
+		std::map<SizeClass, std::vector<void *> > cache_;
+		::size_t nBlocksLimit_;
+		Statistics stats_;
+		mutable std::mutex mutex_;
+
+	private:
+		// Not copyable because the pool owns the cached blocks.
+		FramePool(const FramePool &);
+		FramePool &operator=(const FramePool &);
+	};
+}
+
+#include "frame_pool_inl.h"
+
+#endif
@@ -0,0 +1,166 @@
+#if !defined(FRAME_POOL_INL_H)
+#define FRAME_POOL_INL_H
+
+namespace Imaging
+{
+	//////////////////////////////////////////////////////////////////////////
+	// FramePool::Statistics struct
+
+	inline FramePool::Statistics::Statistics(void) : nHits(0), nMisses(0), nBlocksInUse(0),
+		nBytesInUse(0), nBlocksCached(0), nBytesCached(0) {}
+
+	inline double FramePool::Statistics::GetHitRate(void) const
+	{
+		if (this->nHits + this->nMisses == 0)
+			return 0.0;
+		return static_cast<double>(this->nHits) / (this->nHits + this->nMisses);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// FramePool class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	inline FramePool::FramePool(void) : nBlocksLimit_(FRAME_POOL_CACHE_LIMIT) {}
+
+	inline FramePool::~FramePool(void)
+	{
+		this->Release();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	inline FramePool::FramePool(::size_t nBlocksLimit) : nBlocksLimit_(nBlocksLimit) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	/** A cache miss allocates the memory outside of the lock, so other threads are not
+	blocked by the heap. */
+	inline void *FramePool::Allocate(::size_t nBytes, ::size_t alignment)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex_);
+			auto it = this->cache_.find(SizeClass(nBytes, alignment));
+			if (it != this->cache_.end() && !it->second.empty())
+			{
+				void *p = it->second.back();
+				it->second.pop_back();
+				++this->stats_.nHits;
+				--this->stats_.nBlocksCached;
+				this->stats_.nBytesCached -= nBytes;
+				++this->stats_.nBlocksInUse;
+				this->stats_.nBytesInUse += nBytes;
+				return p;
+			}
+		}
+
+		void *p = AlignedMalloc(nBytes, alignment);
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		++this->stats_.nMisses;
+		++this->stats_.nBlocksInUse;
+		this->stats_.nBytesInUse += nBytes;
+		return p;
+	}
+
+	/** Adding a size class or growing its vector may throw std::bad_alloc, in which case
+	the block is freed instead of being cached. */
+	inline void FramePool::Deallocate(void *p, ::size_t nBytes, ::size_t alignment)
+	{
+		if (p == nullptr)
+			return;
+
+		bool isCached = false;
+		{
+			std::lock_guard<std::mutex> lock(this->mutex_);
+			--this->stats_.nBlocksInUse;
+			this->stats_.nBytesInUse -= nBytes;
+			try
+			{
+				auto &cached = this->cache_[SizeClass(nBytes, alignment)];
+				if (cached.size() < this->nBlocksLimit_)
+				{
+					cached.push_back(p);
+					isCached = true;
+					++this->stats_.nBlocksCached;
+					this->stats_.nBytesCached += nBytes;
+				}
+			}
+			catch (...) {}
+		}
+		if (!isCached)
+			AlignedFree(p);
+	}
+
+	inline void FramePool::Reserve(::size_t nBytes, ::size_t n, ::size_t alignment)
+	{
+		std::vector<void *> blocks;
+		blocks.reserve(n);
+		try
+		{
+			for (::size_t N = 0; N != n; ++N)
+			{
+				blocks.push_back(AlignedMalloc(nBytes, alignment));
+				std::memset(blocks.back(), 0, nBytes);
+			}
+		}
+		catch (...)
+		{
+			for (auto it = blocks.begin(); it != blocks.end(); ++it)
+				AlignedFree(*it);
+			throw;
+		}
+
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		auto &cached = this->cache_[SizeClass(nBytes, alignment)];
+		cached.insert(cached.end(), blocks.begin(), blocks.end());
+		this->stats_.nBlocksCached += n;
+		this->stats_.nBytesCached += n * nBytes;
+	}
+
+	inline void FramePool::Release(void)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		for (auto it = this->cache_.begin(); it != this->cache_.end(); ++it)
+			for (auto it_p = it->second.begin(); it_p != it->second.end(); ++it_p)
+				AlignedFree(*it_p);
+		this->cache_.clear();
+		this->stats_.nBlocksCached = 0;
+		this->stats_.nBytesCached = 0;
+	}
+
+	inline ::size_t FramePool::GetCacheLimit(void) const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		return this->nBlocksLimit_;
+	}
+
+	inline void FramePool::SetCacheLimit(::size_t nBlocksLimit)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->nBlocksLimit_ = nBlocksLimit;
+		for (auto it = this->cache_.begin(); it != this->cache_.end(); ++it)
+			while (it->second.size() > nBlocksLimit)
+			{
+				AlignedFree(it->second.back());
+				it->second.pop_back();
+				--this->stats_.nBlocksCached;
+				this->stats_.nBytesCached -= it->first.first;
+			}
+	}
+
+	inline FramePool::Statistics FramePool::GetStatistics(void) const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		return this->stats_;
+	}
+
+	inline void FramePool::ResetStatistics(void)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->stats_.nHits = 0;
+		this->stats_.nMisses = 0;
+	}
+}
+
+#endif
@@ -1,6 +1,12 @@
 #if !defined(IMAGE_H)
 #define IMAGE_H
 
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "coordinates.h"
@@ -20,38 +26,279 @@ namespace Imaging
 	*/
 	enum class ImageFormat {UNKNOWN, BIP, BSQ, BIL};
 
+	/** Presents when accessors check the range of given coordinate.
+
+	CHECKED: always checks the range, and throws std::out_of_range if it is out of range.
+	DEBUG_CHECKED: checks the range only for debug builds, i.e., if NDEBUG is not defined.
+	UNCHECKED: never checks the range, e.g., for coordinates in an ROI which has been
+	validated once by CheckRange(). */
+	enum class RangeCheck {CHECKED, DEBUG_CHECKED, UNCHECKED};
+
+	/** Presents how new elements are initialized when an image is resized.
+
+	ZERO_FILLED: new elements are zero, as std::vector<T>::resize() does.
+	UNINITIALIZED: new elements of arithmetic types are left uninitialized, e.g., when all
+	elements are overwritten right after resizing, so the memory is written only once. */
+	enum class ResizeMode {ZERO_FILLED, UNINITIALIZED};
+
+	/** Returns true if the range should be checked for given policy in this build. */
+	bool IsRangeChecked(RangeCheck check);
+
+	/** Presents how image data is stored for an image format at compile time.
+
+	GetElemWidth() returns the number of elements of a line without padding elements, where
+	a line is a row of pixels for BIP, and a row of a channel for BSQ and BIL.
+	GetOffset() returns the distance of an element from the first element, and GetStep()
+	returns the distances between two adjacent elements along x, y and c.
+	nElemPerLine is the number of elements from a line to the next one including padding
+	elements.
+	The functions are constexpr, so the offsets can be computed by the compiler, and loops
+	over a known image format can be vectorized. */
+	template <ImageFormat F>
+	struct ImageLayout;
+
+	template <>
+	struct ImageLayout<ImageFormat::BIP>
+	{
+		static IMAGING_CONSTEXPR ::size_t GetElemWidth(::size_t width, ::size_t depth);
+		static IMAGING_CONSTEXPR ::size_t GetOffset(::size_t x, ::size_t y, ::size_t c,
+			::size_t height, ::size_t depth, ::size_t nElemPerLine);
+		static Point3D<::size_t> GetStep(::size_t height, ::size_t depth,
+			::size_t nElemPerLine);
+	};
+
+	template <>
+	struct ImageLayout<ImageFormat::BSQ>
+	{
+		static IMAGING_CONSTEXPR ::size_t GetElemWidth(::size_t width, ::size_t depth);
+		static IMAGING_CONSTEXPR ::size_t GetOffset(::size_t x, ::size_t y, ::size_t c,
+			::size_t height, ::size_t depth, ::size_t nElemPerLine);
+		static Point3D<::size_t> GetStep(::size_t height, ::size_t depth,
+			::size_t nElemPerLine);
+	};
+
+	template <>
+	struct ImageLayout<ImageFormat::BIL>
+	{
+		static IMAGING_CONSTEXPR ::size_t GetElemWidth(::size_t width, ::size_t depth);
+		static IMAGING_CONSTEXPR ::size_t GetOffset(::size_t x, ::size_t y, ::size_t c,
+			::size_t height, ::size_t depth, ::size_t nElemPerLine);
+		static Point3D<::size_t> GetStep(::size_t height, ::size_t depth,
+			::size_t nElemPerLine);
+	};
+
+	/** Holds the image format of an Image<T, F> object.
+
+	The format is a variable if F is ImageFormat::UNKNOWN, i.e., the format is decided at
+	run time. Otherwise, it is a compile-time constant, which cannot be changed. */
+	template <ImageFormat F>
+	class ImageFormatBase
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		ImageFormatBase(ImageFormat fmt);
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** Throws an exception if the given format is not F. */
+		void SetFormat(ImageFormat fmt) const;
+
+		//////////////////////////////////////////////////
+		// Data.
+		static const ImageFormat format = F;
+	};
+
+	template <>
+	class ImageFormatBase<ImageFormat::UNKNOWN>
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		ImageFormatBase(ImageFormat fmt);
+
+		//////////////////////////////////////////////////
+		// Methods.
+		void SetFormat(ImageFormat fmt);
+
+		//////////////////////////////////////////////////
+		// Data.
+		ImageFormat format;
+	};
+
+	/** Presents a non-owning view of image data stored in another object, e.g., an entire
+	image or an ROI of an Image<T> or an ImageFrame<T> object, or a raw data block.
+
+	A view is defined by a pointer to the first element, the size, the image format and the
+	distance (step) between two adjacent elements along each dimension, so an ROI of any
+	image format can be presented without allocating or copying any data.
+	step.x is the number of elements between two adjacent pixels, step.y is between two
+	adjacent rows, and step.z is between two adjacent channels.
+
+	Use ImageView<const T> for read-only image data.
+	The constness of a view does not propagate to the data just like a pointer.
+	The accessors check the range of given coordinate according to R. A view validated by
+	CheckRange() does not check the range any more.
+
+	@NOTE The view does NOT own the data, so it becomes invalid if the source image is
+	resized or destroyed. */
+	template <typename T, RangeCheck R = RangeCheck::CHECKED>
+	class ImageView
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef ::size_t SizeType;
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		ImageView(void);
+		ImageView(const ImageView<T, R> &src);
+		ImageView<T, R> &operator=(const ImageView<T, R> &src);
+
+		/** Converts a view of writable data into a view of read-only data, or a view of
+		another range check policy. */
+		template <typename U, RangeCheck S>
+		ImageView(const ImageView<U, S> &src);
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** Instantiates a view of an entire image stored in a raw data block.
+
+		@param [in] nElemPerLine	the number of elements from a line to the next one
+		including padding elements, where a line is a row of pixels for BIP, and a row of
+		a channel for BSQ and BIL */
+		ImageView(T *data, const Size3D<SizeType> &sz, ImageFormat fmt,
+			SizeType nElemPerLine);
+
+		/** Instantiates a view from explicit steps. */
+		ImageView(T *data, const Size3D<SizeType> &sz, ImageFormat fmt,
+			const Point3D<SizeType> &step);
+
+		//////////////////////////////////////////////////
+		// Accessors.
+
+		/** Accesses image data for given coordinate (x, y, c) by a reference. */
+		T &operator()(SizeType x, SizeType y, SizeType c = 0) const;
+
+		/** Accesses image data for given coordinate (x, y, c) by a pointer. */
+		T *GetPointer(SizeType x, SizeType y, SizeType c = 0) const;
+
+		const Size3D<SizeType> &size;
+		const Point3D<SizeType> &step;
+		const ImageFormat &format;
+
+		//////////////////////////////////////////////////
+		// Methods.
+		void CheckRange(SizeType c) const;
+		void CheckRange(SizeType x, SizeType y) const;
+		void CheckRange(const Point2D<SizeType> &orgn, const Size2D<SizeType> &sz) const;
+
+		/** Validates an ROI once, and returns a view of the ROI which does not check the
+		range any more. */
+		ImageView<T, RangeCheck::UNCHECKED> CheckRange(
+			const Region<SizeType, SizeType> &roi) const;
+		Region<SizeType, SizeType> GetRoi(void) const;
+
+		/** Returns a view of an ROI of this view without copying data. */
+		ImageView<T, R> GetView(const Region<SizeType, SizeType> &roi) const;
+
+		/** Returns the number of elements from a line to the next line including padding
+		elements. */
+		SizeType GetElemPerLine(void) const;
+
+		/** Returns true if all elements of the view are stored in a continuous memory
+		block without any gap. */
+		bool IsContinuous(void) const;
+
+	protected:
+		template <typename U, RangeCheck S>
+		friend class ImageView;
+
+		//////////////////////////////////////////////////
+		// Methods.
+		SizeType GetOffset(SizeType x, SizeType y, SizeType c = 0) const;
+
+		//////////////////////////////////////////////////
+		// Data.
+		T *data_;
+		Size3D<SizeType> size_;
+		Point3D<SizeType> step_;
+		ImageFormat format_;
+	};
+
 	/** Presents a pixel-based bitmap (raster) image.
 
 	This class stores image data as a std::vector<T> object, so it does NOT need to release
-	the memory at the destructor and it does NOT support padding bytes.
+	the memory at the destructor.
 	The value of image data can be changed externally by references and iterators of the
 	std::vector<T> object.
 	The dimension of image data can be changed externally by designated member functions. 
 
+	The first element of image data is always aligned at DEFAULT_ALIGNMENT bytes.
+	If a line alignment is given, padding elements are appended to each line so that every
+	line starts at a multiple of the line alignment, i.e., every line is aligned as well if
+	the line alignment is up to DEFAULT_ALIGNMENT bytes.
+	A line is a row of pixels for BIP, and a row of a channel for BSQ and BIL.
+	Since the length of a line depends on the image format, the memory is allocated to fit
+	any image format, so the format can be changed after resizing the image.
+
 	@NOTE The number of element is NOT the same as the number of bytes.
 	It is identical to the number of bytes only if the image is 1 byte data type and the
-	image does not have any padding bytes.	*/
-	template <typename T>
-	class Image
+	image does not have any padding bytes.
+
+	If an image format is given as F, the format is fixed at compile time, so the offset of
+	each element is computed without checking the format at run time.
+	Otherwise, i.e., Image<T>, the format can be changed at run time.
+	Images of different F can be converted to each other if the formats are matched. */
+	template <typename T, ImageFormat F = ImageFormat::UNKNOWN>
+	class Image : public ImageFormatBase<F>
 	{
 	public:
 		//////////////////////////////////////////////////
 		// Types and constants.
-		typedef typename std::vector<T>::size_type SizeType;
-		typedef typename std::vector<T>::iterator Iterator;
-		typedef typename std::vector<T>::const_iterator ConstIterator;
+		typedef std::vector<T, AlignedAllocator<T> > Container;
+		typedef typename Container::allocator_type Allocator;
+		typedef typename Container::size_type SizeType;
+		typedef typename Container::iterator Iterator;
+		typedef typename Container::const_iterator ConstIterator;
 
 		//////////////////////////////////////////////////
 		// Default constructors.
 		Image(void);
-		Image(const Image<T> &src);
-		Image<T> &operator=(const Image<T> &src);
+		Image(const Image<T, F> &src);
+		Image<T, F> &operator=(const Image<T, F> &src);
+
+		/** Moves image data without copying it. The source image becomes empty. */
+		Image(Image<T, F> &&src) IMAGING_NOEXCEPT;
+		Image<T, F> &operator=(Image<T, F> &&src) IMAGING_NOEXCEPT;
 
 		//////////////////////////////////////////////////
 		// Custom constructors.
-		Image(const Size3D<SizeType> &sz, ImageFormat fmt = ImageFormat::BIP);
+
+		/** Instantiates an empty image which allocates the memory by given allocator, e.g.,
+		AlignedAllocator<T>(&pool) for a FramePool object. */
+		explicit Image(const Allocator &alloc);
+		Image(const Size3D<SizeType> &sz,
+			ImageFormat fmt = F == ImageFormat::UNKNOWN ? ImageFormat::BIP : F,
+			::size_t alignment = 0, const Allocator &alloc = Allocator());
 		Image(SizeType width, SizeType height, SizeType depth = 1,
-			ImageFormat fmt = ImageFormat::BIP);
+			ImageFormat fmt = F == ImageFormat::UNKNOWN ? ImageFormat::BIP : F,
+			::size_t alignment = 0, const Allocator &alloc = Allocator());
+
+		/** Converts an image of another format type, e.g., Image<T> <-> Image<T, F>.
+
+		@exception std::invalid_argument	if the image format is not matched */
+		template <ImageFormat G>
+		Image(const Image<T, G> &src);
+		template <ImageFormat G>
+		Image<T, F> &operator=(const Image<T, G> &src);
+		template <ImageFormat G>
+		Image(Image<T, G> &&src);
+		template <ImageFormat G>
+		Image<T, F> &operator=(Image<T, G> &&src);
 
 		//////////////////////////////////////////////////
 		// Accessors.
@@ -68,7 +315,30 @@ namespace Imaging
 		T *GetPointer(SizeType x, SizeType y, SizeType c = 0);
 		const T *GetPointer(SizeType x, SizeType y, SizeType c = 0) const;
 
-		const std::vector<T> &data;
+		/** Accesses image data for given coordinate (x, y, c) with given range check
+		policy, e.g., img.At<RangeCheck::UNCHECKED>(x, y) in a loop over a validated ROI.
+		The accessors above are identical to the ones with RangeCheck::CHECKED. */
+		template <RangeCheck R>
+		T &At(SizeType x, SizeType y, SizeType c = 0);
+		template <RangeCheck R>
+		const T &At(SizeType x, SizeType y, SizeType c = 0) const;
+		template <RangeCheck R>
+		Iterator GetIterator(SizeType x, SizeType y, SizeType c = 0);
+		template <RangeCheck R>
+		ConstIterator GetIterator(SizeType x, SizeType y, SizeType c = 0) const;
+		template <RangeCheck R>
+		T *GetPointer(SizeType x, SizeType y, SizeType c = 0);
+		template <RangeCheck R>
+		const T *GetPointer(SizeType x, SizeType y, SizeType c = 0) const;
+
+		/** Accesses the entire image or an ROI by a view without copying data. An empty
+		image gives an empty view even if it has no format. */
+		ImageView<T> GetView(void);
+		ImageView<const T> GetView(void) const;
+		ImageView<T> GetView(const Region<SizeType, SizeType> &roi);
+		ImageView<const T> GetView(const Region<SizeType, SizeType> &roi) const;
+
+		const Container &data;
 		const Size3D<SizeType> &size;
 
 		//////////////////////////////////////////////////
@@ -78,40 +348,163 @@ namespace Imaging
 		void CheckRange(SizeType x, SizeType y) const;
 		void CheckRange(const Point2D<SizeType> &pt) const;
 		void CheckRange(const Point2D<SizeType> &orgn, const Size2D<SizeType> &sz) const;
-		void CheckRange(const Region<SizeType, SizeType> &roi) const;
+
+		/** Validates an ROI once, and returns a view of the ROI which does not check the
+		range any more, so the ROI can be iterated without any range check.
+
+		@exception std::out_of_range	if the ROI is out of range */
+		ImageView<T, RangeCheck::UNCHECKED> CheckRange(
+			const Region<SizeType, SizeType> &roi);
+		ImageView<const T, RangeCheck::UNCHECKED> CheckRange(
+			const Region<SizeType, SizeType> &roi) const;
 		void clear(void);
-		Region<typename Image<T>::SizeType, typename Image<T>::SizeType> GetRoi(void) const;
-		void resize(const Size3D<SizeType> &sz);
-		void resize(SizeType width, SizeType height, SizeType depth = 1);
+		Region<typename Image<T, F>::SizeType, typename Image<T, F>::SizeType>
+			GetRoi(void) const;
 
-		//////////////////////////////////////////////////
-		// Data.
-		ImageFormat format;
+		/** Exchanges image data with another image without copying it. */
+		void swap(Image<T, F> &rhs) IMAGING_NOEXCEPT;
+		void resize(const Size3D<SizeType> &sz, ResizeMode mode = ResizeMode::ZERO_FILLED);
+		void resize(SizeType width, SizeType height, SizeType depth = 1,
+			ResizeMode mode = ResizeMode::ZERO_FILLED);
+
+		/** Converts the image format by permuting image data in place, so a large image is
+		converted without doubling the memory.
+
+		The extra memory is bounded by a row of pixels and a bit per line, which is far
+		smaller than the image itself, unless the memory does not fit the new format and
+		is reallocated. The image is left unchanged if an exception is thrown.
+		@return the peak number of bytes of the extra memory
+		@exception std::invalid_argument	if F is not ImageFormat::UNKNOWN and fmt is not F
+		@exception std::logic_error	if either image format is not BIP, BSQ nor BIL */
+		::size_t ConvertFormat(ImageFormat fmt);
+
+		/** Returns the line alignment in bytes. Zero means no padding elements. */
+		::size_t GetAlignment(void) const;
+
+		/** Sets the line alignment in bytes, and reallocates image data for the current
+		size as necessary.
+
+		@param [in] alignment	Zero for no padding elements, or a multiple of sizeof(T).
+		@NOTE Existing image data is NOT preserved if the line alignment is changed. */
+		void SetAlignment(::size_t alignment);
+
+		/** Returns the number of elements from the beginning of a line to the next line
+		including padding elements for the current image format. */
+		SizeType GetElemPerLine(void) const;
+		::size_t GetBytesPerLine(void) const;
+
+		/** Returns true if there is no padding element between lines. */
+		bool IsContinuous(void) const;
+
+		Allocator GetAllocator(void) const;
 
 	protected:
+		template <typename U, ImageFormat G>
+		friend class Image;
+
 		//////////////////////////////////////////////////
 		// Methods.
 		SizeType GetOffset(SizeType x, SizeType y, SizeType c = 0) const;
 
+		/** Returns the number of elements of a line without padding elements. */
+		SizeType GetElemWidth(void) const;
+		SizeType GetElemPerLine(SizeType nElemWidth) const;
+
 		//////////////////////////////////////////////////
 		// Data.
-		std::vector<T> data_;
+		Container data_;
 		Size3D<SizeType> size_;
+		::size_t alignment_;
 	};
 
-	/** TO BE REMOVED */
+	/** Presents the data type of image elements given at run time, e.g., by the header of
+	an image file. */
 	enum class ImageDataType {UINT8, INT8, UINT16, INT16, UINT32, INT32, UINT64, INT64,
 		FLOAT32, FLOAT64};
 
-	/** TO BE REMOVED */
+	/** Returns the number of bytes of an element of given data type. */
+	::size_t GetElemSize(ImageDataType type);
+
+	/** Maps a C++ type to ImageDataType, e.g., DataTypeOf<float>::value is FLOAT32. */
+	template <typename T>
+	struct DataTypeOf;
+
+	template <>
+	struct DataTypeOf<std::uint8_t> {static const ImageDataType value = ImageDataType::UINT8;};
+
+	template <>
+	struct DataTypeOf<std::int8_t> {static const ImageDataType value = ImageDataType::INT8;};
+
+	template <>
+	struct DataTypeOf<std::uint16_t>
+	{static const ImageDataType value = ImageDataType::UINT16;};
+
+	template <>
+	struct DataTypeOf<std::int16_t> {static const ImageDataType value = ImageDataType::INT16;};
+
+	template <>
+	struct DataTypeOf<std::uint32_t>
+	{static const ImageDataType value = ImageDataType::UINT32;};
+
+	template <>
+	struct DataTypeOf<std::int32_t> {static const ImageDataType value = ImageDataType::INT32;};
+
+	template <>
+	struct DataTypeOf<std::uint64_t>
+	{static const ImageDataType value = ImageDataType::UINT64;};
+
+	template <>
+	struct DataTypeOf<std::int64_t> {static const ImageDataType value = ImageDataType::INT64;};
+
+	template <>
+	struct DataTypeOf<float> {static const ImageDataType value = ImageDataType::FLOAT32;};
+
+	template <>
+	struct DataTypeOf<double> {static const ImageDataType value = ImageDataType::FLOAT64;};
+
+	/** Calls visitor(static_cast<T *>(nullptr)) for the C++ type T of given data type, so
+	a template kernel is instantiated once for each data type, and the data type is checked
+	once per call instead of once per element.
+
+	@return the value returned by the visitor, which must be the same type for all data
+	types
+	@exception std::logic_error	if the data type is not supported */
+	template <typename Visitor>
+	auto VisitDataType(ImageDataType type, Visitor &&visitor) ->
+		decltype(visitor(static_cast<std::uint8_t *>(nullptr)));
+
+	/** Presents an image whose data type is given at run time.
+
+	Image data is stored in an Image<T> object of the data type, so the memory is aligned
+	as Image<T>, and an Image<T> object is moved into or out of this object without copying
+	data. The elements are accessed by a view of the data type, or by Visit() which calls a
+	template kernel with the view of the actual data type.
+	The typed accessors throw std::logic_error if T is not the data type. */
 	class ImageRaw
 	{
 	public:
 		//////////////////////////////////////////////////
 		// Types and constants.
 		typedef ::size_t SizeType;
-		//typedef std::vector<unsigned char>::iterator Iterator;
-		//typedef std::vector<unsigned char>::const_iterator ConstIterator;
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		ImageRaw(void);
+		ImageRaw(const ImageRaw &src);
+		ImageRaw &operator=(const ImageRaw &src);
+
+		/** Moves image data without copying it. The source image becomes empty. */
+		ImageRaw(ImageRaw &&src) IMAGING_NOEXCEPT;
+		ImageRaw &operator=(ImageRaw &&src) IMAGING_NOEXCEPT;
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		ImageRaw(ImageDataType type, const Size3D<SizeType> &sz,
+			ImageFormat fmt = ImageFormat::BIP, ::size_t alignment = 0);
+
+		/** Takes over image data of an Image<T> object without copying it. */
+		template <typename T>
+		explicit ImageRaw(Image<T> &&img);
 
 		//////////////////////////////////////////////////
 		// Accessors.
@@ -127,40 +520,90 @@ namespace Imaging
 		template <typename T>
 		const T *GetPointer(SizeType x, SizeType y, SizeType c = 0) const;
 
+		/** Accesses the entire image or an ROI by a view of the data type without copying
+		data. */
+		template <typename T>
+		ImageView<T> GetView(void);
+		template <typename T>
+		ImageView<const T> GetView(void) const;
+		template <typename T>
+		ImageView<T> GetView(const Region<SizeType, SizeType> &roi);
+		template <typename T>
+		ImageView<const T> GetView(const Region<SizeType, SizeType> &roi) const;
+
 		const Size3D<SizeType> &size;
-		//const Size3D<SizeType> &size;
+		const ImageFormat &format;
+		const ImageDataType &datatype;
 
 		//////////////////////////////////////////////////
 		// Methods.
-		void CheckDepth(SizeType c) const;
 		void CheckRange(SizeType c) const;
 		void CheckRange(SizeType x, SizeType y) const;
-		void CheckRange(const Point2D<SizeType> &pt) const;
-		void CheckRange(const Point2D<SizeType> &orgn, const Size2D<SizeType> &sz) const;
 		void CheckRange(const Region<SizeType, SizeType> &roi) const;
 		void Clear(void);
-		Region<typename ImageRaw::SizeType, typename ImageRaw::SizeType> GetRoi(void) const;
-		void Resize(const Size3D<SizeType> &sz);
-		void Resize(SizeType width, SizeType height, SizeType depth = 1);
+		Region<SizeType, SizeType> GetRoi(void) const;
+		void Resize(const Size3D<SizeType> &sz, ResizeMode mode = ResizeMode::ZERO_FILLED);
+		void Resize(SizeType width, SizeType height, SizeType depth = 1,
+			ResizeMode mode = ResizeMode::ZERO_FILLED);
+
+		/** Converts the image format in place as Image<T>::ConvertFormat(). */
+		::size_t ConvertFormat(ImageFormat fmt);
 		::size_t GetBytesPerCh(void) const;
 
-		//////////////////////////////////////////////////
-		// Data.
-		ImageFormat format;
-		ImageDataType datatype;
+		template <typename T>
+		bool IsDataType(void) const;
+
+		/** Moves image data out to an Image<T> object without copying it. This image
+		becomes empty. */
+		template <typename T>
+		Image<T> Release(void);
+
+		/** Calls visitor(view) with an ImageView<T> of the entire image for the data type
+		T, e.g., a function object with a template operator(). */
+		template <typename Visitor>
+		auto Visit(Visitor &&visitor) -> decltype(visitor(ImageView<std::uint8_t>()));
+		template <typename Visitor>
+		auto Visit(Visitor &&visitor) const ->
+			decltype(visitor(ImageView<const std::uint8_t>()));
 
 	protected:
+		//////////////////////////////////////////////////
+		// Types and constants.
+
+		/** Calls a visitor with a view for the data type given by VisitDataType(). */
+		template <typename Visitor, typename Raw>
+		struct ViewVisitor;
+
+		/** Calls a visitor with the Image<T> object, which is allocated if this image is
+		empty, and updates the size and the format afterward. */
+		template <typename Visitor>
+		struct ImageVisitor;
+
+		/** Visitors of the methods, which are applied to the Image<T> object. */
+		struct Copier;
+		struct Creator;
+		struct Resizer;
+		struct Converter;
+
 		//////////////////////////////////////////////////
 		// Methods.
-		SizeType GetOffset(SizeType x, SizeType y, SizeType c = 0) const;
+
+		/** Returns the image, or nullptr if this image is empty. */
+		template <typename T>
+		Image<T> *GetImage(void) const;
+
+		template <typename Visitor>
+		void VisitImage(Visitor &&visitor);
+
+		template <typename T>
+		static void DeleteImage(void *image);
 
 		//////////////////////////////////////////////////
 		// Data.
-		void *data_;
-		//std::vector<unsigned char> data_;
+		std::unique_ptr<void, void (*)(void *)> image_;
 		Size3D<SizeType> size_;
-		//Size3D<SizeType> size_;
-		
+		ImageFormat format_;
+		ImageDataType datatype_;
 	};
 
 #if _MSC_VER > 1700	// from VS2013
@@ -168,24 +611,28 @@ namespace Imaging
 	using ROI = Region<typename Image<T>::SizeType, typename Image<T>::SizeType>;
 #endif
 
+	template <typename T, ImageFormat F>
+	void swap(Image<T, F> &a, Image<T, F> &b);
+
 	/** Copies image data of an ROI to another ROI.
 
 	@NOTE destination image must already have been allocated. */
-	template <typename T>
-	void Copy(const Image<T> &imgSrc,
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
-		Image<T> &imgDst, const Point2D<typename Image<T>::SizeType> &orgnDst);
+		Image<T, F> &imgDst, const Point2D<typename Image<T>::SizeType> &orgnDst);
 
 	/** Copies image data of an ROI to another image.
 
 	@NOTE destination image will be resized based on the size of the source ROI. */
-	template <typename T>
-	void Copy(const Image<T> &imgSrc,
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
-		Image<T> &imgDst);
+		Image<T, F> &imgDst);
 
-	/* TODO: Copies image data of an ROI to another image while converting image type from
-	one to another. */
+	/** Copies image data of an ROI to another image while converting the image format.
+
+	@NOTE destination image will be resized based on the size of the source ROI. */
 	template <typename T>
 	void Copy(const Image<T> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
@@ -193,6 +640,9 @@ namespace Imaging
 
 	/** Copies an entire image from a raw data block with zero padding.
 
+	bytesPerLine is the number of bytes from a line to the next one at the source including
+	padding bytes, where a line is a row of pixels for BIP, and a row of a channel for BSQ
+	and BIL.
 	@NOTE destination image will be reallocated based on the size of source image. */
 	template <typename T>
 	void Copy(const T *src, const Size3D<typename Image<T>::SizeType> &sz,
@@ -209,15 +659,64 @@ namespace Imaging
 	
 	@NOTE The range of destination data block will NOT be checked.
 	Users are responsible to ensure the memory is already allocated at the destination. */
-	template <typename T>
-	void Copy(const Image<T> &imgSrc,
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
 		T *dst);
 
 	// Copy the whole data at once instead of copying lines.
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc, T *dst);
+
+	/** Copies all lines of a view to another view for an image format given at compile
+	time. */
+	template <typename T>
+	void CopyLines(const ImageView<const T> &src, const ImageView<T> &dst,
+		ImageLayout<ImageFormat::BIP>);
+
+	template <typename T>
+	void CopyLines(const ImageView<const T> &src, const ImageView<T> &dst,
+		ImageLayout<ImageFormat::BSQ>);
+
 	template <typename T>
-	void Copy(const Image<T> &imgSrc, T *dst);
+	void CopyLines(const ImageView<const T> &src, const ImageView<T> &dst,
+		ImageLayout<ImageFormat::BIL>);
+
+	/** Copies all pixels of a view to another view of a different image format.
+
+	BIP <-> BSQ/BIL transposes pixels and channels of each row, where 3 or 4 channels are
+	(de)interleaved by kernels unrolled at compile time, and more channels are copied tile
+	by tile. BSQ <-> BIL copies the lines of each channel. The rows of a large image are
+	transposed in parallel. */
+	template <typename T>
+	void CopyAcrossFormats(const ImageView<const T> &src, const ImageView<T> &dst);
+
+	/** Copies image data of a view to another view.
+
+	Both views must have the same size, and the image format is converted if the formats
+	are different. */
+	template <typename T>
+	void Copy(const ImageView<const T> &src, const ImageView<T> &dst);
+
+	template <typename T>
+	void Copy(const ImageView<T> &src, const ImageView<T> &dst);
+
+	/** Copies image data of a view to another image.
+
+	@NOTE destination image will be resized based on the size of the source view. */
+	template <typename T, ImageFormat F>
+	void Copy(const ImageView<const T> &src, Image<T, F> &imgDst);
+
+	template <typename T, ImageFormat F>
+	void Copy(const ImageView<T> &src, Image<T, F> &imgDst);
+
+	/** Calls func(tile) for every tile of an ROI in parallel by the shared thread pool.
 
+	The tiles are those of SplitIntoTiles(), and each tile is a task, so the pool balances
+	tiles of different costs.
+	@exception std::invalid_argument	if a side of the tile is zero */
+	template <typename T, typename U, typename Function>
+	void ParallelFor(const Region<T, U> &roi, const Size2D<U> &tileSize, Function func);
 }
 
 #include "image_inl.h"
@@ -22,6 +22,9 @@ namespace Imaging
 
 	/*
 	channel -> pixel -> line -> frame
+
+	Every line may be followed by padding elements so that it starts at a multiple of the
+	line alignment as Image<T> does.
 	*/
 	template <typename T>
 	class ImageFrame
@@ -29,43 +32,79 @@ namespace Imaging
 	public:
 		//////////////////////////////////////////////////
 		// Types and constants.
-		typedef typename std::vector<T>::size_type SizeType;
+		typedef std::vector<T, AlignedAllocator<T> > Container;
+		typedef typename Container::allocator_type Allocator;
+		typedef typename Container::size_type SizeType;
 
 		//////////////////////////////////////////////////
 		// Default constructors.
 		ImageFrame(void);
 		ImageFrame(const ImageFrame<T> &src);
-		//ImageFrame(ImageFrame<T> &&src);
 		ImageFrame<T> &operator=(const ImageFrame<T> &src);
-		//ImageFrame<T> &operator=(ImageFrame<T> &&src);
+
+		/** Moves image data without copying it. The source frame becomes empty. */
+		ImageFrame(ImageFrame<T> &&src) IMAGING_NOEXCEPT;
+		ImageFrame<T> &operator=(ImageFrame<T> &&src) IMAGING_NOEXCEPT;
 
 		//////////////////////////////////////////////////
 		// Custom constructors.
-		ImageFrame(const Size3D<SizeType> &sz);
-		ImageFrame(SizeType width, SizeType height, SizeType depth = 1);
+		explicit ImageFrame(const Allocator &alloc);
+		ImageFrame(const Size3D<SizeType> &sz, ::size_t alignment = 0,
+			const Allocator &alloc = Allocator());
+		ImageFrame(SizeType width, SizeType height, SizeType depth = 1,
+			::size_t alignment = 0, const Allocator &alloc = Allocator());
 
 		//////////////////////////////////////////////////
 		// Accessors.
 		T &operator()(SizeType x, SizeType y, SizeType c = 0);
 		const T &operator()(SizeType x, SizeType y, SizeType c = 0) const;
-		const std::vector<T> &data;
+
+		/** Accesses the entire frame or an ROI by a BIP view without copying data. */
+		ImageView<T> GetView(void);
+		ImageView<const T> GetView(void) const;
+		ImageView<T> GetView(const Region<SizeType, SizeType> &roi);
+		ImageView<const T> GetView(const Region<SizeType, SizeType> &roi) const;
+
+		const Container &data;
 		const Size3D<SizeType> &size;
 
 		//////////////////////////////////////////////////
 		// Methods.
 		void Clear(void);
-		void Resize(const Size3D<SizeType> &sz);
-		void Resize(SizeType width, SizeType height, SizeType depth = 1);
+		void Resize(const Size3D<SizeType> &sz, ResizeMode mode = ResizeMode::ZERO_FILLED);
+		void Resize(SizeType width, SizeType height, SizeType depth = 1,
+			ResizeMode mode = ResizeMode::ZERO_FILLED);
+
+		/** Exchanges image data with another frame without copying it. */
+		void Swap(ImageFrame<T> &rhs) IMAGING_NOEXCEPT;
+
+		/** Returns the line alignment in bytes. Zero means no padding elements. */
+		::size_t GetAlignment(void) const;
+
+		/** Sets the line alignment in bytes, and reallocates the frame for the current
+		size as necessary.
+
+		@NOTE Existing image data is NOT preserved if the line alignment is changed. */
+		void SetAlignment(::size_t alignment);
+
+		/** Returns the number of elements from a line to the next line including padding
+		elements. */
+		SizeType GetElemPerLine(void) const;
+		::size_t GetBytesPerLine(void) const;
+
+		Allocator GetAllocator(void) const;
 
 	protected:
 		//////////////////////////////////////////////////
 		// Methods.
 		SizeType GetOffset(SizeType x, SizeType y, SizeType c = 0) const;
+		SizeType GetElemPerLine(SizeType nElemWidth) const;
 
 		//////////////////////////////////////////////////
 		// Data.
-		std::vector<T> data_;
+		Container data_;
 		Size3D<SizeType> size_;
+		::size_t alignment_;
 	};
 
 	/*
@@ -79,6 +118,16 @@ namespace Imaging
 		// Types and constants.
 		typedef typename std::vector<ImageFrame<T> >::size_type SizeType;
 
+		//////////////////////////////////////////////////
+		// Default constructors.
+		ImageBlock(void);
+		ImageBlock(const ImageBlock<T> &src);
+		ImageBlock<T> &operator=(const ImageBlock<T> &src);
+
+		/** Moves the frames without copying image data. The source block becomes empty. */
+		ImageBlock(ImageBlock<T> &&src) IMAGING_NOEXCEPT;
+		ImageBlock<T> &operator=(ImageBlock<T> &&src) IMAGING_NOEXCEPT;
+
 		//////////////////////////////////////////////////
 		// Accessors.
 		ImageFrame<T> &operator[](SizeType pos);
@@ -87,12 +136,134 @@ namespace Imaging
 		//////////////////////////////////////////////////
 		// Methods.
 		void Clear(void);
+
+		/** Changes the number of frames. New frames are empty. */
 		void Resize(SizeType n);
-		void Resize(const Size3D<typename ImageFrame<T>::SizeType> &sz, SizeType n);
+
+		/** Changes the number of frames, and resizes every frame to the given size. */
+		void Resize(const Size3D<typename ImageFrame<T>::SizeType> &sz, SizeType n,
+			ResizeMode mode = ResizeMode::ZERO_FILLED);
+
+		SizeType GetFrameCount(void) const;
+
+		/** Exchanges the frames with another block without copying image data. */
+		void Swap(ImageBlock<T> &rhs) IMAGING_NOEXCEPT;
+
 	protected:
 		std::vector<ImageFrame<T> > frames_;
 	};
 
+	/*
+	frame -> block in a single memory block
+
+	Frames of the same size are placed one after another, where every frame starts at a
+	multiple of DEFAULT_ALIGNMENT bytes, so the elements of a pixel across frames, e.g., a
+	spectrum of bands mapped to frames, are evenly spaced by GetElemPerFrame().
+	Each frame is accessed by a BIP view as ImageFrame<T>::GetView() does.
+	*/
+	template <typename T>
+	class ContinuousImageBlock
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef std::vector<T, AlignedAllocator<T> > Container;
+		typedef typename Container::allocator_type Allocator;
+		typedef typename Container::size_type SizeType;
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		ContinuousImageBlock(void);
+		ContinuousImageBlock(const ContinuousImageBlock<T> &src);
+		ContinuousImageBlock<T> &operator=(const ContinuousImageBlock<T> &src);
+
+		/** Moves image data without copying it. The source block becomes empty. */
+		ContinuousImageBlock(ContinuousImageBlock<T> &&src) IMAGING_NOEXCEPT;
+		ContinuousImageBlock<T> &operator=(ContinuousImageBlock<T> &&src) IMAGING_NOEXCEPT;
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		explicit ContinuousImageBlock(const Allocator &alloc);
+		ContinuousImageBlock(const Size3D<SizeType> &sz, SizeType n, ::size_t alignment = 0,
+			const Allocator &alloc = Allocator());
+
+		//////////////////////////////////////////////////
+		// Accessors.
+
+		/** Accesses a frame by a BIP view without copying data. */
+		ImageView<T> operator[](SizeType pos);
+		ImageView<const T> operator[](SizeType pos) const;
+
+		/** Copies the elements of (x, y, c) of all frames to dst, e.g., a spectrum of a
+		pixel. */
+		void GetSpectrum(SizeType x, SizeType y, SizeType c, T *dst) const;
+
+		/** Copies src to the elements of (x, y, c) of all frames. */
+		void SetSpectrum(SizeType x, SizeType y, SizeType c, const T *src);
+
+		const Container &data;
+
+		/** Size of every frame. */
+		const Size3D<SizeType> &size;
+
+		//////////////////////////////////////////////////
+		// Methods.
+		void Clear(void);
+
+		/** Resizes every frame and the number of frames.
+
+		@NOTE Existing image data is NOT preserved if the frame size is changed. */
+		void Resize(const Size3D<SizeType> &sz, SizeType n,
+			ResizeMode mode = ResizeMode::ZERO_FILLED);
+
+		/** Exchanges image data with another block without copying it. */
+		void Swap(ContinuousImageBlock<T> &rhs) IMAGING_NOEXCEPT;
+
+		SizeType GetFrameCount(void) const;
+
+		/** Returns the line alignment in bytes. Zero means no padding elements. */
+		::size_t GetAlignment(void) const;
+
+		/** Sets the line alignment in bytes, and reallocates the block as necessary.
+
+		@NOTE Existing image data is NOT preserved if the line alignment is changed. */
+		void SetAlignment(::size_t alignment);
+
+		/** Returns the number of elements from a line to the next line including padding
+		elements. */
+		SizeType GetElemPerLine(void) const;
+		::size_t GetBytesPerLine(void) const;
+
+		/** Returns the number of elements from a frame to the next frame including padding
+		elements. */
+		SizeType GetElemPerFrame(void) const;
+
+		Allocator GetAllocator(void) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Methods.
+		SizeType GetOffset(SizeType x, SizeType y, SizeType c = 0) const;
+		SizeType GetElemPerLine(SizeType nElemWidth) const;
+		SizeType GetElemPerFrame(const Size3D<SizeType> &sz) const;
+
+		//////////////////////////////////////////////////
+		// Data.
+		Container data_;
+		Size3D<SizeType> size_;
+		SizeType nFrames_;
+		::size_t alignment_;
+	};
+
+	template <typename T>
+	void swap(ImageFrame<T> &a, ImageFrame<T> &b);
+
+	template <typename T>
+	void swap(ImageBlock<T> &a, ImageBlock<T> &b);
+
+	template <typename T>
+	void swap(ContinuousImageBlock<T> &a, ContinuousImageBlock<T> &b);
+
 	// case A: band <-> channel, either single-channel or multi-channel
 	// case B: band <-> frame
 
@@ -123,35 +294,107 @@ namespace Imaging
 	channel -> band, pixel -> column, line -> row, frame -> t (case A)
 	*/
 
-	// a single data set to a single frame, band -> channel.
+	/** Returns a view of a storage data set of sz.width * sz.height * sz.depth elements
+	without padding elements.
+
+	@exception std::invalid_argument	if the number of elements is not matched with sz */
+	template <typename T>
+	ImageView<T> GetStorageView(T *data, ::size_t nElem,
+		const Size3D<typename ImageView<T>::SizeType> &sz, ImageFormat fmt);
+
+	/** Copies every channel of a view to the single-channel view of the same index, e.g.,
+	bands of a storage data set to frames.
+
+	Rows are copied in parallel, and each row is copied tile by tile of pixels, so a tile of
+	a BIP source stays in the cache while it is scattered to the channels.
+	@NOTE all views must have the same width and height. */
+	template <typename T>
+	void SplitChannels(const ImageView<const T> &src, const std::vector<ImageView<T> > &dst);
+
+	/** Copies single-channel views to the channels of the same index of a view, e.g.,
+	frames to bands of a storage data set. See SplitChannels(). */
+	template <typename T>
+	void MergeChannels(const std::vector<ImageView<const T> > &src,
+		const ImageView<T> &dst);
+
+	/** Copies a view to another view of the same size, where rows are copied in
+	parallel. */
+	template <typename T>
+	void CopyRows(const ImageView<const T> &src, const ImageView<T> &dst);
+
+	// The conversions below copy image data through views, so the image format of storage
+	// data sets is converted by Copy() for views, and the destination is allocated once
+	// without zero-filling. Storage data sets are continuous without padding elements, so
+	// sz.width * sz.height * sz.depth elements.
+
+	/** a single data set to a single frame, band -> channel.
+
+	@exception std::invalid_argument	if the number of elements is not matched with sz */
 	template <typename T>
-	void ConvertBand2Channel(const std::vector<T> &src, ImageFormat fmtSrc,
+	void ConvertBand2Channel(const std::vector<T> &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
 		ImageFrame<T> &dst);
 
-	// multi data sets to a block (?), band -> channel, [t] -> frame
+	/** multi data sets to a block, band -> channel, [t] -> frame.
+	All data sets have the same size, and the frames are converted in parallel. */
 	template <typename T>
-	void ConvertBand2Channel(const std::vector<std::vector<T> > &src, ImageFormat fmtSrc,
+	void ConvertBand2Channel(const std::vector<std::vector<T> > &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
 		ImageBlock<T> &dst);
 
-	// a single data set to a block, band -> frame.
+	/** a single data set to a block, band -> frame. */
 	template <typename T>
-	void ConvertBand2Frame(const std::vector<T> &src, ImageFormat fmtSrc,
+	void ConvertBand2Frame(const std::vector<T> &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
 		ImageBlock<T> &dst);
 
-	// a single frame to single data set, channel -> band.
+	/** a single data set to a block in a single memory block, band -> frame. */
+	template <typename T>
+	void ConvertBand2Frame(const std::vector<T> &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
+		ContinuousImageBlock<T> &dst);
+
+	/** a single frame to single data set, channel -> band. */
 	template <typename T>
 	void ConvertChannel2Band(const ImageFrame<T> &src, std::vector<T> &dst,
 		ImageFormat fmtDst);
 
-	// a block to multi data sets, channel -> band, frame -> [t]
+	/** a block to multi data sets, channel -> band, frame -> [t]. */
 	template <typename T>
 	void ConvertChannel2Band(const ImageBlock<T> &src, std::vector<std::vector<T> > &dst,
 		ImageFormat fmtDst);
 
-	// a block to a single data set, if channel = 1, frame -> band.
+	/** a block to a single data set, if channel = 1, frame -> band.
+
+	@exception std::invalid_argument	if a frame has multiple channels, or the frames
+	have different sizes */
 	template <typename T>
 	void ConvertFrame2Band(const ImageBlock<T> &src, std::vector<T> &dst,
 		ImageFormat fmtDst);
+
+	/** a block in a single memory block to a single data set, if channel = 1,
+	frame -> band.
+
+	@exception std::invalid_argument	if frames have multiple channels */
+	template <typename T>
+	void ConvertFrame2Band(const ContinuousImageBlock<T> &src, std::vector<T> &dst,
+		ImageFormat fmtDst);
+
+	/** Calls func(n, frame) for every frame n of a block in parallel by the shared thread
+	pool, where a frame is a task. */
+	template <typename T, typename Function>
+	void ParallelFor(ImageBlock<T> &block, Function func);
+
+	template <typename T, typename Function>
+	void ParallelFor(const ImageBlock<T> &block, Function func);
+
+	/** Calls func(n, view) for every frame n of a block in parallel, where view is the BIP
+	view of the frame. */
+	template <typename T, typename Function>
+	void ParallelFor(ContinuousImageBlock<T> &block, Function func);
+
+	template <typename T, typename Function>
+	void ParallelFor(const ContinuousImageBlock<T> &block, Function func);
 }
 
 #include "image2_inl.h"
@@ -10,84 +10,849 @@ namespace Imaging
 	// Default constructors.
 	template <typename T>
 	ImageFrame<T>::ImageFrame(void) : data(data_), size(size_),
-		size_(Size3D<SizeType>(0, 0, 0)) {}
+		size_(Size3D<SizeType>(0, 0, 0)), alignment_(0) {}
 
+	// A delegating constructor cannot initialize any other member, so the members are
+	// initialized directly.
 	template <typename T>
-	ImageFrame<T>::ImageFrame(const ImageFrame<T> &src) :
-#if _MSC_VER > 1700	// from VS2013
-		Image<T>(),
-#else				// up to VS2012
-		data(data_), size(size_),
-#endif
-		data_(src.data) { size_ = src.size; }
-
-//	template <typename T>
-//	ImageFrame<T>::ImageFrame(ImageFrame<T> &&src) :
-//#if _MSC_VER > 1700	// from VS2013
-//		Image<T>(),
-//#else				// up to VS2012
-//		data(data_), size(size_),
-//#endif
-//		// TODO: Next line won't work because src.data is const &!!!
-//		data_(std::move(src.data)) { size_ = src.size; }
+	ImageFrame<T>::ImageFrame(const ImageFrame<T> &src) : data(data_), size(size_),
+		data_(src.data), size_(src.size), alignment_(src.alignment_) {}
 
 	template <typename T>
 	ImageFrame<T> &ImageFrame<T>::operator=(const ImageFrame<T> &src)
 	{
 		this->data_ = src.data;
 		this->size_ = src.size;
+		this->alignment_ = src.alignment_;
 		return *this;
 	}
 
-	//template <typename T>
-	//ImageFrame<T> &ImageFrame<T>::operator=(ImageFrame<T> &&src)
-	//{
-	//	this->data_ = std::move(src.data);
-	//	this->size_ = std::move(src.size);
-	//	return *this;
-	//}
+	/** src.data is a const reference, so the container is moved from src.data_ while the
+	reference members are bound to the members of this object. */
+	template <typename T>
+	ImageFrame<T>::ImageFrame(ImageFrame<T> &&src) IMAGING_NOEXCEPT : data(data_), size(size_),
+		data_(std::move(src.data_)), size_(src.size_), alignment_(src.alignment_)
+	{
+		src.Clear();
+	}
+
+	template <typename T>
+	ImageFrame<T> &ImageFrame<T>::operator=(ImageFrame<T> &&src) IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->data_ = std::move(src.data_);
+			this->size_ = src.size;
+			this->alignment_ = src.alignment_;
+			src.Clear();
+		}
+		return *this;
+	}
 
 	//////////////////////////////////////////////////////////////////////////
 	// Custom constructors.
 	template <typename T>
-	ImageFrame<T>::ImageFrame(const Size3D<SizeType> &sz) :
+	ImageFrame<T>::ImageFrame(const Allocator &alloc) : data(data_), size(size_),
+		data_(alloc), size_(Size3D<SizeType>(0, 0, 0)), alignment_(0) {}
+
+	template <typename T>
+	ImageFrame<T>::ImageFrame(const Size3D<SizeType> &sz, ::size_t alignment,
+		const Allocator &alloc) :
 #if _MSC_VER > 1700	// from VS2013
-		ImageFrame<T>()
+		ImageFrame<T>(alloc)
 #else				// up to VS2012
-		data(data_), size(size_)
+		data(data_), size(size_), data_(alloc), size_(Size3D<SizeType>(0, 0, 0)),
+		alignment_(0)
 #endif
 	{
+		this->SetAlignment(alignment);
 		this->Resize(sz);
 	}
 
 	template <typename T>
-	ImageFrame<T>::ImageFrame(SizeType width, SizeType height, SizeType depth) :
+	ImageFrame<T>::ImageFrame(SizeType width, SizeType height, SizeType depth,
+		::size_t alignment, const Allocator &alloc) :
 #if _MSC_VER > 1700	// from VS2013
-		ImageFrame<T>(Size3D<SizeType>(width, height, depth), fmt) {}
+		ImageFrame<T>(Size3D<SizeType>(width, height, depth), alignment, alloc) {}
 #else				// up to VS2012
-		data(data_), size(size_)
+		data(data_), size(size_), data_(alloc), size_(Size3D<SizeType>(0, 0, 0)),
+		alignment_(0)
 	{
+		this->SetAlignment(alignment);
 		this->Resize(width, height, depth);
 	}
 #endif
 
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+
+	template <typename T>
+	T &ImageFrame<T>::operator()(SizeType x, SizeType y, SizeType c)
+	{
+		return this->data_.at(this->GetOffset(x, y, c));
+	}
+
+	template <typename T>
+	const T &ImageFrame<T>::operator()(SizeType x, SizeType y, SizeType c) const
+	{
+		return this->data.at(this->GetOffset(x, y, c));
+	}
+
+	template <typename T>
+	ImageView<T> ImageFrame<T>::GetView(void)
+	{
+		return ImageView<T>(this->data_.data(), this->size, ImageFormat::BIP,
+			this->GetElemPerLine());
+	}
+
+	template <typename T>
+	ImageView<const T> ImageFrame<T>::GetView(void) const
+	{
+		return ImageView<const T>(this->data.data(), this->size, ImageFormat::BIP,
+			this->GetElemPerLine());
+	}
+
+	template <typename T>
+	ImageView<T> ImageFrame<T>::GetView(const Region<SizeType, SizeType> &roi)
+	{
+		return this->GetView().GetView(roi);
+	}
+
+	template <typename T>
+	ImageView<const T> ImageFrame<T>::GetView(const Region<SizeType, SizeType> &roi) const
+	{
+		return this->GetView().GetView(roi);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	template <typename T>
+	void ImageFrame<T>::Clear(void)
+	{
+		this->data_.clear();
+		this->size_ = Size3D<SizeType>(0, 0, 0);
+	}
+
+	template <typename T>
+	void ImageFrame<T>::Swap(ImageFrame<T> &rhs) IMAGING_NOEXCEPT
+	{
+		this->data_.swap(rhs.data_);
+		std::swap(this->size_, rhs.size_);
+		std::swap(this->alignment_, rhs.alignment_);
+	}
+
+	template <typename T>
+	typename ImageFrame<T>::SizeType ImageFrame<T>::GetOffset(SizeType x, SizeType y,
+		SizeType c) const
+	{
+		return c + this->size.depth * x +
+			this->GetElemPerLine(this->size.depth * this->size.width) * y;
+	}
+
+	template <typename T>
+	typename ImageFrame<T>::SizeType ImageFrame<T>::GetElemPerLine(SizeType nElemWidth) const
+	{
+		if (this->alignment_ == 0)
+			return nElemWidth;
+		else
+			return RoundUp<SizeType>(nElemWidth, this->alignment_ / sizeof(T));
+	}
+
+	template <typename T>
+	typename ImageFrame<T>::SizeType ImageFrame<T>::GetElemPerLine(void) const
+	{
+		return this->GetElemPerLine(this->size.depth * this->size.width);
+	}
+
+	template <typename T>
+	::size_t ImageFrame<T>::GetBytesPerLine(void) const
+	{
+		return this->GetElemPerLine() * sizeof(T);
+	}
+
+	template <typename T>
+	typename ImageFrame<T>::Allocator ImageFrame<T>::GetAllocator(void) const
+	{
+		return this->data.get_allocator();
+	}
+
+	template <typename T>
+	::size_t ImageFrame<T>::GetAlignment(void) const
+	{
+		return this->alignment_;
+	}
+
+	template <typename T>
+	void ImageFrame<T>::SetAlignment(::size_t alignment)
+	{
+		if (alignment % sizeof(T) != 0)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Alignment " << alignment << " is not a multiple of " << sizeof(T) <<
+				" bytes.";
+			throw std::invalid_argument(errMsg.str());
+		}
+		this->alignment_ = alignment;
+		this->Resize(this->size);
+	}
+
 	/** Resizes the std::vector<T> object only if necessary.
 	If size is changed while the total number of elements are the same (reshaping),
-	it does NOT run resize() function of the std::vector<T>. */
+	it does NOT run resize() function of the std::vector<T>.
+	New elements are zero-filled unless ResizeMode::UNINITIALIZED is given. */
+	template <typename T>
+	void ImageFrame<T>::Resize(const Size3D<SizeType> &sz, ResizeMode mode)
+	{
+		SizeType nElem = this->GetElemPerLine(sz.depth * sz.width) * sz.height;
+		if (this->data.size() != nElem)
+		{
+			const SizeType nElemOld = this->data.size();
+			this->data_.resize(nElem);
+			if (mode == ResizeMode::ZERO_FILLED && nElem > nElemOld)
+				std::fill(this->data_.begin() + nElemOld, this->data_.end(), T());
+		}
+		this->size_ = sz;
+	}
+
+	template <typename T>
+	void ImageFrame<T>::Resize(SizeType width, SizeType height, SizeType depth,
+		ResizeMode mode)
+	{
+		this->Resize(Size3D<SizeType>(width, height, depth), mode);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ImageBlock<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T>
+	ImageBlock<T>::ImageBlock(void) {}
+
+	template <typename T>
+	ImageBlock<T>::ImageBlock(const ImageBlock<T> &src) : frames_(src.frames_) {}
+
+	template <typename T>
+	ImageBlock<T> &ImageBlock<T>::operator=(const ImageBlock<T> &src)
+	{
+		this->frames_ = src.frames_;
+		return *this;
+	}
+
+	/** Declared explicitly because VS2013 and older do not generate move constructors.
+	The move constructors of all classes are noexcept, so std::vector<T> moves frames
+	instead of copying them when it grows. */
+	template <typename T>
+	ImageBlock<T>::ImageBlock(ImageBlock<T> &&src) IMAGING_NOEXCEPT : frames_(std::move(src.frames_))
+	{
+		src.frames_.clear();
+	}
+
+	template <typename T>
+	ImageBlock<T> &ImageBlock<T>::operator=(ImageBlock<T> &&src) IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->frames_ = std::move(src.frames_);
+			src.frames_.clear();
+		}
+		return *this;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+
+	template <typename T>
+	ImageFrame<T> &ImageBlock<T>::operator[](SizeType pos)
+	{
+		return this->frames_.at(pos);
+	}
+
+	template <typename T>
+	const ImageFrame<T> &ImageBlock<T>::operator[](SizeType pos) const
+	{
+		return this->frames_.at(pos);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	template <typename T>
+	void ImageBlock<T>::Clear(void)
+	{
+		this->frames_.clear();
+	}
+
+	template <typename T>
+	void ImageBlock<T>::Resize(SizeType n)
+	{
+		this->frames_.resize(n);
+	}
+
+	/** Existing frames keep their buffers if the size is not changed, so a block converted
+	repeatedly for the same size is allocated only once. */
+	template <typename T>
+	void ImageBlock<T>::Resize(const Size3D<typename ImageFrame<T>::SizeType> &sz,
+		SizeType n, ResizeMode mode)
+	{
+		this->frames_.resize(n);
+		for (auto it = this->frames_.begin(); it != this->frames_.end(); ++it)
+			it->Resize(sz, mode);
+	}
+
+	template <typename T>
+	typename ImageBlock<T>::SizeType ImageBlock<T>::GetFrameCount(void) const
+	{
+		return this->frames_.size();
+	}
+
+	template <typename T>
+	void ImageBlock<T>::Swap(ImageBlock<T> &rhs) IMAGING_NOEXCEPT
+	{
+		this->frames_.swap(rhs.frames_);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ContinuousImageBlock<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T>
+	ContinuousImageBlock<T>::ContinuousImageBlock(void) : data(data_), size(size_),
+		size_(Size3D<SizeType>(0, 0, 0)), nFrames_(0), alignment_(0) {}
+
+	template <typename T>
+	ContinuousImageBlock<T>::ContinuousImageBlock(const ContinuousImageBlock<T> &src) :
+		data(data_), size(size_), data_(src.data), size_(src.size), nFrames_(src.nFrames_),
+		alignment_(src.alignment_) {}
+
+	template <typename T>
+	ContinuousImageBlock<T> &ContinuousImageBlock<T>::operator=(
+		const ContinuousImageBlock<T> &src)
+	{
+		this->data_ = src.data;
+		this->size_ = src.size;
+		this->nFrames_ = src.nFrames_;
+		this->alignment_ = src.alignment_;
+		return *this;
+	}
+
+	template <typename T>
+	ContinuousImageBlock<T>::ContinuousImageBlock(
+		ContinuousImageBlock<T> &&src) IMAGING_NOEXCEPT : data(data_), size(size_),
+		data_(std::move(src.data_)), size_(src.size_), nFrames_(src.nFrames_),
+		alignment_(src.alignment_)
+	{
+		src.Clear();
+	}
+
+	template <typename T>
+	ContinuousImageBlock<T> &ContinuousImageBlock<T>::operator=(
+		ContinuousImageBlock<T> &&src) IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->data_ = std::move(src.data_);
+			this->size_ = src.size;
+			this->nFrames_ = src.nFrames_;
+			this->alignment_ = src.alignment_;
+			src.Clear();
+		}
+		return *this;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	template <typename T>
+	ContinuousImageBlock<T>::ContinuousImageBlock(const Allocator &alloc) : data(data_),
+		size(size_), data_(alloc), size_(Size3D<SizeType>(0, 0, 0)), nFrames_(0),
+		alignment_(0) {}
+
+	template <typename T>
+	ContinuousImageBlock<T>::ContinuousImageBlock(const Size3D<SizeType> &sz, SizeType n,
+		::size_t alignment, const Allocator &alloc) :
+#if _MSC_VER > 1700	// from VS2013
+		ContinuousImageBlock<T>(alloc)
+#else				// up to VS2012
+		data(data_), size(size_), data_(alloc), size_(Size3D<SizeType>(0, 0, 0)),
+		nFrames_(0), alignment_(0)
+#endif
+	{
+		this->SetAlignment(alignment);
+		this->Resize(sz, n);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+
+	template <typename T>
+	ImageView<T> ContinuousImageBlock<T>::operator[](SizeType pos)
+	{
+		if (pos >= this->nFrames_)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Frame " << pos << " is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+		return ImageView<T>(this->data_.data() + pos * this->GetElemPerFrame(), this->size,
+			ImageFormat::BIP, this->GetElemPerLine());
+	}
+
 	template <typename T>
-	void ImageFrame<T>::Resize(const Size3D<SizeType> &sz)
+	ImageView<const T> ContinuousImageBlock<T>::operator[](SizeType pos) const
 	{
-		SizeType nElem = sz.width * sz.height * sz.depth;
+		if (pos >= this->nFrames_)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Frame " << pos << " is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+		return ImageView<const T>(this->data.data() + pos * this->GetElemPerFrame(),
+			this->size, ImageFormat::BIP, this->GetElemPerLine());
+	}
+
+	template <typename T>
+	void ContinuousImageBlock<T>::GetSpectrum(SizeType x, SizeType y, SizeType c,
+		T *dst) const
+	{
+		if (this->nFrames_ == 0)
+			return;
+		const T *p = &(*this)[0](x, y, c);	// checks the range once.
+		const SizeType step = this->GetElemPerFrame();
+		for (SizeType N = 0; N != this->nFrames_; ++N)
+			dst[N] = p[N * step];
+	}
+
+	template <typename T>
+	void ContinuousImageBlock<T>::SetSpectrum(SizeType x, SizeType y, SizeType c,
+		const T *src)
+	{
+		if (this->nFrames_ == 0)
+			return;
+		T *p = &(*this)[0](x, y, c);	// checks the range once.
+		const SizeType step = this->GetElemPerFrame();
+		for (SizeType N = 0; N != this->nFrames_; ++N)
+			p[N * step] = src[N];
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	template <typename T>
+	void ContinuousImageBlock<T>::Clear(void)
+	{
+		this->data_.clear();
+		this->size_ = Size3D<SizeType>(0, 0, 0);
+		this->nFrames_ = 0;
+	}
+
+	/** Resizes the std::vector<T> object only if the total number of elements is changed.
+	New elements are zero-filled unless ResizeMode::UNINITIALIZED is given. */
+	template <typename T>
+	void ContinuousImageBlock<T>::Resize(const Size3D<SizeType> &sz, SizeType n,
+		ResizeMode mode)
+	{
+		const SizeType nElem = this->GetElemPerFrame(sz) * n;
 		if (this->data.size() != nElem)
+		{
+			const SizeType nElemOld = this->data.size();
 			this->data_.resize(nElem);
+			if (mode == ResizeMode::ZERO_FILLED && nElem > nElemOld)
+				std::fill(this->data_.begin() + nElemOld, this->data_.end(), T());
+		}
 		this->size_ = sz;
+		this->nFrames_ = n;
+	}
+
+	template <typename T>
+	void ContinuousImageBlock<T>::Swap(ContinuousImageBlock<T> &rhs) IMAGING_NOEXCEPT
+	{
+		this->data_.swap(rhs.data_);
+		std::swap(this->size_, rhs.size_);
+		std::swap(this->nFrames_, rhs.nFrames_);
+		std::swap(this->alignment_, rhs.alignment_);
+	}
+
+	template <typename T>
+	typename ContinuousImageBlock<T>::SizeType ContinuousImageBlock<T>::GetFrameCount(
+		void) const
+	{
+		return this->nFrames_;
 	}
 
 	template <typename T>
-	void ImageFrame<T>::Resize(SizeType width, SizeType height, SizeType depth)
+	::size_t ContinuousImageBlock<T>::GetAlignment(void) const
 	{
-		this->Resize(Size3D<SizeType>(width, height, depth));
+		return this->alignment_;
 	}
 
+	template <typename T>
+	void ContinuousImageBlock<T>::SetAlignment(::size_t alignment)
+	{
+		if (alignment % sizeof(T) != 0)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Alignment " << alignment << " is not a multiple of " << sizeof(T) <<
+				" bytes.";
+			throw std::invalid_argument(errMsg.str());
+		}
+		this->alignment_ = alignment;
+		this->Resize(this->size, this->nFrames_);
+	}
+
+	template <typename T>
+	typename ContinuousImageBlock<T>::SizeType ContinuousImageBlock<T>::GetOffset(
+		SizeType x, SizeType y, SizeType c) const
+	{
+		return c + this->size.depth * x + this->GetElemPerLine() * y;
+	}
+
+	template <typename T>
+	typename ContinuousImageBlock<T>::SizeType ContinuousImageBlock<T>::GetElemPerLine(
+		SizeType nElemWidth) const
+	{
+		if (this->alignment_ == 0)
+			return nElemWidth;
+		else
+			return RoundUp<SizeType>(nElemWidth, this->alignment_ / sizeof(T));
+	}
+
+	template <typename T>
+	typename ContinuousImageBlock<T>::SizeType ContinuousImageBlock<T>::GetElemPerLine(
+		void) const
+	{
+		return this->GetElemPerLine(this->size.depth * this->size.width);
+	}
+
+	template <typename T>
+	::size_t ContinuousImageBlock<T>::GetBytesPerLine(void) const
+	{
+		return this->GetElemPerLine() * sizeof(T);
+	}
+
+	template <typename T>
+	typename ContinuousImageBlock<T>::SizeType ContinuousImageBlock<T>::GetElemPerFrame(
+		void) const
+	{
+		return this->GetElemPerFrame(this->size);
+	}
+
+	/** Every frame starts at a multiple of DEFAULT_ALIGNMENT bytes as the first frame
+	allocated by AlignedAllocator<T> does. */
+	template <typename T>
+	typename ContinuousImageBlock<T>::SizeType ContinuousImageBlock<T>::GetElemPerFrame(
+		const Size3D<SizeType> &sz) const
+	{
+		return RoundUp<SizeType>(this->GetElemPerLine(sz.depth * sz.width) * sz.height,
+			std::max<SizeType>(DEFAULT_ALIGNMENT / sizeof(T), 1));
+	}
+
+	template <typename T>
+	typename ContinuousImageBlock<T>::Allocator ContinuousImageBlock<T>::GetAllocator(
+		void) const
+	{
+		return this->data.get_allocator();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	template <typename T>
+	void swap(ImageFrame<T> &a, ImageFrame<T> &b)
+	{
+		a.Swap(b);
+	}
+
+	template <typename T>
+	void swap(ImageBlock<T> &a, ImageBlock<T> &b)
+	{
+		a.Swap(b);
+	}
+
+	template <typename T>
+	void swap(ContinuousImageBlock<T> &a, ContinuousImageBlock<T> &b)
+	{
+		a.Swap(b);
+	}
+
+	template <typename T>
+	ImageView<T> GetStorageView(T *data, ::size_t nElem,
+		const Size3D<typename ImageView<T>::SizeType> &sz, ImageFormat fmt)
+	{
+		if (nElem != sz.width * sz.height * sz.depth)
+		{
+			std::ostringstream errMsg;
+			errMsg << "The number of elements " << nElem << " is not matched with " <<
+				sz.width << " x " << sz.height << " x " << sz.depth << ".";
+			throw std::invalid_argument(errMsg.str());
+		}
+		return ImageView<T>(data, sz, fmt,
+			fmt == ImageFormat::BIP ? sz.width * sz.depth : sz.width);
+	}
+
+	template <typename T>
+	void SplitChannels(const ImageView<const T> &src, const std::vector<ImageView<T> > &dst)
+	{
+		const auto size = src.size;
+		if (dst.size() != size.depth)
+			throw std::invalid_argument(
+			"The number of destination views should be the number of channels.");
+		for (auto it = dst.begin(); it != dst.end(); ++it)
+			if (it->size.width != size.width || it->size.height != size.height)
+				throw std::invalid_argument(
+				"Size of source/destination images should be identical.");
+
+		const ::size_t nTile = std::max< ::size_t>(DEFAULT_ALIGNMENT / sizeof(T), 8);
+		ParallelFor(0, size.height, [&](::size_t H)
+		{
+			const T *p_src = src.GetPointer(0, H);
+			for (::size_t X0 = 0; X0 < size.width; X0 += nTile)
+			{
+				const ::size_t X1 = std::min(X0 + nTile, size.width);
+				for (::size_t C = 0; C != size.depth; ++C)
+				{
+					const T *p = p_src + C * src.step.z;
+					T *q = dst[C].GetPointer(0, H);
+					const auto stepSrc = src.step.x;
+					const auto stepDst = dst[C].step.x;
+					for (::size_t X = X0; X != X1; ++X)
+						q[X * stepDst] = p[X * stepSrc];
+				}
+			}
+		});
+	}
+
+	template <typename T>
+	void MergeChannels(const std::vector<ImageView<const T> > &src,
+		const ImageView<T> &dst)
+	{
+		const auto size = dst.size;
+		if (src.size() != size.depth)
+			throw std::invalid_argument(
+			"The number of source views should be the number of channels.");
+		for (auto it = src.begin(); it != src.end(); ++it)
+			if (it->size.width != size.width || it->size.height != size.height)
+				throw std::invalid_argument(
+				"Size of source/destination images should be identical.");
+
+		const ::size_t nTile = std::max< ::size_t>(DEFAULT_ALIGNMENT / sizeof(T), 8);
+		ParallelFor(0, size.height, [&](::size_t H)
+		{
+			T *p_dst = dst.GetPointer(0, H);
+			for (::size_t X0 = 0; X0 < size.width; X0 += nTile)
+			{
+				const ::size_t X1 = std::min(X0 + nTile, size.width);
+				for (::size_t C = 0; C != size.depth; ++C)
+				{
+					const T *p = src[C].GetPointer(0, H);
+					T *q = p_dst + C * dst.step.z;
+					const auto stepSrc = src[C].step.x;
+					const auto stepDst = dst.step.x;
+					for (::size_t X = X0; X != X1; ++X)
+						q[X * stepDst] = p[X * stepSrc];
+				}
+			}
+		});
+	}
+
+	/** Each row is a view of the ROI, so Copy() selects the logic for the image formats
+	including the conversion between them. */
+	template <typename T>
+	void CopyRows(const ImageView<const T> &src, const ImageView<T> &dst)
+	{
+		if (src.size != dst.size)
+			throw std::runtime_error(
+			"Size of source/destination images should be identical.");
+
+		typedef typename ImageView<T>::SizeType SizeType;
+		ParallelFor(0, src.size.height, [&](::size_t H)
+		{
+			const Region<SizeType, SizeType> roi(0, H, src.size.width, 1);
+			Copy(src.GetView(roi), dst.GetView(roi));
+		});
+	}
+
+	template <typename T>
+	void ConvertBand2Channel(const std::vector<T> &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
+		ImageFrame<T> &dst)
+	{
+		const ImageView<const T> viewSrc = GetStorageView(src.data(), src.size(), sz,
+			fmtSrc);
+		dst.Resize(sz, ResizeMode::UNINITIALIZED);
+		CopyRows(viewSrc, dst.GetView());
+	}
+
+	template <typename T>
+	void ConvertBand2Channel(const std::vector<std::vector<T> > &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
+		ImageBlock<T> &dst)
+	{
+		std::vector<ImageView<const T> > viewSrc;
+		viewSrc.reserve(src.size());
+		for (auto it = src.begin(); it != src.end(); ++it)
+			viewSrc.push_back(GetStorageView(it->data(), it->size(), sz, fmtSrc));
+
+		dst.Resize(sz, src.size(), ResizeMode::UNINITIALIZED);
+		ParallelFor(0, src.size(), [&](::size_t N)
+		{
+			Copy(viewSrc[N], dst[N].GetView());
+		});
+	}
+
+	template <typename T>
+	void ConvertBand2Frame(const std::vector<T> &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
+		ImageBlock<T> &dst)
+	{
+		typedef typename ImageFrame<T>::SizeType SizeType;
+		const ImageView<const T> viewSrc = GetStorageView(src.data(), src.size(), sz,
+			fmtSrc);
+		dst.Resize(Size3D<SizeType>(sz.width, sz.height, 1), sz.depth,
+			ResizeMode::UNINITIALIZED);
+
+		std::vector<ImageView<T> > viewDst;
+		viewDst.reserve(sz.depth);
+		for (SizeType N = 0; N != sz.depth; ++N)
+			viewDst.push_back(dst[N].GetView());
+		SplitChannels(viewSrc, viewDst);
+	}
+
+	template <typename T>
+	void ConvertBand2Frame(const std::vector<T> &src,
+		const Size3D<typename ImageFrame<T>::SizeType> &sz, ImageFormat fmtSrc,
+		ContinuousImageBlock<T> &dst)
+	{
+		typedef typename ImageFrame<T>::SizeType SizeType;
+		const ImageView<const T> viewSrc = GetStorageView(src.data(), src.size(), sz,
+			fmtSrc);
+		dst.Resize(Size3D<SizeType>(sz.width, sz.height, 1), sz.depth,
+			ResizeMode::UNINITIALIZED);
+
+		std::vector<ImageView<T> > viewDst;
+		viewDst.reserve(sz.depth);
+		for (SizeType N = 0; N != sz.depth; ++N)
+			viewDst.push_back(dst[N]);
+		SplitChannels(viewSrc, viewDst);
+	}
+
+	template <typename T>
+	void ConvertChannel2Band(const ImageFrame<T> &src, std::vector<T> &dst,
+		ImageFormat fmtDst)
+	{
+		const auto &sz = src.size;
+		dst.resize(sz.width * sz.height * sz.depth);
+		CopyRows(src.GetView(), GetStorageView(dst.data(), dst.size(), sz, fmtDst));
+	}
+
+	template <typename T>
+	void ConvertChannel2Band(const ImageBlock<T> &src, std::vector<std::vector<T> > &dst,
+		ImageFormat fmtDst)
+	{
+		dst.resize(src.GetFrameCount());
+		std::vector<ImageView<T> > viewDst;
+		viewDst.reserve(dst.size());
+		for (::size_t N = 0; N != dst.size(); ++N)
+		{
+			const auto &sz = src[N].size;
+			dst[N].resize(sz.width * sz.height * sz.depth);
+			viewDst.push_back(GetStorageView(dst[N].data(), dst[N].size(), sz, fmtDst));
+		}
+
+		ParallelFor(0, dst.size(), [&](::size_t N)
+		{
+			Copy(src[N].GetView(), viewDst[N]);
+		});
+	}
+
+	template <typename T>
+	void ConvertFrame2Band(const ImageBlock<T> &src, std::vector<T> &dst,
+		ImageFormat fmtDst)
+	{
+		typedef typename ImageFrame<T>::SizeType SizeType;
+		const SizeType n = src.GetFrameCount();
+		if (n == 0)
+		{
+			dst.clear();
+			return;
+		}
+
+		const Size3D<SizeType> sz(src[0].size.width, src[0].size.height, n);
+		std::vector<ImageView<const T> > viewSrc;
+		viewSrc.reserve(n);
+		for (SizeType N = 0; N != n; ++N)
+		{
+			const auto &szFrame = src[N].size;
+			if (szFrame.depth != 1)
+				throw std::invalid_argument("Every frame should have a single channel.");
+			if (szFrame.width != sz.width || szFrame.height != sz.height)
+				throw std::invalid_argument("Size of frames should be identical.");
+			viewSrc.push_back(src[N].GetView());
+		}
+
+		dst.resize(sz.width * sz.height * sz.depth);
+		MergeChannels(viewSrc, GetStorageView(dst.data(), dst.size(), sz, fmtDst));
+	}
+
+	template <typename T>
+	void ConvertFrame2Band(const ContinuousImageBlock<T> &src, std::vector<T> &dst,
+		ImageFormat fmtDst)
+	{
+		typedef typename ImageFrame<T>::SizeType SizeType;
+		const SizeType n = src.GetFrameCount();
+		if (n == 0)
+		{
+			dst.clear();
+			return;
+		}
+		if (src.size.depth != 1)
+			throw std::invalid_argument("Every frame should have a single channel.");
+
+		std::vector<ImageView<const T> > viewSrc;
+		viewSrc.reserve(n);
+		for (SizeType N = 0; N != n; ++N)
+			viewSrc.push_back(src[N]);
+
+		const Size3D<SizeType> sz(src.size.width, src.size.height, n);
+		dst.resize(sz.width * sz.height * sz.depth);
+		MergeChannels(viewSrc, GetStorageView(dst.data(), dst.size(), sz, fmtDst));
+	}
+
+	template <typename T, typename Function>
+	void ParallelFor(ImageBlock<T> &block, Function func)
+	{
+		ParallelFor(0, block.GetFrameCount(), [&](::size_t N)
+		{
+			func(N, block[N]);
+		}, 1);
+	}
+
+	template <typename T, typename Function>
+	void ParallelFor(const ImageBlock<T> &block, Function func)
+	{
+		ParallelFor(0, block.GetFrameCount(), [&](::size_t N)
+		{
+			func(N, block[N]);
+		}, 1);
+	}
+
+	template <typename T, typename Function>
+	void ParallelFor(ContinuousImageBlock<T> &block, Function func)
+	{
+		ParallelFor(0, block.GetFrameCount(), [&](::size_t N)
+		{
+			func(N, block[N]);
+		}, 1);
+	}
+
+	template <typename T, typename Function>
+	void ParallelFor(const ContinuousImageBlock<T> &block, Function func)
+	{
+		ParallelFor(0, block.GetFrameCount(), [&](::size_t N)
+		{
+			func(N, block[N]);
+		}, 1);
+	}
 }
 #endif
@@ -3,137 +3,1169 @@
 
 namespace Imaging
 {
+	/** The policy is given at compile time in most cases, so the branch is removed by the
+	compiler. */
+	inline bool IsRangeChecked(RangeCheck check)
+	{
+#if defined(NDEBUG)
+		return check == RangeCheck::CHECKED;
+#else
+		return check != RangeCheck::UNCHECKED;
+#endif
+	}
+
+	inline ::size_t GetElemSize(ImageDataType type)
+	{
+		switch (type)
+		{
+		case ImageDataType::UINT8:
+		case ImageDataType::INT8:
+			return 1;
+		case ImageDataType::UINT16:
+		case ImageDataType::INT16:
+			return 2;
+		case ImageDataType::UINT32:
+		case ImageDataType::INT32:
+		case ImageDataType::FLOAT32:
+			return 4;
+		case ImageDataType::UINT64:
+		case ImageDataType::INT64:
+		case ImageDataType::FLOAT64:
+			return 8;
+		default:
+			std::ostringstream errMsg;
+			errMsg << "Data type " << static_cast<int>(type) << " is not supported.";
+			throw std::logic_error(errMsg.str());
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ImageLayout<F> structs
+
+	IMAGING_CONSTEXPR ::size_t ImageLayout<ImageFormat::BIP>::GetElemWidth(::size_t width,
+		::size_t depth)
+	{
+		return depth * width;
+	}
+
+	IMAGING_CONSTEXPR ::size_t ImageLayout<ImageFormat::BIP>::GetOffset(::size_t x,
+		::size_t y, ::size_t c, ::size_t, ::size_t depth, ::size_t nElemPerLine)
+	{
+		return c + depth * x + nElemPerLine * y;
+	}
+
+	inline Point3D<::size_t> ImageLayout<ImageFormat::BIP>::GetStep(::size_t,
+		::size_t depth, ::size_t nElemPerLine)
+	{
+		return Point3D<::size_t>(depth, nElemPerLine, 1);
+	}
+
+	IMAGING_CONSTEXPR ::size_t ImageLayout<ImageFormat::BSQ>::GetElemWidth(::size_t width,
+		::size_t)
+	{
+		return width;
+	}
+
+	IMAGING_CONSTEXPR ::size_t ImageLayout<ImageFormat::BSQ>::GetOffset(::size_t x,
+		::size_t y, ::size_t c, ::size_t height, ::size_t, ::size_t nElemPerLine)
+	{
+		return x + nElemPerLine * (y + height * c);
+	}
+
+	inline Point3D<::size_t> ImageLayout<ImageFormat::BSQ>::GetStep(::size_t height,
+		::size_t, ::size_t nElemPerLine)
+	{
+		return Point3D<::size_t>(1, nElemPerLine, nElemPerLine * height);
+	}
+
+	IMAGING_CONSTEXPR ::size_t ImageLayout<ImageFormat::BIL>::GetElemWidth(::size_t width,
+		::size_t)
+	{
+		return width;
+	}
+
+	IMAGING_CONSTEXPR ::size_t ImageLayout<ImageFormat::BIL>::GetOffset(::size_t x,
+		::size_t y, ::size_t c, ::size_t, ::size_t depth, ::size_t nElemPerLine)
+	{
+		return x + nElemPerLine * (c + depth * y);
+	}
+
+	inline Point3D<::size_t> ImageLayout<ImageFormat::BIL>::GetStep(::size_t,
+		::size_t depth, ::size_t nElemPerLine)
+	{
+		return Point3D<::size_t>(1, nElemPerLine * depth, nElemPerLine);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ImageFormatBase<F> classes
+
+	template <ImageFormat F>
+	const ImageFormat ImageFormatBase<F>::format;
+
+	template <ImageFormat F>
+	ImageFormatBase<F>::ImageFormatBase(ImageFormat fmt)
+	{
+		this->SetFormat(fmt);
+	}
+
+	template <ImageFormat F>
+	void ImageFormatBase<F>::SetFormat(ImageFormat fmt) const
+	{
+		if (fmt != F)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Image format " << static_cast<int>(fmt) << " is not matched with " <<
+				static_cast<int>(F) << ".";
+			throw std::invalid_argument(errMsg.str());
+		}
+	}
+
+	inline ImageFormatBase<ImageFormat::UNKNOWN>::ImageFormatBase(ImageFormat fmt) :
+		format(fmt) {}
+
+	inline void ImageFormatBase<ImageFormat::UNKNOWN>::SetFormat(ImageFormat fmt)
+	{
+		this->format = fmt;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ImageView<T, R> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T, RangeCheck R>
+	ImageView<T, R>::ImageView(void) : size(size_), step(step_), format(format_),
+		data_(nullptr), size_(Size3D<SizeType>(0, 0, 0)), step_(Point3D<SizeType>(0, 0, 0)),
+		format_(ImageFormat::UNKNOWN) {}
+
+	template <typename T, RangeCheck R>
+	ImageView<T, R>::ImageView(const ImageView<T, R> &src) : size(size_), step(step_),
+		format(format_), data_(src.data_), size_(src.size_), step_(src.step_),
+		format_(src.format_) {}
+
+	template <typename T, RangeCheck R>
+	ImageView<T, R> &ImageView<T, R>::operator=(const ImageView<T, R> &src)
+	{
+		this->data_ = src.data_;
+		this->size_ = src.size_;
+		this->step_ = src.step_;
+		this->format_ = src.format_;
+		return *this;
+	}
+
+	template <typename T, RangeCheck R>
+	template <typename U, RangeCheck S>
+	ImageView<T, R>::ImageView(const ImageView<U, S> &src) : size(size_), step(step_),
+		format(format_), data_(src.data_), size_(src.size_), step_(src.step_),
+		format_(src.format_) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+
+	template <typename T, RangeCheck R>
+	ImageView<T, R>::ImageView(T *data, const Size3D<SizeType> &sz, ImageFormat fmt,
+		SizeType nElemPerLine) : size(size_), step(step_), format(format_), data_(data),
+		size_(sz), format_(fmt)
+	{
+		switch (fmt)
+		{
+		case ImageFormat::BIP:
+			this->step_ = ImageLayout<ImageFormat::BIP>::GetStep(sz.height, sz.depth,
+				nElemPerLine);
+			break;
+		case ImageFormat::BSQ:
+			this->step_ = ImageLayout<ImageFormat::BSQ>::GetStep(sz.height, sz.depth,
+				nElemPerLine);
+			break;
+		case ImageFormat::BIL:
+			this->step_ = ImageLayout<ImageFormat::BIL>::GetStep(sz.height, sz.depth,
+				nElemPerLine);
+			break;
+		default:
+			std::ostringstream errMsg;
+			errMsg << "Image format " << static_cast<int>(fmt) << " is not supported.";
+			throw std::logic_error(errMsg.str());
+		}
+	}
+
+	template <typename T, RangeCheck R>
+	ImageView<T, R>::ImageView(T *data, const Size3D<SizeType> &sz, ImageFormat fmt,
+		const Point3D<SizeType> &step) : size(size_), step(step_), format(format_),
+		data_(data), size_(sz), step_(step), format_(fmt) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+
+	template <typename T, RangeCheck R>
+	T &ImageView<T, R>::operator()(SizeType x, SizeType y, SizeType c) const
+	{
+		return *this->GetPointer(x, y, c);
+	}
+
+	template <typename T, RangeCheck R>
+	T *ImageView<T, R>::GetPointer(SizeType x, SizeType y, SizeType c) const
+	{
+		if (IsRangeChecked(R))
+		{
+			this->CheckRange(c);
+			this->CheckRange(x, y);
+		}
+		return this->data_ + this->GetOffset(x, y, c);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	template <typename T, RangeCheck R>
+	void ImageView<T, R>::CheckRange(SizeType c) const
+	{
+		if (c >= this->size.depth)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Channel c = " << c << " is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+	}
+
+	template <typename T, RangeCheck R>
+	void ImageView<T, R>::CheckRange(SizeType x, SizeType y) const
+	{
+		if (x >= this->size.width || y >= this->size.height)
+		{
+			std::ostringstream errMsg;
+			errMsg << "(" << x << ", " << y << ") is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+	}
+
+	template <typename T, RangeCheck R>
+	void ImageView<T, R>::CheckRange(const Point2D<SizeType> &orgn,
+		const Size2D<SizeType> &sz) const
+	{
+		Point2D<SizeType> ptEnd = orgn + sz;
+		if (ptEnd.x > this->size.width || ptEnd.y > this->size.height)
+		{
+			std::ostringstream errMsg;
+			errMsg << "[" << orgn.x << ", " << orgn.y << "] ~ (" << ptEnd.x << ", " <<
+				ptEnd.y << ") is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+	}
+
+	template <typename T, RangeCheck R>
+	ImageView<T, RangeCheck::UNCHECKED> ImageView<T, R>::CheckRange(
+		const Region<SizeType, SizeType> &roi) const
+	{
+		this->CheckRange(roi.origin, roi.size);
+		return ImageView<T, RangeCheck::UNCHECKED>(
+			this->data_ + this->GetOffset(roi.origin.x, roi.origin.y),
+			Size3D<SizeType>(roi.size.width, roi.size.height, this->size.depth),
+			this->format, this->step);
+	}
+
+	template <typename T, RangeCheck R>
+	Region<typename ImageView<T, R>::SizeType, typename ImageView<T, R>::SizeType>
+		ImageView<T, R>::GetRoi(void) const
+	{
+		return Region<SizeType, SizeType>(0, 0, this->size.width, this->size.height);
+	}
+
+	/** The origin of the ROI is relative to the origin of this view. */
+	template <typename T, RangeCheck R>
+	ImageView<T, R> ImageView<T, R>::GetView(const Region<SizeType, SizeType> &roi) const
+	{
+		return this->CheckRange(roi);
+	}
+
+	template <typename T, RangeCheck R>
+	typename ImageView<T, R>::SizeType ImageView<T, R>::GetElemPerLine(void) const
+	{
+		return this->format == ImageFormat::BIL ? this->step.z : this->step.y;
+	}
+
+	template <typename T, RangeCheck R>
+	bool ImageView<T, R>::IsContinuous(void) const
+	{
+		switch (this->format)
+		{
+		case ImageFormat::BIP:
+			return this->step.y == this->size.depth * this->size.width;
+		case ImageFormat::BSQ:
+			return this->step.y == this->size.width &&
+				this->step.z == this->size.width * this->size.height;
+		case ImageFormat::BIL:
+			return this->step.z == this->size.width &&
+				this->step.y == this->size.width * this->size.depth;
+		default:
+			return false;
+		}
+	}
+
+	template <typename T, RangeCheck R>
+	typename ImageView<T, R>::SizeType ImageView<T, R>::GetOffset(SizeType x, SizeType y,
+		SizeType c) const
+	{
+		return x * this->step.x + y * this->step.y + c * this->step.z;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Image<T, F> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T, ImageFormat F>
+	Image<T, F>::Image(void) : ImageFormatBase<F>(F), data(data_), size(size_),
+		size_(Size3D<SizeType>(0, 0, 0)), alignment_(0) {}
+
+	// A delegating constructor cannot initialize any other member, so the members are
+	// initialized directly.
+	template <typename T, ImageFormat F>
+	Image<T, F>::Image(const Image<T, F> &src) : ImageFormatBase<F>(src.format),
+		data(data_), size(size_), data_(src.data), size_(src.size),
+		alignment_(src.alignment_) {}
+
+	template <typename T, ImageFormat F>
+	Image<T, F> &Image<T, F>::operator=(const Image<T, F> &src)
+	{
+		this->data_ = src.data;
+		this->size_ = src.size;
+		this->SetFormat(src.format);
+		this->alignment_ = src.alignment_;
+		return *this;
+	}
+
+	/** The reference members are bound to the members of this object, so only the
+	container is moved. */
+	template <typename T, ImageFormat F>
+	Image<T, F>::Image(Image<T, F> &&src) IMAGING_NOEXCEPT : ImageFormatBase<F>(src.format), data(data_),
+		size(size_), data_(std::move(src.data_)), size_(src.size_), alignment_(src.alignment_)
+	{
+		src.clear();
+	}
+
+	template <typename T, ImageFormat F>
+	Image<T, F> &Image<T, F>::operator=(Image<T, F> &&src) IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->data_ = std::move(src.data_);
+			this->size_ = src.size;
+			this->SetFormat(src.format);
+			this->alignment_ = src.alignment_;
+			src.clear();
+		}
+		return *this;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	template <typename T, ImageFormat F>
+	Image<T, F>::Image(const Allocator &alloc) : ImageFormatBase<F>(F), data(data_),
+		size(size_), data_(alloc), size_(Size3D<SizeType>(0, 0, 0)), alignment_(0) {}
+
+	template <typename T, ImageFormat F>
+	Image<T, F>::Image(const Size3D<SizeType> &sz, ImageFormat fmt, ::size_t alignment,
+		const Allocator &alloc) :
+#if _MSC_VER > 1700	// from VS2013
+		Image<T, F>(alloc)
+#else				// up to VS2012
+		ImageFormatBase<F>(fmt), data(data_), size(size_), data_(alloc),
+		size_(Size3D<SizeType>(0, 0, 0)), alignment_(0)
+#endif
+	{
+		this->SetFormat(fmt);
+		this->SetAlignment(alignment);
+		this->resize(sz);
+	}
+
+	template <typename T, ImageFormat F>
+	Image<T, F>::Image(SizeType width, SizeType height, SizeType depth, ImageFormat fmt,
+		::size_t alignment, const Allocator &alloc) :
+#if _MSC_VER > 1700	// from VS2013
+		Image<T, F>(Size3D<SizeType>(width, height, depth), fmt, alignment, alloc) {}
+#else				// up to VS2012
+		ImageFormatBase<F>(fmt), data(data_), size(size_), data_(alloc),
+		size_(Size3D<SizeType>(0, 0, 0)), alignment_(0)
+	{
+		this->SetAlignment(alignment);
+		this->resize(width, height, depth);
+	}
+#endif
+
+	template <typename T, ImageFormat F>
+	template <ImageFormat G>
+	Image<T, F>::Image(const Image<T, G> &src) : ImageFormatBase<F>(src.format),
+		data(data_), size(size_), data_(src.data), size_(src.size),
+		alignment_(src.alignment_) {}
+
+	template <typename T, ImageFormat F>
+	template <ImageFormat G>
+	Image<T, F> &Image<T, F>::operator=(const Image<T, G> &src)
+	{
+		this->SetFormat(src.format);
+		this->data_ = src.data;
+		this->size_ = src.size;
+		this->alignment_ = src.alignment_;
+		return *this;
+	}
+
+	// The format is checked by the base class before image data is moved.
+	template <typename T, ImageFormat F>
+	template <ImageFormat G>
+	Image<T, F>::Image(Image<T, G> &&src) : ImageFormatBase<F>(src.format),
+		data(data_), size(size_), data_(std::move(src.data_)), size_(src.size_),
+		alignment_(src.alignment_)
+	{
+		src.clear();
+	}
+
+	template <typename T, ImageFormat F>
+	template <ImageFormat G>
+	Image<T, F> &Image<T, F>::operator=(Image<T, G> &&src)
+	{
+		this->SetFormat(src.format);
+		this->data_ = std::move(src.data_);
+		this->size_ = src.size;
+		this->alignment_ = src.alignment_;
+		src.clear();
+		return *this;
+	}
+
 	//////////////////////////////////////////////////////////////////////////
-	// Image<T> class
+	// Accessors.
+
+	// NOTE: Check the range for given position only if the method is declared as public.
+
+	template <typename T, ImageFormat F>
+	T &Image<T, F>::operator()(SizeType x, SizeType y, SizeType c)
+	{
+		return this->template At<RangeCheck::CHECKED>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	const T &Image<T, F>::operator()(SizeType x, SizeType y, SizeType c) const
+	{
+		return this->template At<RangeCheck::CHECKED>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	typename Image<T, F>::Iterator Image<T, F>::GetIterator(SizeType x, SizeType y, SizeType c)
+	{
+		return this->template GetIterator<RangeCheck::CHECKED>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	typename Image<T, F>::ConstIterator Image<T, F>::GetIterator(SizeType x, SizeType y, SizeType c) const
+	{
+		return this->template GetIterator<RangeCheck::CHECKED>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	T *Image<T, F>::GetPointer(SizeType x, SizeType y, SizeType c)
+	{
+		return this->template GetPointer<RangeCheck::CHECKED>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	const T *Image<T, F>::GetPointer(SizeType x, SizeType y, SizeType c) const
+	{
+		return this->template GetPointer<RangeCheck::CHECKED>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	template <RangeCheck R>
+	T &Image<T, F>::At(SizeType x, SizeType y, SizeType c)
+	{
+		return *this->template GetPointer<R>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	template <RangeCheck R>
+	const T &Image<T, F>::At(SizeType x, SizeType y, SizeType c) const
+	{
+		return *this->template GetPointer<R>(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	template <RangeCheck R>
+	typename Image<T, F>::Iterator Image<T, F>::GetIterator(SizeType x, SizeType y,
+		SizeType c)
+	{
+		if (IsRangeChecked(R))
+		{
+			this->CheckRange(c);
+			this->CheckRange(x, y);
+		}
+		return this->data_.begin() + this->GetOffset(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	template <RangeCheck R>
+	typename Image<T, F>::ConstIterator Image<T, F>::GetIterator(SizeType x, SizeType y,
+		SizeType c) const
+	{
+		if (IsRangeChecked(R))
+		{
+			this->CheckRange(c);
+			this->CheckRange(x, y);
+		}
+		return this->data.cbegin() + this->GetOffset(x, y, c);
+	}
+
+	// The pointer is computed from the data pointer instead of the iterator, so that it is
+	// not checked by checked iterators of debug builds either.
+	template <typename T, ImageFormat F>
+	template <RangeCheck R>
+	T *Image<T, F>::GetPointer(SizeType x, SizeType y, SizeType c)
+	{
+		if (IsRangeChecked(R))
+		{
+			this->CheckRange(c);
+			this->CheckRange(x, y);
+		}
+		return this->data_.data() + this->GetOffset(x, y, c);
+	}
+
+	template <typename T, ImageFormat F>
+	template <RangeCheck R>
+	const T *Image<T, F>::GetPointer(SizeType x, SizeType y, SizeType c) const
+	{
+		if (IsRangeChecked(R))
+		{
+			this->CheckRange(c);
+			this->CheckRange(x, y);
+		}
+		return this->data.data() + this->GetOffset(x, y, c);
+	}
+
+	/** A view of an empty image has a size of zero. An empty image of no format, e.g., an
+	image constructed by default, gives a view of zero steps instead of throwing. */
+	template <typename T, ImageFormat F>
+	ImageView<T> Image<T, F>::GetView(void)
+	{
+		if (this->format == ImageFormat::UNKNOWN &&
+			this->size.width * this->size.height * this->size.depth == 0)
+			return ImageView<T>(this->data_.data(), this->size, this->format,
+				Point3D<SizeType>(0, 0, 0));
+		return ImageView<T>(this->data_.data(), this->size, this->format,
+			this->GetElemPerLine());
+	}
+
+	template <typename T, ImageFormat F>
+	ImageView<const T> Image<T, F>::GetView(void) const
+	{
+		if (this->format == ImageFormat::UNKNOWN &&
+			this->size.width * this->size.height * this->size.depth == 0)
+			return ImageView<const T>(this->data.data(), this->size, this->format,
+				Point3D<SizeType>(0, 0, 0));
+		return ImageView<const T>(this->data.data(), this->size, this->format,
+			this->GetElemPerLine());
+	}
+
+	template <typename T, ImageFormat F>
+	ImageView<T> Image<T, F>::GetView(const Region<SizeType, SizeType> &roi)
+	{
+		return this->GetView().GetView(roi);
+	}
+
+	template <typename T, ImageFormat F>
+	ImageView<const T> Image<T, F>::GetView(const Region<SizeType, SizeType> &roi) const
+	{
+		return this->GetView().GetView(roi);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	template <typename T, ImageFormat F>
+	void Image<T, F>::CheckDepth(SizeType c) const
+	{
+		if (this->size.depth != c)
+			throw std::runtime_error("Depth is not matched.");
+	}
+
+	/** Throws an exception instead of returning false because you have to throw an
+	exception at a higher level any way. */
+	template <typename T, ImageFormat F>
+	void Image<T, F>::CheckRange(SizeType c) const
+	{
+		if (c >= this->size.depth)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Channel c = " << c << " is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+	}
+
+	template <typename T, ImageFormat F>
+	void Image<T, F>::CheckRange(SizeType x, SizeType y) const
+	{
+		if (x < 0 || x >= this->size.width || y < 0 || y >= this->size.height)
+		{
+			std::ostringstream errMsg;
+			errMsg << "(" << x << ", " << y << ") is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+	}
+
+	template <typename T, ImageFormat F>
+	void Image<T, F>::CheckRange(const Point2D<SizeType> &pt) const
+	{
+		this->CheckRange(pt.x, pt.y);
+	}
+
+	// The end points are the excluding end of an ROI, so it could be up to (width, height).
+	template <typename T, ImageFormat F>
+	void Image<T, F>::CheckRange(const Point2D<SizeType> &orgn, const Size2D<SizeType> &sz) const
+	{
+		Point2D<SizeType> ptEnd = orgn + sz;
+		if (orgn.x < 0 || ptEnd.x > this->size.width || orgn.y < 0 ||
+			ptEnd.y > this->size.height)
+		{
+			std::ostringstream errMsg;
+			errMsg << "[" << orgn.x << ", " << orgn.y << "] ~ (" << ptEnd.x << ", " <<
+				ptEnd.y << ") is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+	}
+
+	template <typename T, ImageFormat F>
+	ImageView<T, RangeCheck::UNCHECKED> Image<T, F>::CheckRange(
+		const Region<SizeType, SizeType> &roi)
+	{
+		return this->GetView().CheckRange(roi);
+	}
+
+	template <typename T, ImageFormat F>
+	ImageView<const T, RangeCheck::UNCHECKED> Image<T, F>::CheckRange(
+		const Region<SizeType, SizeType> &roi) const
+	{
+		return this->GetView().CheckRange(roi);
+	}
+
+	template <typename T, ImageFormat F>
+	Region<typename Image<T, F>::SizeType, typename Image<T, F>::SizeType>
+		Image<T, F>::GetRoi(void) const
+	{
+		return Region<typename Image<T, F>::SizeType, typename Image<T, F>::SizeType>(0, 0,
+			this->size.width, this->size.height);
+	}
+
+	template <typename T, ImageFormat F>
+	void Image<T, F>::clear(void)
+	{
+		this->data_.clear();
+		this->size_ = Size3D<SizeType>(0, 0, 0);
+	}
+
+	template <typename T, ImageFormat F>
+	void Image<T, F>::swap(Image<T, F> &rhs) IMAGING_NOEXCEPT
+	{
+		const ImageFormat fmt = this->format;
+		this->SetFormat(rhs.format);
+		rhs.SetFormat(fmt);
+		this->data_.swap(rhs.data_);
+		std::swap(this->size_, rhs.size_);
+		std::swap(this->alignment_, rhs.alignment_);
+	}
+
+	/** If F is not ImageFormat::UNKNOWN, this->format is a compile-time constant, so the
+	switch statement is resolved by the compiler. */
+	template <typename T, ImageFormat F>
+	typename Image<T, F>::SizeType Image<T, F>::GetOffset(SizeType x, SizeType y,
+		SizeType c) const
+	{
+		switch (this->format)
+		{
+		case ImageFormat::BIP:
+			return ImageLayout<ImageFormat::BIP>::GetOffset(x, y, c, this->size.height,
+				this->size.depth, this->GetElemPerLine(
+				ImageLayout<ImageFormat::BIP>::GetElemWidth(this->size.width, this->size.depth)));
+		case ImageFormat::BSQ:
+			return ImageLayout<ImageFormat::BSQ>::GetOffset(x, y, c, this->size.height,
+				this->size.depth, this->GetElemPerLine(this->size.width));
+		case ImageFormat::BIL:
+			return ImageLayout<ImageFormat::BIL>::GetOffset(x, y, c, this->size.height,
+				this->size.depth, this->GetElemPerLine(this->size.width));
+		default:
+			std::ostringstream errMsg;
+			errMsg << "Image format " << static_cast<int>(this->format) <<
+				" is not supported.";
+			throw std::logic_error(errMsg.str());
+		}
+	}
+
+	template <typename T, ImageFormat F>
+	typename Image<T, F>::SizeType Image<T, F>::GetElemWidth(void) const
+	{
+		switch (this->format)
+		{
+		case ImageFormat::BIP:
+			return ImageLayout<ImageFormat::BIP>::GetElemWidth(this->size.width,
+				this->size.depth);
+		case ImageFormat::BSQ:
+			return ImageLayout<ImageFormat::BSQ>::GetElemWidth(this->size.width,
+				this->size.depth);
+		case ImageFormat::BIL:
+			return ImageLayout<ImageFormat::BIL>::GetElemWidth(this->size.width,
+				this->size.depth);
+		default:
+			std::ostringstream errMsg;
+			errMsg << "Image format " << static_cast<int>(this->format) <<
+				" is not supported.";
+			throw std::logic_error(errMsg.str());
+		}
+	}
+
+	template <typename T, ImageFormat F>
+	typename Image<T, F>::SizeType Image<T, F>::GetElemPerLine(SizeType nElemWidth) const
+	{
+		if (this->alignment_ == 0)
+			return nElemWidth;
+		else
+			return RoundUp<SizeType>(nElemWidth, this->alignment_ / sizeof(T));
+	}
+
+	template <typename T, ImageFormat F>
+	typename Image<T, F>::SizeType Image<T, F>::GetElemPerLine(void) const
+	{
+		return this->GetElemPerLine(this->GetElemWidth());
+	}
+
+	template <typename T, ImageFormat F>
+	::size_t Image<T, F>::GetBytesPerLine(void) const
+	{
+		return this->GetElemPerLine() * sizeof(T);
+	}
+
+	template <typename T, ImageFormat F>
+	bool Image<T, F>::IsContinuous(void) const
+	{
+		SizeType nElemWidth = this->GetElemWidth();
+		return this->GetElemPerLine(nElemWidth) == nElemWidth;
+	}
+
+	template <typename T, ImageFormat F>
+	typename Image<T, F>::Allocator Image<T, F>::GetAllocator(void) const
+	{
+		return this->data.get_allocator();
+	}
+
+	template <typename T, ImageFormat F>
+	::size_t Image<T, F>::GetAlignment(void) const
+	{
+		return this->alignment_;
+	}
+
+	template <typename T, ImageFormat F>
+	void Image<T, F>::SetAlignment(::size_t alignment)
+	{
+		if (alignment % sizeof(T) != 0)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Alignment " << alignment << " is not a multiple of " << sizeof(T) <<
+				" bytes.";
+			throw std::invalid_argument(errMsg.str());
+		}
+		this->alignment_ = alignment;
+		this->resize(this->size);
+	}
+
+	/** Resizes the std::vector<T> object only if necessary.
+	If size is changed while the total number of elements are the same (reshaping),
+	it does NOT run resize() function of the std::vector<T>.
+	If there are padding elements, the number of elements is the larger one between
+	the BIP lines and the BSQ/BIL lines, so any image format fits in the memory.
+	The allocator leaves new elements uninitialized, so they are zero-filled here unless
+	ResizeMode::UNINITIALIZED is given. */
+	template <typename T, ImageFormat F>
+	void Image<T, F>::resize(const Size3D<SizeType> &sz, ResizeMode mode)
+	{
+		SizeType nElem = sz.width * sz.height * sz.depth;
+		if (this->alignment_ != 0)
+			nElem = std::max(this->GetElemPerLine(sz.depth * sz.width) * sz.height,
+				this->GetElemPerLine(sz.width) * sz.height * sz.depth);
+		if (this->data.size() != nElem)
+		{
+			const SizeType nElemOld = this->data.size();
+			this->data_.resize(nElem);
+			if (mode == ResizeMode::ZERO_FILLED && nElem > nElemOld)
+				std::fill(this->data_.begin() + nElemOld, this->data_.end(), T());
+		}
+		this->size_ = sz;
+	}
+
+	template <typename T, ImageFormat F>
+	void Image<T, F>::resize(SizeType width, SizeType height, SizeType depth,
+		ResizeMode mode)
+	{
+		this->resize(Size3D<SizeType>(width, height, depth), mode);
+	}
+
+	/** The lines are packed at the beginning of the memory first, and are spread again for
+	the new format at the end, so the permutation works on the continuous elements.
+	BIP <-> BIL transposes each row through a buffer of the row, and BIL <-> BSQ transposes
+	the lines by TransposeInPlace(). BIP <-> BSQ goes through BIL.
+	Every buffer is allocated before any element is moved, and the format is changed at
+	the end, so the image is left unchanged if an allocation throws. The memory fits both
+	formats if it is sized by resize(); otherwise it is enlarged to fit both first, which
+	holds the old and the new memory at once, so the new memory is counted as extra. */
+	template <typename T, ImageFormat F>
+	::size_t Image<T, F>::ConvertFormat(ImageFormat fmt)
+	{
+		const ImageFormat fmtOld = this->format;
+		const ImageFormat fmts[] = {fmtOld, fmt};
+		for (int N = 0; N != 2; ++N)
+		{
+			if (fmts[N] != ImageFormat::BIP && fmts[N] != ImageFormat::BSQ &&
+				fmts[N] != ImageFormat::BIL)
+			{
+				std::ostringstream errMsg;
+				errMsg << "Image format " << static_cast<int>(fmts[N]) << " is not supported.";
+				throw std::logic_error(errMsg.str());
+			}
+		}
+		if (fmt == fmtOld)
+			return 0;
+		// An image of a fixed format is never converted, which throws here.
+		if (F != ImageFormat::UNKNOWN)
+			this->SetFormat(fmt);
+
+		const SizeType width = this->size.width;
+		const SizeType height = this->size.height;
+		const SizeType depth = this->size.depth;
+		const SizeType nElemWidthOld = fmtOld == ImageFormat::BIP ? width * depth : width;
+		const SizeType nLinesOld = fmtOld == ImageFormat::BIP ? height : height * depth;
+		const SizeType nElemPerLineOld = this->GetElemPerLine(nElemWidthOld);
+		const SizeType nElemWidthNew = fmt == ImageFormat::BIP ? width * depth : width;
+		const SizeType nLinesNew = fmt == ImageFormat::BIP ? height : height * depth;
+		const SizeType nElemPerLineNew = this->GetElemPerLine(nElemWidthNew);
+
+		// Allocate the buffers of the permutation.
+		const bool isBilBsq = fmtOld == ImageFormat::BSQ || fmt == ImageFormat::BSQ;
+		const bool isBipBil = fmtOld == ImageFormat::BIP || fmt == ImageFormat::BIP;
+		std::vector<bool> isMoved(isBilBsq ? height * depth : 0);
+		std::vector<T> block(isBilBsq ? width : 0);
+		std::vector<T> row(isBipBil ? width * depth : 0);
+		::size_t nBytesExtra = (isMoved.size() + 7) / 8 +
+			(block.size() + row.size()) * sizeof(T);
+		const SizeType nElem = std::max(nElemPerLineOld * nLinesOld,
+			nElemPerLineNew * nLinesNew);
+		if (this->data_.size() < nElem)
+		{
+			this->data_.resize(nElem);
+			nBytesExtra += nElem * sizeof(T);
+		}
+		T *data = this->data_.data();
+
+		// Pack lines.
+		if (nElemPerLineOld != nElemWidthOld)
+			for (SizeType L = 1; L < nLinesOld; ++L)
+				std::copy(data + L * nElemPerLineOld, data + L * nElemPerLineOld + nElemWidthOld,
+				data + L * nElemWidthOld);
+
+		// Permute packed elements.
+		if (fmtOld == ImageFormat::BSQ)
+			TransposeInPlace(data, depth, height, width, isMoved, block.data());
+		if (isBipBil)
+		{
+			for (SizeType H = 0; H != height; ++H)
+			{
+				T *p = data + H * width * depth;
+				std::copy(p, p + row.size(), row.begin());
+				if (fmtOld == ImageFormat::BIP)
+					CopyTiles(row.data(), depth, 1, p, 1, width, width, depth);
+				else
+					CopyTiles(row.data(), 1, width, p, depth, 1, width, depth);
+			}
+		}
+		if (fmt == ImageFormat::BSQ)
+			TransposeInPlace(data, height, depth, width, isMoved, block.data());
+
+		// Spread lines, and zero padding elements.
+		if (nElemPerLineNew != nElemWidthNew)
+		{
+			for (SizeType L = nLinesNew; L-- > 0;)
+			{
+				T *p = data + L * nElemPerLineNew;
+				std::copy_backward(data + L * nElemWidthNew, data + (L + 1) * nElemWidthNew,
+					p + nElemWidthNew);
+				std::fill(p + nElemWidthNew, p + nElemPerLineNew, T());
+			}
+		}
+		this->SetFormat(fmt);
+		return nBytesExtra;
+	}
+
+	template <typename T, ImageFormat F>
+	void swap(Image<T, F> &a, Image<T, F> &b)
+	{
+		a.swap(b);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ImageRaw class
+
+	/** The switch is the only place where a data type is mapped to a C++ type. */
+	template <typename Visitor>
+	auto VisitDataType(ImageDataType type, Visitor &&visitor) ->
+		decltype(visitor(static_cast<std::uint8_t *>(nullptr)))
+	{
+		switch (type)
+		{
+		case ImageDataType::UINT8:
+			return visitor(static_cast<std::uint8_t *>(nullptr));
+		case ImageDataType::INT8:
+			return visitor(static_cast<std::int8_t *>(nullptr));
+		case ImageDataType::UINT16:
+			return visitor(static_cast<std::uint16_t *>(nullptr));
+		case ImageDataType::INT16:
+			return visitor(static_cast<std::int16_t *>(nullptr));
+		case ImageDataType::UINT32:
+			return visitor(static_cast<std::uint32_t *>(nullptr));
+		case ImageDataType::INT32:
+			return visitor(static_cast<std::int32_t *>(nullptr));
+		case ImageDataType::UINT64:
+			return visitor(static_cast<std::uint64_t *>(nullptr));
+		case ImageDataType::INT64:
+			return visitor(static_cast<std::int64_t *>(nullptr));
+		case ImageDataType::FLOAT32:
+			return visitor(static_cast<float *>(nullptr));
+		case ImageDataType::FLOAT64:
+			return visitor(static_cast<double *>(nullptr));
+		default:
+			std::ostringstream errMsg;
+			errMsg << "Data type " << static_cast<int>(type) << " is not supported.";
+			throw std::logic_error(errMsg.str());
+		}
+	}
+
+	template <typename Visitor, typename Raw>
+	struct ImageRaw::ViewVisitor
+	{
+		// const T for a const image.
+		template <typename T>
+		struct View
+		{
+			typedef ImageView<typename std::conditional<std::is_const<Raw>::value, const T,
+				T>::type> Type;
+		};
+
+		template <typename T>
+		auto operator()(T *) -> decltype(std::declval<Visitor &>()(typename View<T>::Type()))
+		{
+			typedef typename View<T>::Type ViewType;
+			Image<T> *image = raw.template GetImage<T>();
+			return visitor(image != nullptr ? ViewType(image->GetView()) : ViewType());
+		}
+
+		Visitor &visitor;
+		Raw &raw;
+	};
+
+	template <typename Visitor>
+	struct ImageRaw::ImageVisitor
+	{
+		template <typename T>
+		void operator()(T *)
+		{
+			Image<T> *image = raw.GetImage<T>();
+			if (image == nullptr)
+			{
+				image = new Image<T>(Size3D<SizeType>(0, 0, 0), raw.format_);
+				raw.image_ = std::unique_ptr<void, void (*)(void *)>(image,
+					&ImageRaw::DeleteImage<T>);
+			}
+			visitor(*image);
+			raw.size_ = image->size;
+			raw.format_ = image->format;
+		}
+
+		Visitor &visitor;
+		ImageRaw &raw;
+	};
+
+	struct ImageRaw::Copier
+	{
+		template <typename T>
+		void operator()(Image<T> &image) const
+		{
+			image = *src.GetImage<T>();
+		}
+
+		const ImageRaw &src;
+	};
+
+	struct ImageRaw::Resizer
+	{
+		template <typename T>
+		void operator()(Image<T> &image) const
+		{
+			image.resize(sz, mode);
+		}
+
+		const Size3D<SizeType> &sz;
+		ResizeMode mode;
+	};
+
+	struct ImageRaw::Converter
+	{
+		template <typename T>
+		void operator()(Image<T> &image)
+		{
+			nBytes = image.ConvertFormat(fmt);
+		}
+
+		ImageFormat fmt;
+		::size_t nBytes;
+	};
+
+	struct ImageRaw::Creator
+	{
+		template <typename T>
+		void operator()(Image<T> &image) const
+		{
+			image = Image<T>(sz, fmt, alignment);
+		}
+
+		const Size3D<SizeType> &sz;
+		ImageFormat fmt;
+		::size_t alignment;
+	};
 
 	//////////////////////////////////////////////////////////////////////////
 	// Default constructors.
-	template <typename T>
-	Image<T>::Image(void) : data(data_), size(size_),
-		size_(Size3D<SizeType>(0, 0, 0)), format(ImageFormat::UNKNOWN) {}
+	inline ImageRaw::ImageRaw(void) : size(size_), format(format_), datatype(datatype_),
+		image_(nullptr, &ImageRaw::DeleteImage<std::uint8_t>), size_(0, 0, 0),
+		format_(ImageFormat::BIP), datatype_(ImageDataType::UINT8) {}
 
-	template <typename T>
-	Image<T>::Image(const Image<T> &src) :
-#if _MSC_VER > 1700	// from VS2013
-		Image<T>(),
-#else				// up to VS2012
-		data(data_), size(size_),
-#endif
-		data_(src.data) { size_ = src.size; format = src.format; }
+	inline ImageRaw::ImageRaw(const ImageRaw &src) : size(size_), format(format_),
+		datatype(datatype_), image_(nullptr, src.image_.get_deleter()), size_(0, 0, 0),
+		format_(src.format_), datatype_(src.datatype_)
+	{
+		if (src.image_)
+		{
+			Copier copier = {src};
+			this->VisitImage(copier);
+		}
+	}
 
-	template <typename T>
-	Image<T> &Image<T>::operator=(const Image<T> &src)
+	inline ImageRaw &ImageRaw::operator=(const ImageRaw &src)
 	{
-		this->data_ = src.data;
-		this->size_ = src.size;
-		this->format = src.format;
+		if (this != &src)
+			*this = ImageRaw(src);
+		return *this;
+	}
+
+	inline ImageRaw::ImageRaw(ImageRaw &&src) IMAGING_NOEXCEPT : size(size_),
+		format(format_), datatype(datatype_), image_(std::move(src.image_)),
+		size_(src.size_), format_(src.format_), datatype_(src.datatype_)
+	{
+		src.size_ = Size3D<SizeType>(0, 0, 0);
+	}
+
+	inline ImageRaw &ImageRaw::operator=(ImageRaw &&src) IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->image_ = std::move(src.image_);
+			this->size_ = src.size_;
+			this->format_ = src.format_;
+			this->datatype_ = src.datatype_;
+			src.size_ = Size3D<SizeType>(0, 0, 0);
+		}
 		return *this;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	// Custom constructors.
-	template <typename T>
-	Image<T>::Image(const Size3D<SizeType> &sz, ImageFormat fmt) :
-#if _MSC_VER > 1700	// from VS2013
-		Image<T>()
-#else				// up to VS2012
-		data(data_), size(size_)
-#endif
+	inline ImageRaw::ImageRaw(ImageDataType type, const Size3D<SizeType> &sz,
+		ImageFormat fmt, ::size_t alignment) : size(size_), format(format_),
+		datatype(datatype_), image_(nullptr, &ImageRaw::DeleteImage<std::uint8_t>),
+		size_(0, 0, 0), format_(fmt), datatype_(type)
 	{
-		this->resize(sz);
-		this->format = fmt;
+		Creator creator = {sz, fmt, alignment};
+		this->VisitImage(creator);
 	}
 
 	template <typename T>
-	Image<T>::Image(SizeType width, SizeType height, SizeType depth, ImageFormat fmt) :
-#if _MSC_VER > 1700	// from VS2013
-		Image<T>(Size3D<SizeType>(width, height, depth), fmt) {}
-#else				// up to VS2012
-		data(data_), size(size_)
+	ImageRaw::ImageRaw(Image<T> &&img) : size(size_), format(format_),
+		datatype(datatype_), image_(new Image<T>(std::move(img)), &ImageRaw::DeleteImage<T>),
+		size_(0, 0, 0), format_(ImageFormat::BIP), datatype_(DataTypeOf<T>::value)
 	{
-		this->resize(width, height, depth);
-		this->format = fmt;
+		this->size_ = this->GetImage<T>()->size;
+		this->format_ = this->GetImage<T>()->format;
 	}
-#endif
 
 	//////////////////////////////////////////////////////////////////////////
 	// Accessors.
-
-	// NOTE: Check the range for given position only if the method is declared as public.
-
 	template <typename T>
-	T &Image<T>::operator()(SizeType x, SizeType y, SizeType c)
+	T &ImageRaw::operator()(SizeType x, SizeType y, SizeType c)
 	{
-		this->CheckRange(c);
-		this->CheckRange(x, y);
-		return this->data_.at(this->GetOffset(x, y, c));
+		return *this->GetPointer<T>(x, y, c);
 	}
 
 	template <typename T>
-	const T &Image<T>::operator()(SizeType x, SizeType y, SizeType c) const
+	const T &ImageRaw::operator()(SizeType x, SizeType y, SizeType c) const
 	{
-		this->CheckRange(c);
-		this->CheckRange(x, y);
-		return this->data.at(this->GetOffset(x, y, c));
+		return *this->GetPointer<T>(x, y, c);
 	}
 
 	template <typename T>
-	typename Image<T>::Iterator Image<T>::GetIterator(SizeType x, SizeType y, SizeType c)
+	T *ImageRaw::GetPointer(SizeType x, SizeType y, SizeType c)
 	{
-		this->CheckRange(c);
-		this->CheckRange(x, y);
-		return this->data_.begin() + this->GetOffset(x, y, c);
+		return this->GetView<T>().GetPointer(x, y, c);
 	}
 
 	template <typename T>
-	typename Image<T>::ConstIterator Image<T>::GetIterator(SizeType x, SizeType y, SizeType c) const
+	const T *ImageRaw::GetPointer(SizeType x, SizeType y, SizeType c) const
 	{
-		this->CheckRange(c);
-		this->CheckRange(x, y);
-		return this->data.cbegin() + this->GetOffset(x, y, c);
+		return this->GetView<T>().GetPointer(x, y, c);
 	}
 
 	template <typename T>
-	T *Image<T>::GetPointer(SizeType x, SizeType y, SizeType c)
+	ImageView<T> ImageRaw::GetView(void)
 	{
-		auto it = this->GetIterator(x, y, c);
-		return &(*it);
+		Image<T> *image = this->GetImage<T>();
+		return image != nullptr ? image->GetView() : ImageView<T>();
 	}
 
 	template <typename T>
-	const T *Image<T>::GetPointer(SizeType x, SizeType y, SizeType c) const
+	ImageView<const T> ImageRaw::GetView(void) const
 	{
-		auto it = this->GetIterator(x, y, c);
-		return &(*it);
+		const Image<T> *image = this->GetImage<T>();
+		return image != nullptr ? image->GetView() : ImageView<const T>();
 	}
 
-	//////////////////////////////////////////////////////////////////////////
-	// Methods.
-
 	template <typename T>
-	void Image<T>::CheckDepth(SizeType c) const
+	ImageView<T> ImageRaw::GetView(const Region<SizeType, SizeType> &roi)
 	{
-		if (this->size.depth != c)
-			throw std::runtime_error("Depth is not matched.");
+		this->CheckRange(roi);
+		return this->GetView<T>().GetView(roi);
 	}
 
-	/** Throws an exception instead of returning false because you have to throw an
-	exception at a higher level any way. */
 	template <typename T>
-	void Image<T>::CheckRange(SizeType c) const
+	ImageView<const T> ImageRaw::GetView(const Region<SizeType, SizeType> &roi) const
+	{
+		this->CheckRange(roi);
+		return this->GetView<T>().GetView(roi);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+	inline void ImageRaw::CheckRange(SizeType c) const
 	{
 		if (c >= this->size.depth)
 		{
 			std::ostringstream errMsg;
-			errMsg << "Channel c = " << c << " is out of range.";
+			errMsg << "Channel " << c << " is out of range.";
 			throw std::out_of_range(errMsg.str());
 		}
 	}
 
-	template <typename T>
-	void Image<T>::CheckRange(SizeType x, SizeType y) const
+	inline void ImageRaw::CheckRange(SizeType x, SizeType y) const
 	{
-		if (x < 0 || x >= this->size.width || y < 0 || y >= this->size.height)
+		if (x >= this->size.width || y >= this->size.height)
 		{
 			std::ostringstream errMsg;
 			errMsg << "(" << x << ", " << y << ") is out of range.";
@@ -141,90 +1173,124 @@ namespace Imaging
 		}
 	}
 
-	template <typename T>
-	void Image<T>::CheckRange(const Point2D<SizeType> &pt) const
-	{
-		this->CheckRange(pt.x, pt.y);
-	}
-
-	// The end points are the excluding end of an ROI, so it could be up to (width, height).
-	template <typename T>
-	void Image<T>::CheckRange(const Point2D<SizeType> &orgn, const Size2D<SizeType> &sz) const
+	inline void ImageRaw::CheckRange(const Region<SizeType, SizeType> &roi) const
 	{
-		Point2D<SizeType> ptEnd = orgn + sz;
-		if (orgn.x < 0 || ptEnd.x > this->size.width || orgn.y < 0 ||
-			ptEnd.y > this->size.height)
+		if (roi.origin.x + roi.size.width > this->size.width ||
+			roi.origin.y + roi.size.height > this->size.height)
 		{
 			std::ostringstream errMsg;
-			errMsg << "[" << orgn.x << ", " << orgn.y << "] ~ (" << ptEnd.x << ", " <<
-				ptEnd.y << ") is out of range.";
+			errMsg << "[" << roi.origin.x << ", " << roi.origin.y << "] ~ (" <<
+				roi.origin.x + roi.size.width << ", " << roi.origin.y + roi.size.height <<
+				") is out of range.";
 			throw std::out_of_range(errMsg.str());
 		}
 	}
 
-	template <typename T>
-	void Image<T>::CheckRange(const Region<SizeType, SizeType> &roi) const
+	/** The Image<T> object is released, so the line alignment is reset. */
+	inline void ImageRaw::Clear(void)
 	{
-		this->CheckRange(roi.origin, roi.size);
+		this->image_.reset();
+		this->size_ = Size3D<SizeType>(0, 0, 0);
+	}
+
+	inline Region<ImageRaw::SizeType, ImageRaw::SizeType> ImageRaw::GetRoi(void) const
+	{
+		return Region<SizeType, SizeType>(0, 0, this->size.width, this->size.height);
+	}
+
+	inline void ImageRaw::Resize(const Size3D<SizeType> &sz, ResizeMode mode)
+	{
+		Resizer resizer = {sz, mode};
+		this->VisitImage(resizer);
+	}
+
+	inline void ImageRaw::Resize(SizeType width, SizeType height, SizeType depth,
+		ResizeMode mode)
+	{
+		this->Resize(Size3D<SizeType>(width, height, depth), mode);
+	}
+
+	inline ::size_t ImageRaw::ConvertFormat(ImageFormat fmt)
+	{
+		Converter converter = {fmt, 0};
+		this->VisitImage(converter);
+		return converter.nBytes;
+	}
+
+	inline ::size_t ImageRaw::GetBytesPerCh(void) const
+	{
+		return GetElemSize(this->datatype);
 	}
 
 	template <typename T>
-	Region<typename Image<T>::SizeType, typename Image<T>::SizeType>
-		Image<T>::GetRoi(void) const
+	bool ImageRaw::IsDataType(void) const
 	{
-		return Region<Image<T>::SizeType, typename Image<T>::SizeType>(0, 0, this->size.width,
-			this->size.height);
+		return this->datatype == DataTypeOf<T>::value;
 	}
 
 	template <typename T>
-	void Image<T>::clear(void)
+	Image<T> ImageRaw::Release(void)
 	{
-		this->data_.clear();
-		this->size_ = Size3D<SizeType>(0, 0, 0);
+		Image<T> img;
+		Image<T> *image = this->GetImage<T>();
+		if (image != nullptr)
+			img = std::move(*image);
+		else
+			img.SetFormat(this->format);
+		this->Clear();
+		return img;
+	}
+
+	template <typename Visitor>
+	auto ImageRaw::Visit(Visitor &&visitor) -> decltype(visitor(ImageView<std::uint8_t>()))
+	{
+		ViewVisitor<Visitor, ImageRaw> viewVisitor = {visitor, *this};
+		return VisitDataType(this->datatype, viewVisitor);
+	}
+
+	template <typename Visitor>
+	auto ImageRaw::Visit(Visitor &&visitor) const ->
+		decltype(visitor(ImageView<const std::uint8_t>()))
+	{
+		ViewVisitor<Visitor, const ImageRaw> viewVisitor = {visitor, *this};
+		return VisitDataType(this->datatype, viewVisitor);
 	}
 
 	template <typename T>
-	typename Image<T>::SizeType Image<T>::GetOffset(SizeType x, SizeType y, SizeType c) const
+	Image<T> *ImageRaw::GetImage(void) const
 	{
-		switch (this->format)
+		if (!this->IsDataType<T>())
 		{
-		case ImageFormat::BIP:
-			return c + this->size.depth * x + this->size.depth * this->size.width * y;
-		case ImageFormat::BSQ:
-			return x + this->size.width * y + this->size.width * this->size.height * c;
-		case ImageFormat::BIL:
-			return x + this->size.width * c + this->size.width * this->size.depth * y;
-		default:
 			std::ostringstream errMsg;
-			errMsg << "Image format " << static_cast<int>(this->format) <<
-				" is not supported.";
+			errMsg << "Data type " << static_cast<int>(DataTypeOf<T>::value) <<
+				" is not matched with " << static_cast<int>(this->datatype) << ".";
 			throw std::logic_error(errMsg.str());
 		}
+		return static_cast<Image<T> *>(this->image_.get());
 	}
 
-	/** Resizes the std::vector<T> object only if necessary.
-	If size is changed while the total number of elements are the same (reshaping),
-	it does NOT run resize() function of the std::vector<T>. */
-	template <typename T>
-	void Image<T>::resize(const Size3D<SizeType> &sz)
+	template <typename Visitor>
+	void ImageRaw::VisitImage(Visitor &&visitor)
 	{
-		SizeType nElem = sz.width * sz.height * sz.depth;
-		if (this->data.size() != nElem)
-			this->data_.resize(nElem);
-		this->size_ = sz;
+		ImageVisitor<Visitor> imageVisitor = {visitor, *this};
+		VisitDataType(this->datatype, imageVisitor);
 	}
 
 	template <typename T>
-	void Image<T>::resize(SizeType width, SizeType height, SizeType depth)
+	void ImageRaw::DeleteImage(void *image)
 	{
-		this->resize(Size3D<SizeType>(width, height, depth));
+		delete static_cast<Image<T> *>(image);
 	}
 
 
-	template <typename T>
-	void Copy(const Image<T> &imgSrc,
+
+
+	/** Copies image data through views, so the lines are copied by a single logic for
+	any image format. */
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
-		Image<T> &imgDst, const Point2D<typename Image<T>::SizeType> &orgnDst)
+		Image<T, F> &imgDst, const Point2D<typename Image<T>::SizeType> &orgnDst)
 	{
 		// Check image format.
 		if (imgSrc.format != imgDst.format)
@@ -233,99 +1299,23 @@ namespace Imaging
 
 		// Check the depth of both images.
 		imgSrc.CheckDepth(imgDst.size.depth);
-		const auto depth = imgSrc.size.depth;	// common for both src/dst.
 
 		// Check source/destination ROI.
-		imgSrc.CheckRange(roiSrc);
-		imgDst.CheckRange(orgnDst, roiSrc.size);
-
-		// Copy line by line.
-		switch (imgSrc.format)
-		{
-		case ImageFormat::BIP:
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y);
-				auto it_dst = imgDst.GetIterator(orgnDst.x, orgnDst.y);
-				CopyLines<T>(it_src, depth * imgSrc.size.width, it_dst,
-					depth * imgDst.size.width, depth * roiSrc.size.width, roiSrc.size.height);
-			}
-			break;
-		case ImageFormat::BSQ:
-			for (auto C = 0; C != imgSrc.size.depth; ++C)
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y, C);
-				auto it_dst = imgDst.GetIterator(orgnDst.x, orgnDst.y, C);
-				CopyLines<T>(it_src, imgSrc.size.width, it_dst, imgDst.size.width,
-					roiSrc.size.width, roiSrc.size.height);
-			}
-			break;
-		case ImageFormat::BIL:
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y);
-				auto it_dst = imgDst.GetIterator(orgnDst.x, orgnDst.y);
-				CopyLines<T>(it_src, imgSrc.size.width, it_dst, imgDst.size.width,
-					roiSrc.size.width,  depth * roiSrc.size.height);
-			}
-			break;
-		default:
-			std::ostringstream errMsg;
-			errMsg << "Image format " << static_cast<int>(imgSrc.format) <<
-				" is not supported.";
-			throw std::logic_error(errMsg.str());
-		}
+		Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roiDst(orgnDst,
+			roiSrc.size);
+		Copy(imgSrc.GetView(roiSrc), imgDst.GetView(roiDst));
 	}
 
-	template <typename T>
-	void Copy(const Image<T> &imgSrc,
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
-		Image<T> &imgDst)
+		Image<T, F> &imgDst)
 	{
-		// Reset destination image for given dimension.
-		Size3D<typename Image<T>::SizeType> szDst(roiSrc.size.width, roiSrc.size.height, imgSrc.size.depth);
-		imgDst.resize(szDst);
-		imgDst.format = imgSrc.format;
-		const auto depth = imgSrc.size.depth;	// common for both src/dst.
-		const auto size = roiSrc.size;			// common for both roi/dst.
-
-		// Check source/destination ROI.
-		imgSrc.CheckRange(roiSrc);
-
-		// Copy line by line.
-		switch (imgSrc.format)
-		{
-		case ImageFormat::BIP:
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y);
-				auto it_dst = imgDst.GetIterator(0, 0);
-				CopyLines<T>(it_src, depth * imgSrc.size.width, it_dst,
-					depth * size.width, depth * size.width, size.height);
-			}
-			break;
-		case ImageFormat::BSQ:
-			for (auto C = 0; C != imgSrc.size.depth; ++C)
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y, C);
-				auto it_dst = imgDst.GetIterator(0, 0, C);
-				CopyLines<T>(it_src, imgSrc.size.width, it_dst, size.width,
-					size.width, size.height);
-			}
-			break;
-		case ImageFormat::BIL:
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y);
-				auto it_dst = imgDst.GetIterator(0, 0);
-				CopyLines<T>(it_src, imgSrc.size.width, it_dst, size.width,
-					size.width,  depth * size.height);
-			}
-			break;
-		default:
-			std::ostringstream errMsg;
-			errMsg << "Image format " << static_cast<int>(imgSrc.format) <<
-				" is not supported.";
-			throw std::logic_error(errMsg.str());
-		}
+		Copy(imgSrc.GetView(roiSrc), imgDst);
 	}
 
+	/** The destination image is resized without zero-filling because all pixels are
+	overwritten. */
 	template <typename T>
 	void Copy(const Image<T> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
@@ -335,69 +1325,23 @@ namespace Imaging
 			Copy(imgSrc, roiSrc, imgDst);
 		else
 		{
-			// Reset destination image for given dimension.
-			Size3D<typename Image<T>::SizeType> szDst(roiSrc.size.width, roiSrc.size.height, imgSrc.size.depth);
-			imgDst.resize(szDst);
-			imgDst.format = fmt;
-			const auto depth = imgSrc.size.depth;	// common for both src/dst.
-			const auto size = roiSrc.size;			// common for both roi/dst.
-
-			// Check source/destination ROI.
-			imgSrc.CheckRange(roiSrc);
-
-			// Copy line by line.
-			switch (imgSrc.format)
+			switch (fmt)
 			{
 			case ImageFormat::BIP:
-				switch (fmt)
-				{
-					case ImageFormat::BSQ:
-						// TODO: Copy lines for selective channels only.
-						break;
-					case ImageFormat::BIL:
-
-						break;
-					default:
-						std::ostringstream errMsg;
-						errMsg << "Image format " << static_cast<int>(fmt) <<
-							" is not supported.";
-						throw std::logic_error(errMsg.str());
-				}
-				break;
 			case ImageFormat::BSQ:
-				switch (fmt)
-				{
-					case ImageFormat::BIP:
-						break;
-					case ImageFormat::BIL:
-						break;
-					default:
-						std::ostringstream errMsg;
-						errMsg << "Image format " << static_cast<int>(fmt) <<
-							" is not supported.";
-						throw std::logic_error(errMsg.str());
-				}
-				break;
 			case ImageFormat::BIL:
-				switch (fmt)
-				{
-					case ImageFormat::BIP:
-						break;
-					case ImageFormat::BSQ:
-						break;
-					default:
-						std::ostringstream errMsg;
-						errMsg << "Image format " << static_cast<int>(fmt) <<
-							" is not supported.";
-						throw std::logic_error(errMsg.str());
-				}
 				break;
 			default:
 				std::ostringstream errMsg;
-				errMsg << "Image format " << static_cast<int>(imgSrc.format) <<
-					" is not supported.";
+				errMsg << "Image format " << static_cast<int>(fmt) << " is not supported.";
 				throw std::logic_error(errMsg.str());
 			}
+
+			// Check source ROI before resetting destination image.
+			ImageView<const T> src = imgSrc.GetView(roiSrc);
+			imgDst.SetFormat(fmt);
+			imgDst.resize(src.size, ResizeMode::UNINITIALIZED);
+			Copy(src, imgDst.GetView());
 		}
 	}
 
@@ -405,108 +1349,204 @@ namespace Imaging
 	void Copy(const T *src, const Size3D<typename Image<T>::SizeType> &sz,
 		::size_t bytesPerLine, Image<T> &imgDst, ImageFormat fmt)
 	{		
-		if (bytesPerLine == sz.width * sizeof(T))	// no zero padding
-			Copy(src, sz, imgDst, fmt);
-		else
-		{ 	// zero padding
-			// Reset destination image for given dimension.
-			imgDst.resize(sz);
-			imgDst.format = fmt;
-
-			::size_t nElemWidthSrc = bytesPerLine / sizeof(T);
-			switch (fmt)
-			{
-			case Imaging::ImageFormat::BIP:
-				{
-					auto it_dst = imgDst.GetIterator(0, 0);
-					CopyLines<T>(src, nElemWidthSrc, it_dst,
-						depth * imgDst.size.width, depth * sz.width, sz.height);
-				}
-				break;
-			case Imaging::ImageFormat::BSQ:
-				for (auto C = 0; C != sz.depth; ++C)
-				{
-					auto it_dst = imgDst.GetIterator(0, 0, C);
-					CopyLines<T>(src + nElemWidthSrc * sz.height * C, nElemWidthSrc, it_dst,
-						imgDst.size.width, sz.width, sz.height);
-				}
-				break;
-			case Imaging::ImageFormat::BIL:
-				{
-					auto it_dst = imgDst.GetIterator(0, 0);
-					CopyLines<T>(src, nElemWidthSrc, it_dst, imgDst.size.width,
-						sz.width, depth * sz.height);
-				}
-				break;
-			default:
-				std::ostringstream errMsg;
-				errMsg << "Image format " << static_cast<int>(imgSrc.format) <<
-					" is not supported.";
-				throw std::logic_error(errMsg.str());
-			}
-		}
+		Copy(ImageView<const T>(src, sz, fmt, bytesPerLine / sizeof(T)), imgDst);
 	}
 
 	template <typename T>
 	void Copy(const T *src, const Size3D<typename Image<T>::SizeType> &sz,
 		Image<T> &imgDst, ImageFormat fmt)
 	{
-		// Reset destination image for given dimension.
-		imgDst.resize(sz);
-		imgDst.format = fmt;
-		
-		auto it_dst = imgDst.GetIterator(0, 0);
-		std::copy(src, src + sz.depth * sz.width * sz.height, it_dst);
+		// The number of bytes per line without padding bytes.
+		::size_t nElemWidth = fmt == ImageFormat::BIP ? sz.depth * sz.width : sz.width;
+		Copy(src, sz, nElemWidth * sizeof(T), imgDst, fmt);
 	}
 
-	template <typename T>
-	void Copy(const Image<T> &imgSrc,
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
 		T *dst)
 	{
-		// Check source/destination ROI.
-		imgSrc.CheckRange(roiSrc);
+		// The destination is an ROI of an image without padding elements.
+		Size3D<typename Image<T>::SizeType> szDst(roiSrc.size.width, roiSrc.size.height,
+			imgSrc.size.depth);
+		::size_t nElemWidth = imgSrc.format == ImageFormat::BIP ?
+			szDst.depth * szDst.width : szDst.width;
+		Copy(imgSrc.GetView(roiSrc), ImageView<T>(dst, szDst, imgSrc.format, nElemWidth));
+	}
+
+	template <typename T, ImageFormat F>
+	void Copy(const Image<T, F> &imgSrc, T *dst)
+	{
+		Copy(imgSrc, imgSrc.GetRoi(), dst);
+	}
+
+	/** Pixels of a row are continuous if channels are not skipped.
+	Otherwise, copies pixel by pixel as across image formats. */
+	template <typename T>
+	void CopyLines(const ImageView<const T> &src, const ImageView<T> &dst,
+		ImageLayout<ImageFormat::BIP>)
+	{
+		if (src.step.x != src.size.depth || dst.step.x != dst.size.depth)
+		{
+			CopyAcrossFormats(src, dst);
+			return;
+		}
+		CopyLines(src.GetPointer(0, 0), src.step.y, dst.GetPointer(0, 0), dst.step.y,
+			src.size.depth * src.size.width, src.size.height);
+	}
+
+	/** Channels are copied in parallel if the image is large but each channel is too small
+	to be copied in parallel by lines, e.g., hundreds of bands. */
+	template <typename T>
+	void CopyLines(const ImageView<const T> &src, const ImageView<T> &dst,
+		ImageLayout<ImageFormat::BSQ>)
+	{
+		const auto copyChannel = [&](::size_t C)
+		{
+			CopyLines(src.GetPointer(0, 0, C), src.step.y, dst.GetPointer(0, 0, C),
+				dst.step.y, src.size.width, src.size.height);
+		};
+		const ::size_t nBytesChannel = src.size.width * src.size.height * sizeof(T);
+		if (nBytesChannel < PARALLEL_COPY_THRESHOLD &&
+			nBytesChannel * src.size.depth >= PARALLEL_COPY_THRESHOLD)
+			ParallelFor(0, src.size.depth, copyChannel);
+		else
+			for (::size_t C = 0; C != src.size.depth; ++C)
+				copyChannel(C);
+	}
+
+	/** Lines of all channels are evenly spaced if channels are not skipped.
+	Otherwise, copies channel by channel as BSQ. */
+	template <typename T>
+	void CopyLines(const ImageView<const T> &src, const ImageView<T> &dst,
+		ImageLayout<ImageFormat::BIL>)
+	{
+		const auto depth = src.size.depth;	// common for both src/dst.
+		if (src.step.y == depth * src.step.z && dst.step.y == depth * dst.step.z)
+			CopyLines(src.GetPointer(0, 0), src.step.z, dst.GetPointer(0, 0), dst.step.z,
+				src.size.width, depth * src.size.height);
+		else
+			CopyLines(src, dst, ImageLayout<ImageFormat::BSQ>());
+	}
+
+	template <typename T>
+	void CopyAcrossFormats(const ImageView<const T> &src, const ImageView<T> &dst)
+	{
+		const auto size = src.size;	// common for both src/dst.
+
+		// BSQ <-> BIL: lines of each channel are continuous at both views.
+		if (src.step.x == 1 && dst.step.x == 1)
+		{
+			for (::size_t C = 0; C != size.depth; ++C)
+				CopyLines(src.GetPointer(0, 0, C), src.step.y, dst.GetPointer(0, 0, C),
+					dst.step.y, size.width, size.height);
+			return;
+		}
+
+		// BIP <-> BSQ/BIL: pixels and channels are transposed for each row.
+		const bool isInterleaving = src.step.x == 1 && dst.step.x == size.depth &&
+			dst.step.z == 1;
+		const bool isDeinterleaving = dst.step.x == 1 && src.step.x == size.depth &&
+			src.step.z == 1;
+		const auto copyRow = [&](::size_t H)
+		{
+			const T *p_src = src.GetPointer(0, H);
+			T *p_dst = dst.GetPointer(0, H);
+			if (isInterleaving && size.depth == 3)
+				Interleave<3>(p_src, src.step.z, p_dst, size.width);
+			else if (isInterleaving && size.depth == 4)
+				Interleave<4>(p_src, src.step.z, p_dst, size.width);
+			else if (isDeinterleaving && size.depth == 3)
+				Deinterleave<3>(p_src, p_dst, dst.step.z, size.width);
+			else if (isDeinterleaving && size.depth == 4)
+				Deinterleave<4>(p_src, p_dst, dst.step.z, size.width);
+			else
+				CopyTiles(p_src, src.step.x, src.step.z, p_dst, dst.step.x, dst.step.z,
+					size.width, size.depth);
+		};
+		if (size.width * size.height * size.depth * sizeof(T) >= PARALLEL_COPY_THRESHOLD)
+			ParallelFor(0, size.height, copyRow);
+		else
+			for (::size_t H = 0; H != size.height; ++H)
+				copyRow(H);
+	}
+
+	/** Copies the whole data as a single block if there is no padding element at both
+	views. Otherwise, copies line by line with the logic selected for the image format.
+	Either way, CopyLines() divides a large image over threads. */
+	template <typename T>
+	void Copy(const ImageView<const T> &src, const ImageView<T> &dst)
+	{
+		// Check image size.
+		if (src.size != dst.size)
+			throw std::runtime_error(
+			"Size of source/destination images should be identical.");
+		const auto size = src.size;	// common for both src/dst.
+		if (size.width == 0 || size.height == 0 || size.depth == 0)
+			return;
+
+		if (src.format != dst.format)
+		{
+			CopyAcrossFormats(src, dst);
+			return;
+		}
+
+		if (src.IsContinuous() && dst.IsContinuous())
+		{
+			const ::size_t nElem = size.width * size.height * size.depth;
+			CopyLines(src.GetPointer(0, 0), nElem, dst.GetPointer(0, 0), nElem, nElem, 1);
+			return;
+		}
 
 		// Copy line by line.
-		switch (imgSrc.format)
+		switch (src.format)
 		{
 		case ImageFormat::BIP:
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y);
-				CopyLines<T>(it_src, imgSrc.size.depth * imgSrc.size.width, dst,
-					imgSrc.size.depth * roiSrc.size.width,
-					imgSrc.size.depth * roiSrc.size.width, roiSrc.size.height);
-			}
+			CopyLines(src, dst, ImageLayout<ImageFormat::BIP>());
 			break;
 		case ImageFormat::BSQ:
-			for (auto C = 0; C != imgSrc.size.depth; ++C)
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y, C);
-				CopyLines<T>(it_src, imgSrc.size.width, dst + roiSrc.size.width * roiSrc.size.height * C,
-					roiSrc.size.width, roiSrc.size.width, roiSrc.size.height);
-			}
+			CopyLines(src, dst, ImageLayout<ImageFormat::BSQ>());
 			break;
 		case ImageFormat::BIL:
-			{
-				auto it_src = imgSrc.GetIterator(roiSrc.origin.x, roiSrc.origin.y);
-				CopyLines<T>(it_src, imgSrc.size.width, dst, roiSrc.size.width,
-					roiSrc.size.width,  imgSrc.size.depth * roiSrc.size.height);
-			}
+			CopyLines(src, dst, ImageLayout<ImageFormat::BIL>());
 			break;
 		default:
 			std::ostringstream errMsg;
-			errMsg << "Image format " << static_cast<int>(imgSrc.format) <<
+			errMsg << "Image format " << static_cast<int>(src.format) <<
 				" is not supported.";
 			throw std::logic_error(errMsg.str());
 		}
 	}
 
 	template <typename T>
-	void Copy(const Image<T> &imgSrc, T *dst)
+	void Copy(const ImageView<T> &src, const ImageView<T> &dst)
+	{
+		Copy(ImageView<const T>(src), dst);
+	}
+
+	template <typename T, ImageFormat F>
+	void Copy(const ImageView<const T> &src, Image<T, F> &imgDst)
 	{
-		auto it_src = imgSrc.GetIterator(0, 0);
-		auto nElem = imgSrc.size.width * imgSrc.size.height * imgSrc.size.depth;
-		std::copy(it_src, it_src + nElem, dst);
+		// Reset destination image for given dimension.
+		// The format is set first because the padding elements depend on it.
+		imgDst.SetFormat(src.format);
+		imgDst.resize(src.size, ResizeMode::UNINITIALIZED);
+		Copy(src, imgDst.GetView());
+	}
+
+	template <typename T, ImageFormat F>
+	void Copy(const ImageView<T> &src, Image<T, F> &imgDst)
+	{
+		Copy(ImageView<const T>(src), imgDst);
+	}
+
+	template <typename T, typename U, typename Function>
+	void ParallelFor(const Region<T, U> &roi, const Size2D<U> &tileSize, Function func)
+	{
+		ParallelFor(0, GetTileCount(roi, tileSize), [&](::size_t N)
+		{
+			func(GetTile(roi, tileSize, N));
+		}, 1);
 	}
 }
 
@@ -1,35 +1,262 @@
 #if !defined(IMAGE_PROCESSING_H)
 #define IMAGE_PROCESSING_H
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include "image.h"
-
-#include "opencv2/opencv.hpp"
+#include "thread_pool.h"
 
 namespace Imaging
 {
+	enum class Interpolation {NEAREST, LINEAR, AREA, CUBIC, LANCZO};
+
+	/** The number of fraction bits of the fixed-point weights for 8-bit elements. */
+	const int RESAMPLE_COEF_BITS = 11;
+
+	/** The number of fraction bits of the fixed-point weights for 16-bit elements, which
+	keeps the error of the weights within a fraction of the least significant bit. */
+	const int RESAMPLE_COEF_BITS_16 = 20;
+
+	/** An image is resampled in parallel if the destination has this number of bytes or
+	more. */
+	const ::size_t PARALLEL_RESAMPLE_THRESHOLD = 256 * 1024;
+
+	/** Selects the arithmetic of the resampler for an element type.
+
+	Floating-point elements and 32-bit integers are resampled in double, except float which
+	is resampled in float. COEF_BITS is the number of fraction bits of fixed-point weights,
+	or zero for floating-point weights. */
 	template <typename T>
-	int GetOpenCvType(void);
+	struct ResampleTraits
+	{
+		typedef double WeightType;	// weights of the taps
+		typedef double BufferType;	// elements resampled horizontally
+		typedef double AccumType;	// elements resampled vertically
 
-	enum class Interpolation {NEAREST, LINEAR, AREA, CUBIC, LANCZO};
-	/** Resizes image data from a source ROI, and copies the resized image data to
-	destination ROI.
+		static const int COEF_BITS = 0;
+
+		static T Cast(AccumType value);
+	};
+
+	template <>
+	struct ResampleTraits<float>
+	{
+		typedef float WeightType;
+		typedef float BufferType;
+		typedef float AccumType;
+
+		static const int COEF_BITS = 0;
+
+		static float Cast(AccumType value);
+	};
+
+	/** 8-bit and 16-bit elements are resampled in fixed point, where both the weights and
+	the elements resampled horizontally have N fraction bits. B and A are large enough to
+	hold the elements resampled horizontally and vertically respectively. */
+	template <typename T, typename B, typename A, int N>
+	struct FixedPointResampleTraits
+	{
+		typedef int WeightType;
+		typedef B BufferType;
+		typedef A AccumType;
+
+		static const int COEF_BITS = N;
+
+		static T Cast(AccumType value);
+	};
+
+	template <>
+	struct ResampleTraits<unsigned char> : public FixedPointResampleTraits<unsigned char,
+		int, int, RESAMPLE_COEF_BITS> {};
+
+	template <>
+	struct ResampleTraits<signed char> : public FixedPointResampleTraits<signed char,
+		int, int, RESAMPLE_COEF_BITS> {};
+
+	template <>
+	struct ResampleTraits<unsigned short> : public FixedPointResampleTraits<unsigned short,
+		long long, long long, RESAMPLE_COEF_BITS_16> {};
+
+	template <>
+	struct ResampleTraits<short> : public FixedPointResampleTraits<short,
+		long long, long long, RESAMPLE_COEF_BITS_16> {};
+
+	/** Source indices and weights to resample an axis of nSrc elements to nDst elements,
+	where each destination element is the weighted sum of nTaps source elements.
+
+	Source indices out of the axis are clamped to the border, i.e., the border elements
+	are replicated, and unused taps have zero weights. */
+	template <typename W>
+	struct ResampleAxis
+	{
+		ResampleAxis(void);
+
+		/** Computes the taps for an interpolation, where the source coordinate of the
+		center of destination element d is (d + 0.5) * nSrc / nDst - 0.5.
+
+		NEAREST takes the source element at floor(d * nSrc / nDst). AREA averages the
+		source elements covered by a destination element weighted by the covered lengths.
+		CUBIC is the Keys kernel of a = -0.75, and LANCZO is the Lanczos kernel of 4 lobes.
+		Integer weights have nBits fraction bits.
+		@exception std::invalid_argument	if nSrc is zero and nDst is not */
+		void Compute(::size_t nSrc, ::size_t nDst, Interpolation interp,
+			int nBits = RESAMPLE_COEF_BITS);
+
+		::size_t nTaps;
+		std::vector< ::size_t> indices;	// nDst x nTaps
+		std::vector<W> weights;			// nDst x nTaps
+		std::vector<double> work;		// weights of an element before normalization
+	};
+
+	/** The taps to resize images of a source size to a destination size by an
+	interpolation, which are computed once and used for any number of images, e.g., the
+	frames of a video stream, so resizing a frame takes only the time of the kernels. */
+	template <typename T>
+	class ResizePlan
+	{
+	public:
+		typedef typename ResampleTraits<T>::WeightType WeightType;
+
+		//////////////////////////////////////////////////
+		// Default constructor
+		ResizePlan(void);
+
+		//////////////////////////////////////////////////
+		// Custom constructors
+		ResizePlan(const Size2D< ::size_t> &szSrc, const Size2D< ::size_t> &szDst,
+			Interpolation interp = Interpolation::LINEAR);
+
+		/** The destination size is the source size zoomed by zm and rounded as
+		Region::Zoom(). */
+		ResizePlan(const Size2D< ::size_t> &szSrc, const Point2D<double> &zm,
+			Interpolation interp = Interpolation::LINEAR);
+
+		//////////////////////////////////////////////////
+		// Accessors
+		const Size2D< ::size_t> &GetSourceSize(void) const;
+		const Size2D< ::size_t> &GetDestinationSize(void) const;
+		Interpolation GetInterpolation(void) const;
+		const ResampleAxis<WeightType> &GetAxisX(void) const;
+		const ResampleAxis<WeightType> &GetAxisY(void) const;
+
+		//////////////////////////////////////////////////
+		// Methods
+		bool IsMatched(const Size2D< ::size_t> &szSrc, const Size2D< ::size_t> &szDst,
+			Interpolation interp) const;
+
+		/** Computes the taps for another geometry unless it is the current one. */
+		void Reset(const Size2D< ::size_t> &szSrc, const Size2D< ::size_t> &szDst,
+			Interpolation interp = Interpolation::LINEAR);
 
-	@NOTE The destination image should have already allocated. */
-	//template <typename T>
-	//void Resize(const Image<T> &imgSrc,
-	//	const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
-	//	const Point2D<double> &zm, Image<T> &imgDst,
-	//	const Point2D<typename Image<T>::SizeType> &orgnDst,
-	//	Interpolation interp = Interpolation::LINEAR);
+		/** Resizes a view to another view of the sizes of the plan.
+		@exception std::invalid_argument	if the sizes are not matched with the plan, or
+		the views have different formats or numbers of channels */
+		void Execute(const ImageView<const T> &src, const ImageView<T> &dst) const;
+		void Execute(const ImageView<T> &src, const ImageView<T> &dst) const;
+
+		/** Resizes a view to destination image, which is reallocated only if its size or
+		format is changed. */
+		void Execute(const ImageView<const T> &src, Image<T> &imgDst) const;
+		void Execute(const Image<T> &imgSrc, Image<T> &imgDst) const;
+
+	protected:
+		void CheckSize(const Size3D< ::size_t> &szSrc, const Size3D< ::size_t> &szDst) const;
+
+		//////////////////////////////////////////////////
+		// Data
+		Size2D< ::size_t> szSrc_;
+		Size2D< ::size_t> szDst_;
+		Interpolation interp_;
+		ResampleAxis<WeightType> axisX_;
+		ResampleAxis<WeightType> axisY_;
+	};
+
+	/** The number of plans kept by a thread for Resize(). */
+	const ::size_t RESIZE_PLAN_CACHE_SIZE = 4;
+
+	/** The plans used recently by a thread, so Resize() does not compute the taps again
+	for the geometries used in turn, e.g., the tiles of a few zooms of a mosaic. */
+	template <typename T>
+	class ResizePlanCache
+	{
+	public:
+		ResizePlanCache(void);
+
+		/** Returns the plan of a geometry, where the least recently used plan is computed
+		again if no plan is matched. */
+		const ResizePlan<T> &GetPlan(const Size2D< ::size_t> &szSrc,
+			const Size2D< ::size_t> &szDst, Interpolation interp);
+
+	protected:
+		ResizePlan<T> plans_[RESIZE_PLAN_CACHE_SIZE];
+		::size_t uses_[RESIZE_PLAN_CACHE_SIZE];	// the last use of each plan
+		::size_t nUses_;
+	};
+
+	/** The lines kept by a thread for a band of Resample(). */
+	template <typename T>
+	struct ResampleLines
+	{
+		typedef typename ResampleTraits<T>::BufferType BufferType;
+		typedef typename ResampleTraits<T>::AccumType AccumType;
+
+		std::vector<BufferType> rows;			// source rows resampled horizontally
+		std::vector< ::size_t> tags;			// the source row kept in each slot of rows
+		std::vector<AccumType> acc;				// a destination row resampled vertically
+		std::vector<const BufferType *> taps;	// the rows of a destination row
+	};
+
+	/** Resizes image data of a view to fill another view, e.g., an ROI of an image.
+
+	The rows are resampled horizontally, and the resampled rows are combined vertically,
+	where each task of the shared thread pool resamples a band of destination rows.
+	BIP, BSQ and BIL views are resampled in place of their layouts. The plans of the recent
+	geometries and the lines are kept by each thread, so resizing to the same sizes again
+	neither computes the taps nor allocates memory.
+	@exception std::invalid_argument	if the views have different formats or numbers of
+	channels */
+	template <typename T>
+	void Resize(const ImageView<const T> &src, const ImageView<T> &dst,
+		Interpolation interp = Interpolation::LINEAR);
+
+	template <typename T>
+	void Resize(const ImageView<T> &src, const ImageView<T> &dst,
+		Interpolation interp = Interpolation::LINEAR);
+
+	/** Resizes a view by the taps computed for both axes in advance. The source elements
+	are just copied if both axes have a single tap. */
+	template <typename T>
+	void Resample(const ImageView<const T> &src, const ImageView<T> &dst,
+		const ResampleAxis<typename ResampleTraits<T>::WeightType> &axisX,
+		const ResampleAxis<typename ResampleTraits<T>::WeightType> &axisY);
+
+	/** Resizes image data from a source ROI, and writes the resized image data to the
+	destination ROI at orgnDst, whose size is the size of the source ROI zoomed by zm.
+
+	The source ROI is read and the destination ROI is written in place, so neither a
+	temporary image nor the destination image is allocated, e.g., to compose many tiles
+	into a canvas.
+	@NOTE The destination image should have already allocated.
+	@exception std::out_of_range	if either ROI is out of range
+	@exception std::invalid_argument	if the images have different formats or numbers of
+	channels */
+	template <typename T>
+	void Resize(const Image<T> &imgSrc,
+		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
+		const Point2D<double> &zm, Image<T> &imgDst,
+		const Point2D<typename Image<T>::SizeType> &orgnDst,
+		Interpolation interp = Interpolation::LINEAR);
 
 	/** Resizes image data from a source ROI, and copies the resized image data to
 	destination image.
-	
+
 	The destination image is resized to exactly fit the result. */
 	template <typename T>
-	void Resize(Image<T> &imgSrc,
+	void Resize(const Image<T> &imgSrc,
 		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
 		const Point2D<double> &zm, Image<T> &imgDst,
 		Interpolation interp = Interpolation::LINEAR);
@@ -39,6 +266,16 @@ namespace Imaging
 	template <typename T>
 	void Resize(const Image<T> &imgSrc,	const Point2D<double> &zm, Image<T> &imgDst,
 		Interpolation interp = Interpolation::LINEAR);
+
+	/** Resizes image data of a view, e.g., an ROI of an image, and copies the resized image
+	data to destination image without copying the source data. */
+	template <typename T>
+	void Resize(const ImageView<const T> &src, const Point2D<double> &zm, Image<T> &imgDst,
+		Interpolation interp = Interpolation::LINEAR);
+
+	template <typename T>
+	void Resize(const ImageView<T> &src, const Point2D<double> &zm, Image<T> &imgDst,
+		Interpolation interp = Interpolation::LINEAR);
 }
 
 #include "image_processing_inl.h"
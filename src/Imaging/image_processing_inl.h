@@ -3,80 +3,749 @@
 
 namespace Imaging
 {
+	//////////////////////////////////////////////////////////////////////////
+	// ResampleTraits<T> struct
+
+	template <typename T>
+	T ResampleTraits<T>::Cast(AccumType value)
+	{
+		if (!std::numeric_limits<T>::is_integer)
+			return static_cast<T>(value);
+
+		// Rounds and saturates an integer.
+		if (value <= static_cast<AccumType>(std::numeric_limits<T>::min()))
+			return std::numeric_limits<T>::min();
+		if (value >= static_cast<AccumType>(std::numeric_limits<T>::max()))
+			return std::numeric_limits<T>::max();
+		return static_cast<T>(std::floor(value + 0.5));
+	}
+
+	inline float ResampleTraits<float>::Cast(AccumType value)
+	{
+		return value;
+	}
+
+	template <typename T, typename B, typename A, int N>
+	T FixedPointResampleTraits<T, B, A, N>::Cast(AccumType value)
+	{
+		const int nShift = 2 * N;
+		const A rounded = (value + (static_cast<A>(1) << (nShift - 1))) >> nShift;
+		return static_cast<T>(std::min<A>(std::max<A>(rounded, std::numeric_limits<T>::min()),
+			std::numeric_limits<T>::max()));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ResampleAxis<W> struct
+
+	template <typename W>
+	ResampleAxis<W>::ResampleAxis(void) : nTaps(0) {}
+
+	/** The weights are normalized to sum to 1, and the fixed-point weights are rounded
+	and then the largest one is corrected, so a flat area stays exactly flat. */
+	template <typename W>
+	void ResampleAxis<W>::Compute(::size_t nSrc, ::size_t nDst, Interpolation interp,
+		int nBits)
+	{
+		if (nSrc == 0 && nDst != 0)
+			throw std::invalid_argument("An empty axis cannot be resampled.");
+
+		const double scale = nDst != 0 ? static_cast<double>(nSrc) / nDst : 0.0;
+		switch (interp)
+		{
+		case Interpolation::NEAREST:
+			this->nTaps = 1;
+			break;
+		case Interpolation::LINEAR:
+			this->nTaps = 2;
+			break;
+		case Interpolation::AREA:
+			this->nTaps = static_cast< ::size_t>(std::ceil(scale)) + 1;
+			break;
+		case Interpolation::CUBIC:
+			this->nTaps = 4;
+			break;
+		case Interpolation::LANCZO:
+			this->nTaps = 8;
+			break;
+		default:
+			std::ostringstream errMsg;
+			errMsg << "Interpolation " << static_cast<int>(interp) << " is not supported.";
+			throw std::invalid_argument(errMsg.str());
+		}
+		this->indices.resize(nDst * this->nTaps);
+		this->weights.resize(nDst * this->nTaps);
+
+		const ::size_t nTaps = this->nTaps;
+		const long long last = static_cast<long long>(nSrc) - 1;
+		this->work.resize(nTaps);
+		double *w = this->work.data();
+		for (::size_t D = 0; D != nDst; ++D)
+		{
+			long long first;	// the source index of the first tap
+			std::fill(w, w + nTaps, 0.0);
+			if (interp == Interpolation::NEAREST)
+			{
+				first = std::min(static_cast<long long>(D * nSrc / nDst), last);
+				w[0] = 1.0;
+			}
+			else if (interp == Interpolation::AREA)
+			{
+				const double x0 = static_cast<double>(D * nSrc) / nDst;
+				const double x1 = static_cast<double>((D + 1) * nSrc) / nDst;
+				first = static_cast<long long>(std::floor(x0));
+				for (::size_t K = 0; K != nTaps; ++K)
+				{
+					const double a = std::max(x0, static_cast<double>(first + K));
+					const double b = std::min(x1, static_cast<double>(first + K + 1));
+					if (b > a)
+						w[K] = b - a;
+				}
+			}
+			else
+			{
+				const double x = (D + 0.5) * scale - 0.5;
+				const double t = x - std::floor(x);
+				first = static_cast<long long>(std::floor(x)) -
+					static_cast<long long>(nTaps / 2 - 1);
+				if (interp == Interpolation::LINEAR)
+				{
+					w[0] = 1.0 - t;
+					w[1] = t;
+				}
+				else if (interp == Interpolation::CUBIC)
+				{
+					const double A = -0.75;
+					w[0] = ((A * (t + 1.0) - 5.0 * A) * (t + 1.0) + 8.0 * A) * (t + 1.0) -
+						4.0 * A;
+					w[1] = ((A + 2.0) * t - (A + 3.0)) * t * t + 1.0;
+					w[2] = ((A + 2.0) * (1.0 - t) - (A + 3.0)) * (1.0 - t) * (1.0 - t) + 1.0;
+					w[3] = 1.0 - w[0] - w[1] - w[2];
+				}
+				else
+				{
+					const double pi = 3.14159265358979323846;
+					for (::size_t K = 0; K != nTaps; ++K)
+					{
+						const double d = static_cast<double>(K) - (nTaps / 2 - 1) - t;
+						w[K] = std::abs(d) < 1e-12 ? 1.0 :
+							4.0 * std::sin(pi * d) * std::sin(pi * d / 4.0) / (pi * pi * d * d);
+					}
+				}
+			}
+
+			double sum = 0.0;
+			for (::size_t K = 0; K != nTaps; ++K)
+				sum += w[K];
+
+			::size_t *idx = &this->indices[D * nTaps];
+			W *wgt = &this->weights[D * nTaps];
+			for (::size_t K = 0; K != nTaps; ++K)
+				idx[K] = static_cast< ::size_t>(std::min(std::max(first +
+					static_cast<long long>(K), 0LL), last));
+			if (std::numeric_limits<W>::is_integer)
+			{
+				const long long one = 1LL << nBits;
+				long long total = 0;
+				::size_t kMax = 0;
+				for (::size_t K = 0; K != nTaps; ++K)
+				{
+					wgt[K] = static_cast<W>(std::floor(w[K] / sum * one + 0.5));
+					total += wgt[K];
+					if (std::abs(w[K]) > std::abs(w[kMax]))
+						kMax = K;
+				}
+				wgt[kMax] = static_cast<W>(wgt[kMax] + one - total);
+			}
+			else
+			{
+				for (::size_t K = 0; K != nTaps; ++K)
+					wgt[K] = static_cast<W>(w[K] / sum);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ResizePlan<T> class
+
 	template <typename T>
-	int GetOpenCvType(::size_t depth)
-	{
-		if (typeid(T) == typeid(unsigned char))
-			return SafeCast_<int>(CV_MAKETYPE(CV_8U, depth));
-		else if (typeid(T) == typeid(signed char))
-			return SafeCast_<int>(CV_MAKETYPE(CV_8S, depth));
-		else if (typeid(T) == typeid(unsigned short))
-			return SafeCast_<int>(CV_MAKETYPE(CV_16U, depth));
-		else if (typeid(T) == typeid(short))
-			return SafeCast_<int>(CV_MAKETYPE(CV_16S, depth));
-		else if (typeid(T) == typeid(int))
-			return SafeCast_<int>(CV_MAKETYPE(CV_32S, depth));
-		else if (typeid(T) == typeid(float))
-			return SafeCast_<int>(CV_MAKETYPE(CV_32F, depth));
-		else if (typeid(T) == typeid(double))
-			return SafeCast_<int>(CV_MAKETYPE(CV_64F, depth));
+	ResizePlan<T>::ResizePlan(void) : szSrc_(0, 0), szDst_(0, 0),
+		interp_(Interpolation::LINEAR)
+	{
+		this->axisX_.Compute(0, 0, this->interp_, ResampleTraits<T>::COEF_BITS);
+		this->axisY_.Compute(0, 0, this->interp_, ResampleTraits<T>::COEF_BITS);
+	}
+
+	template <typename T>
+	ResizePlan<T>::ResizePlan(const Size2D< ::size_t> &szSrc, const Size2D< ::size_t> &szDst,
+		Interpolation interp) : szSrc_(szSrc), szDst_(szDst), interp_(interp)
+	{
+		this->axisX_.Compute(szSrc.width, szDst.width, interp,
+			ResampleTraits<T>::COEF_BITS);
+		this->axisY_.Compute(szSrc.height, szDst.height, interp,
+			ResampleTraits<T>::COEF_BITS);
+	}
+
+	template <typename T>
+	ResizePlan<T>::ResizePlan(const Size2D< ::size_t> &szSrc, const Point2D<double> &zm,
+		Interpolation interp) : szSrc_(szSrc),
+		szDst_((Region< ::size_t, ::size_t>(0, 0, szSrc.width, szSrc.height) * zm).size),
+		interp_(interp)
+	{
+		this->axisX_.Compute(this->szSrc_.width, this->szDst_.width, interp,
+			ResampleTraits<T>::COEF_BITS);
+		this->axisY_.Compute(this->szSrc_.height, this->szDst_.height, interp,
+			ResampleTraits<T>::COEF_BITS);
+	}
+
+	template <typename T>
+	const Size2D< ::size_t> &ResizePlan<T>::GetSourceSize(void) const
+	{
+		return this->szSrc_;
+	}
+
+	template <typename T>
+	const Size2D< ::size_t> &ResizePlan<T>::GetDestinationSize(void) const
+	{
+		return this->szDst_;
+	}
+
+	template <typename T>
+	Interpolation ResizePlan<T>::GetInterpolation(void) const
+	{
+		return this->interp_;
+	}
+
+	template <typename T>
+	const ResampleAxis<typename ResizePlan<T>::WeightType> &ResizePlan<T>::GetAxisX(void) const
+	{
+		return this->axisX_;
+	}
+
+	template <typename T>
+	const ResampleAxis<typename ResizePlan<T>::WeightType> &ResizePlan<T>::GetAxisY(void) const
+	{
+		return this->axisY_;
+	}
+
+	template <typename T>
+	bool ResizePlan<T>::IsMatched(const Size2D< ::size_t> &szSrc,
+		const Size2D< ::size_t> &szDst, Interpolation interp) const
+	{
+		return this->szSrc_ == szSrc && this->szDst_ == szDst && this->interp_ == interp;
+	}
+
+	/** The taps are computed in the vectors of the plan, so the memory is reused unless
+	the sizes grow. */
+	template <typename T>
+	void ResizePlan<T>::Reset(const Size2D< ::size_t> &szSrc, const Size2D< ::size_t> &szDst,
+		Interpolation interp)
+	{
+		if (this->IsMatched(szSrc, szDst, interp))
+			return;
+
+		try
+		{
+			this->axisX_.Compute(szSrc.width, szDst.width, interp,
+				ResampleTraits<T>::COEF_BITS);
+			this->axisY_.Compute(szSrc.height, szDst.height, interp,
+				ResampleTraits<T>::COEF_BITS);
+		}
+		catch (...)
+		{
+			// A failed plan becomes the empty plan, so it is never matched by mistake.
+			*this = ResizePlan<T>();
+			throw;
+		}
+		this->szSrc_ = szSrc;
+		this->szDst_ = szDst;
+		this->interp_ = interp;
+	}
+
+	template <typename T>
+	void ResizePlan<T>::Execute(const ImageView<const T> &src, const ImageView<T> &dst) const
+	{
+		this->CheckSize(src.size, dst.size);
+		Resample(src, dst, this->axisX_, this->axisY_);
+	}
+
+	template <typename T>
+	void ResizePlan<T>::Execute(const ImageView<T> &src, const ImageView<T> &dst) const
+	{
+		this->Execute(ImageView<const T>(src), dst);
+	}
+
+	template <typename T>
+	void ResizePlan<T>::Execute(const ImageView<const T> &src, Image<T> &imgDst) const
+	{
+		imgDst.SetFormat(src.format);
+		imgDst.resize(Size3D<typename Image<T>::SizeType>(this->szDst_.width,
+			this->szDst_.height, src.size.depth), ResizeMode::UNINITIALIZED);
+		this->Execute(src, imgDst.GetView());
+	}
+
+	template <typename T>
+	void ResizePlan<T>::Execute(const Image<T> &imgSrc, Image<T> &imgDst) const
+	{
+		this->Execute(imgSrc.GetView(), imgDst);
+	}
+
+	template <typename T>
+	void ResizePlan<T>::CheckSize(const Size3D< ::size_t> &szSrc,
+		const Size3D< ::size_t> &szDst) const
+	{
+		if (szSrc.width != this->szSrc_.width || szSrc.height != this->szSrc_.height ||
+			szDst.width != this->szDst_.width || szDst.height != this->szDst_.height)
+		{
+			std::ostringstream errMsg;
+			errMsg << "The plan to resize " << this->szSrc_.width << " x " <<
+				this->szSrc_.height << " to " << this->szDst_.width << " x " <<
+				this->szDst_.height << " cannot resize " << szSrc.width << " x " <<
+				szSrc.height << " to " << szDst.width << " x " << szDst.height << ".";
+			throw std::invalid_argument(errMsg.str());
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ResizePlanCache<T> class
+
+	template <typename T>
+	ResizePlanCache<T>::ResizePlanCache(void) : nUses_(0)
+	{
+		std::fill(this->uses_, this->uses_ + RESIZE_PLAN_CACHE_SIZE, 0);
+	}
+
+	template <typename T>
+	const ResizePlan<T> &ResizePlanCache<T>::GetPlan(const Size2D< ::size_t> &szSrc,
+		const Size2D< ::size_t> &szDst, Interpolation interp)
+	{
+		::size_t index = 0;
+		for (::size_t N = 0; N != RESIZE_PLAN_CACHE_SIZE; ++N)
+		{
+			if (this->plans_[N].IsMatched(szSrc, szDst, interp))
+			{
+				index = N;
+				break;
+			}
+			if (this->uses_[N] < this->uses_[index])
+				index = N;
+		}
+		this->plans_[index].Reset(szSrc, szDst, interp);
+		this->uses_[index] = ++this->nUses_;
+		return this->plans_[index];
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	/** Resamples a line of pixels of nCh interleaved channels horizontally, where step is
+	the number of elements from a pixel to the next one.
+
+	N is the number of channels known at compile time, or zero for nCh, so the loops over
+	the channels are unrolled for the common numbers of channels. */
+	template < ::size_t N, typename T, typename W, typename B>
+	void ResampleRow(const T *src, ::size_t step, ::size_t nCh, const ResampleAxis<W> &axis,
+		::size_t width, B *dst)
+	{
+		const ::size_t nChannels = N != 0 ? N : nCh;
+		const ::size_t nTaps = axis.nTaps;
+		const ::size_t *idx = axis.indices.data();
+		const W *w = axis.weights.data();
+		if (nTaps == 2)
+		{
+			for (::size_t D = 0; D != width; ++D, idx += 2, w += 2, dst += nChannels)
+			{
+				const T *p0 = src + idx[0] * step;
+				const T *p1 = src + idx[1] * step;
+				const B w0 = static_cast<B>(w[0]), w1 = static_cast<B>(w[1]);
+				for (::size_t C = 0; C != nChannels; ++C)
+					dst[C] = w0 * static_cast<B>(p0[C]) + w1 * static_cast<B>(p1[C]);
+			}
+		}
+		else if (nTaps == 4)
+		{
+			for (::size_t D = 0; D != width; ++D, idx += 4, w += 4, dst += nChannels)
+			{
+				const T *p0 = src + idx[0] * step;
+				const T *p1 = src + idx[1] * step;
+				const T *p2 = src + idx[2] * step;
+				const T *p3 = src + idx[3] * step;
+				const B w0 = static_cast<B>(w[0]), w1 = static_cast<B>(w[1]);
+				const B w2 = static_cast<B>(w[2]), w3 = static_cast<B>(w[3]);
+				for (::size_t C = 0; C != nChannels; ++C)
+					dst[C] = w0 * static_cast<B>(p0[C]) + w1 * static_cast<B>(p1[C]) +
+						w2 * static_cast<B>(p2[C]) + w3 * static_cast<B>(p3[C]);
+			}
+		}
 		else
-			throw std::invalid_argument("Unsupported type.");
+		{
+			for (::size_t D = 0; D != width; ++D, idx += nTaps, w += nTaps, dst += nChannels)
+			{
+				for (::size_t C = 0; C != nChannels; ++C)
+					dst[C] = 0;
+				for (::size_t K = 0; K != nTaps; ++K)
+				{
+					const B wk = static_cast<B>(w[K]);
+					const T *p = src + idx[K] * step;
+					for (::size_t C = 0; C != nChannels; ++C)
+						dst[C] += wk * static_cast<B>(p[C]);
+				}
+			}
+		}
+	}
+
+	template <typename T, typename W, typename B>
+	void ResampleRow(const T *src, ::size_t step, ::size_t nCh, const ResampleAxis<W> &axis,
+		::size_t width, B *dst)
+	{
+		switch (nCh)
+		{
+		case 1:
+			ResampleRow<1>(src, step, nCh, axis, width, dst);
+			break;
+		case 3:
+			ResampleRow<3>(src, step, nCh, axis, width, dst);
+			break;
+		case 4:
+			ResampleRow<4>(src, step, nCh, axis, width, dst);
+			break;
+		default:
+			ResampleRow<0>(src, step, nCh, axis, width, dst);
+			break;
+		}
+	}
+
+	/** Copies the source pixels at the indices of an axis of a single tap. */
+	template < ::size_t N, typename T>
+	void SampleRow(const T *src, ::size_t stepSrc, ::size_t nCh, const ::size_t *idx,
+		::size_t width, T *dst, ::size_t stepDst)
+	{
+		const ::size_t nChannels = N != 0 ? N : nCh;
+		for (::size_t D = 0; D != width; ++D, dst += stepDst)
+		{
+			const T *p = src + idx[D] * stepSrc;
+			for (::size_t C = 0; C != nChannels; ++C)
+				dst[C] = p[C];
+		}
 	}
 
-	/** The internal interpolation logic calls an OpenCV function, and this function creates
-	a temporary OpenCV Mat objects from existing images without memory allocation. */
 	template <typename T>
-	void Resize(Image<T> &imgSrc,
-		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
-		const Point2D<double> &zm, Image<T> &imgDst, Interpolation interp)
+	void SampleRow(const T *src, ::size_t stepSrc, ::size_t nCh, const ::size_t *idx,
+		::size_t width, T *dst, ::size_t stepDst)
+	{
+		switch (nCh)
+		{
+		case 1:
+			SampleRow<1>(src, stepSrc, nCh, idx, width, dst, stepDst);
+			break;
+		case 3:
+			SampleRow<3>(src, stepSrc, nCh, idx, width, dst, stepDst);
+			break;
+		case 4:
+			SampleRow<4>(src, stepSrc, nCh, idx, width, dst, stepDst);
+			break;
+		default:
+			SampleRow<0>(src, stepSrc, nCh, idx, width, dst, stepDst);
+			break;
+		}
+	}
+
+	/** Combines nRows lines resampled horizontally into a destination line of n elements,
+	where step is the number of elements from a pixel to the next one of nCh channels.
+	isBounded tells that the horizontal weights are not negative, so the lines are within the
+	range of T scaled by the weights.
+
+	Two and four lines are combined at once, and more lines are accumulated one by one in
+	acc, so every loop runs over continuous elements and is vectorized by the compiler. */
+	template <typename T, typename W, typename B, typename A>
+	void ResampleColumns(const B *const *rows, const W *w, ::size_t nRows, ::size_t n,
+		A *acc, T *dst, ::size_t step, ::size_t nCh, bool /*isBounded*/)
 	{
-		if (roiSrc.size.width == imgSrc.size.width && roiSrc.size.height == imgSrc.size.height)
-		//if (roiSrc.size == imgSrc.size)
-		//if (roiSrc.Fit(imgSrc.size.width, imgSrc.size.height))
-			Resize(imgSrc, zm, imgDst, interp);
+		const bool isContinuous = step == nCh;
+		T *q = isContinuous ? dst : nullptr;
+		if (nRows == 2 && isContinuous)
+		{
+			const A w0 = static_cast<A>(w[0]), w1 = static_cast<A>(w[1]);
+			const B *r0 = rows[0], *r1 = rows[1];
+			for (::size_t I = 0; I != n; ++I)
+				q[I] = ResampleTraits<T>::Cast(w0 * static_cast<A>(r0[I]) +
+					w1 * static_cast<A>(r1[I]));
+			return;
+		}
+		if (nRows == 4 && isContinuous)
+		{
+			const A w0 = static_cast<A>(w[0]), w1 = static_cast<A>(w[1]);
+			const A w2 = static_cast<A>(w[2]), w3 = static_cast<A>(w[3]);
+			const B *r0 = rows[0], *r1 = rows[1], *r2 = rows[2], *r3 = rows[3];
+			for (::size_t I = 0; I != n; ++I)
+				q[I] = ResampleTraits<T>::Cast(w0 * static_cast<A>(r0[I]) +
+					w1 * static_cast<A>(r1[I]) + w2 * static_cast<A>(r2[I]) +
+					w3 * static_cast<A>(r3[I]));
+			return;
+		}
+
+		const A w0 = static_cast<A>(w[0]);
+		const B *row0 = rows[0];
+		for (::size_t I = 0; I != n; ++I)
+			acc[I] = w0 * static_cast<A>(row0[I]);
+		for (::size_t K = 1; K != nRows; ++K)
+		{
+			const A wk = static_cast<A>(w[K]);
+			if (wk == 0)
+				continue;
+			const B *row = rows[K];
+			for (::size_t I = 0; I != n; ++I)
+				acc[I] += wk * static_cast<A>(row[I]);
+		}
+
+		if (isContinuous)
+		{
+			for (::size_t I = 0; I != n; ++I)
+				dst[I] = ResampleTraits<T>::Cast(acc[I]);
+		}
 		else
 		{
-			// Resize destination image.
-			Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roiDst =
-				roiSrc * zm;
-			imgDst.resize(roiDst.size.width, roiDst.size.height, imgSrc.size.depth);
-			imgDst.format = imgSrc.format;
+			for (::size_t I = 0; I != n; I += nCh, dst += step)
+				for (::size_t C = 0; C != nCh; ++C)
+					dst[C] = ResampleTraits<T>::Cast(acc[I + C]);
+		}
+	}
+
+#if defined(IMAGING_SSE2)
+	/** Combines float lines by 4 elements at once without the accumulator. */
+	inline void ResampleColumns(const float *const *rows, const float *w, ::size_t nRows,
+		::size_t n, float *acc, float *dst, ::size_t step, ::size_t nCh, bool isBounded)
+	{
+		if (step != nCh)
+		{
+			ResampleColumns<float, float, float, float>(rows, w, nRows, n, acc, dst, step, nCh,
+				isBounded);
+			return;
+		}
+
+		::size_t I = 0;
+		for (; I + 4 <= n; I += 4)
+		{
+			__m128 sum = _mm_mul_ps(_mm_set1_ps(w[0]), _mm_loadu_ps(rows[0] + I));
+			for (::size_t K = 1; K != nRows; ++K)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(w[K]), _mm_loadu_ps(rows[K] + I)));
+			_mm_storeu_ps(dst + I, sum);
+		}
+		for (; I != n; ++I)
+		{
+			float sum = 0.0f;
+			for (::size_t K = 0; K != nRows; ++K)
+				sum += w[K] * rows[K][I];
+			dst[I] = sum;
+		}
+	}
+
+	/** Combines two bounded lines of 8-bit elements by _mm_madd_epi16(), where 4 fraction
+	bits of the lines are dropped so that an element fits in 16 bits. The remaining
+	elements are computed in the same way, so the result does not depend on the layout. */
+	inline void ResampleColumns(const int *const *rows, const int *w, ::size_t nRows,
+		::size_t n, int *acc, unsigned char *dst, ::size_t step, ::size_t nCh, bool isBounded)
+	{
+		if (nRows != 2 || step != nCh || !isBounded)
+		{
+			ResampleColumns<unsigned char, int, int, int>(rows, w, nRows, n, acc, dst, step, nCh,
+				isBounded);
+			return;
+		}
+
+		const int nShift = 2 * RESAMPLE_COEF_BITS - 4;
+		const int *r0 = rows[0], *r1 = rows[1];
+		const __m128i weights = _mm_set1_epi32((w[1] << 16) | (w[0] & 0xFFFF));
+		const __m128i half = _mm_set1_epi32(1 << (nShift - 1));
+		::size_t I = 0;
+		for (; I + 8 <= n; I += 8)
+		{
+			const __m128i a = _mm_packs_epi32(
+				_mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(r0 + I)), 4),
+				_mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(r0 + I + 4)), 4));
+			const __m128i b = _mm_packs_epi32(
+				_mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(r1 + I)), 4),
+				_mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(r1 + I + 4)), 4));
+			const __m128i lo = _mm_srai_epi32(_mm_add_epi32(
+				_mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights), half), nShift);
+			const __m128i hi = _mm_srai_epi32(_mm_add_epi32(
+				_mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights), half), nShift);
+			const __m128i v = _mm_packs_epi32(lo, hi);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(dst + I), _mm_packus_epi16(v, v));
+		}
+		for (; I != n; ++I)
+		{
+			const int v = ((r0[I] >> 4) * w[0] + (r1[I] >> 4) * w[1] + (1 << (nShift - 1))) >>
+				nShift;
+			dst[I] = static_cast<unsigned char>(std::min(std::max(v, 0), 255));
+		}
+	}
+#endif
 
-			// Create a temporary image for given source ROI to create OpenCV Mat objects.
-			Image<T> imgTemp;
-			Copy(imgSrc, roiSrc, imgTemp);
+	template <typename T>
+	void Resize(const ImageView<const T> &src, const ImageView<T> &dst, Interpolation interp)
+	{
+		ThreadBuffer<ResizePlanCache<T> > cache;
+		cache->GetPlan(Size2D< ::size_t>(src.size.width, src.size.height),
+			Size2D< ::size_t>(dst.size.width, dst.size.height), interp).Execute(src, dst);
+	}
+
+	template <typename T>
+	void Resize(const ImageView<T> &src, const ImageView<T> &dst, Interpolation interp)
+	{
+		Resize(ImageView<const T>(src), dst, interp);
+	}
+
+	/** The destination rows are divided into bands, and a band is resampled by a task.
+	A task keeps the source rows resampled horizontally in a ring of nTaps rows for each
+	plane, i.e., a channel of BSQ and BIL, or all channels of BIP, where source row r is
+	kept in slot r % nTaps. The rows of a destination row are nTaps consecutive rows, so
+	they never share a slot, and a row is resampled once unless the bands overlap. */
+	template <typename T>
+	void Resample(const ImageView<const T> &src, const ImageView<T> &dst,
+		const ResampleAxis<typename ResampleTraits<T>::WeightType> &axisX,
+		const ResampleAxis<typename ResampleTraits<T>::WeightType> &axisY)
+	{
+		typedef typename ResampleTraits<T>::WeightType W;
+		typedef typename ResampleTraits<T>::BufferType B;
+
+		if (src.format != dst.format || src.size.depth != dst.size.depth)
+		{
+			std::ostringstream errMsg;
+			errMsg << "A view of format " << static_cast<int>(src.format) << " and " <<
+				src.size.depth << " channels cannot be resized to a view of format " <<
+				static_cast<int>(dst.format) << " and " << dst.size.depth << " channels.";
+			throw std::invalid_argument(errMsg.str());
+		}
+		if (axisX.indices.size() != dst.size.width * axisX.nTaps ||
+			axisY.indices.size() != dst.size.height * axisY.nTaps)
+			throw std::invalid_argument("The taps are not matched with the destination.");
+		const ::size_t width = dst.size.width;
+		const ::size_t height = dst.size.height;
+		if (width == 0 || height == 0 || dst.size.depth == 0)
+			return;
 
-			// Prepare temporary OpenCV Mat objects without memory allocation.
-			cv::Mat cvSrc(SafeCast_<int>(imgTemp.size.height), SafeCast_<int>(imgTemp.size.width),
-				GetOpenCvType<T>(imgTemp.size.depth), imgTemp.GetPointer(0, 0));
-			cv::Mat cvDst(SafeCast_<int>(imgDst.size.height), SafeCast_<int>(imgDst.size.width),
-				GetOpenCvType<T>(imgDst.size.depth), imgDst.GetPointer(0, 0));
+		const bool isBip = src.format == ImageFormat::BIP;
+		const ::size_t nPlanes = isBip ? 1 : src.size.depth;
+		const ::size_t nCh = isBip ? src.size.depth : 1;
+		const ::size_t nElemLine = width * nCh;
+		const ::size_t nBands = nElemLine * nPlanes * height * sizeof(T) <
+			PARALLEL_RESAMPLE_THRESHOLD ? 1 : std::min(height, 4 * GetThreadCount());
 
-			cv::resize(cvSrc, cvDst, cvDst.size(), zm.x, zm.y, static_cast<int>(interp));
+		// Nearest neighbor copies source elements, or the previous destination row if it
+		// comes from the same source row. The pixels of a view of some channels of an
+		// image are copied one by one, so the other channels between them are kept.
+		if (axisX.nTaps == 1 && axisY.nTaps == 1)
+		{
+			ParallelFor(0, nBands, [&](::size_t N)
+			{
+				const ::size_t H0 = height * N / nBands;
+				for (::size_t H = H0; H != height * (N + 1) / nBands; ++H)
+					for (::size_t P = 0; P != nPlanes; ++P)
+					{
+						T *lineDst = dst.GetPointer(0, H, P);
+						if (H != H0 && axisY.indices[H] == axisY.indices[H - 1])
+						{
+							const T *linePrev = lineDst - dst.step.y;
+							if (dst.step.x == nCh)
+								CopyLines(linePrev, nElemLine, lineDst, nElemLine,
+									nElemLine, 1);
+							else
+								CopyLines(linePrev, dst.step.x, lineDst, dst.step.x,
+									nCh, width);
+						}
+						else
+							SampleRow(src.GetPointer(0, axisY.indices[H], P), src.step.x, nCh,
+								axisX.indices.data(), width, lineDst, dst.step.x);
+					}
+			}, 1);
+			return;
 		}
+
+		const ::size_t nRows = axisY.nTaps;
+		const bool isBounded = std::find_if(axisX.weights.begin(), axisX.weights.end(),
+			[](W w) { return w < 0; }) == axisX.weights.end();
+		ParallelFor(0, nBands, [&](::size_t N)
+		{
+			ThreadBuffer<ResampleLines<T> > lines;
+			std::vector<B> &rows = lines->rows;
+			std::vector< ::size_t> &tags = lines->tags;
+			rows.resize(nPlanes * nRows * nElemLine);
+			tags.assign(nPlanes * nRows, static_cast< ::size_t>(-1));
+			lines->acc.resize(nElemLine);
+			lines->taps.resize(nRows);
+			for (::size_t H = height * N / nBands; H != height * (N + 1) / nBands; ++H)
+			{
+				const ::size_t *idxY = &axisY.indices[H * nRows];
+				const W *wY = &axisY.weights[H * nRows];
+				for (::size_t P = 0; P != nPlanes; ++P)
+				{
+					for (::size_t K = 0; K != nRows; ++K)
+					{
+						const ::size_t R = idxY[K];
+						const ::size_t slot = P * nRows + R % nRows;
+						B *row = &rows[slot * nElemLine];
+						if (tags[slot] != R)
+						{
+							ResampleRow(src.GetPointer(0, R, P), src.step.x, nCh, axisX, width,
+								row);
+							tags[slot] = R;
+						}
+						lines->taps[K] = row;
+					}
+					ResampleColumns(lines->taps.data(), wY, nRows, nElemLine,
+						lines->acc.data(), dst.GetPointer(0, H, P), dst.step.x, nCh, isBounded);
+				}
+			}
+		}, 1);
 	}
 
-	/** The internal interpolation logic calls an OpenCV function, and this function creates
-	a temporary OpenCV Mat objects from existing images without memory allocation. */
 	template <typename T>
-	void Resize(Image<T> &imgSrc,const Point2D<double> &zm, Image<T> &imgDst,
+	void Resize(const Image<T> &imgSrc,
+		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
+		const Point2D<double> &zm, Image<T> &imgDst, Interpolation interp)
+	{
+		Resize(imgSrc.GetView(roiSrc), zm, imgDst, interp);
+	}
+
+	template <typename T>
+	void Resize(const Image<T> &imgSrc,
+		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> &roiSrc,
+		const Point2D<double> &zm, Image<T> &imgDst,
+		const Point2D<typename Image<T>::SizeType> &orgnDst, Interpolation interp)
+	{
+		const Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roiDst(orgnDst,
+			(roiSrc * zm).size);
+		Resize(imgSrc.GetView(roiSrc), imgDst.GetView(roiDst), interp);
+	}
+
+	template <typename T>
+	void Resize(const Image<T> &imgSrc, const Point2D<double> &zm, Image<T> &imgDst,
+		Interpolation interp)
+	{
+		Resize(imgSrc.GetView(), zm, imgDst, interp);
+	}
+
+	/** The destination image takes the format of the source view, and the source ROI is
+	resampled in place without copying it. */
+	template <typename T>
+	void Resize(const ImageView<const T> &src, const Point2D<double> &zm, Image<T> &imgDst,
 		Interpolation interp)
 	{
 		// Resize destination image.
 		Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roiDst =
-			imgSrc.GetRoi() * zm;
-		imgDst.resize(roiDst.size.width, roiDst.size.height, imgSrc.size.depth);
-		imgDst.format = imgSrc.format;
-
-		// Prepare temporary OpenCV Mat objects without memory allocation.
-		cv::Mat cvDst(SafeCast_<int>(imgDst.size.height), SafeCast_<int>(imgDst.size.width),
-			GetOpenCvType<T>(imgDst.size.depth), imgDst.GetPointer(0, 0));
-		cv::Mat cvSrc(SafeCast_<int>(imgSrc.size.height), SafeCast_<int>(imgSrc.size.width),
-			GetOpenCvType<T>(imgSrc.size.depth), imgSrc.GetPointer(0, 0));
+			src.GetRoi() * zm;
+		imgDst.SetFormat(src.format);
+		imgDst.resize(Size3D<typename Image<T>::SizeType>(roiDst.size.width,
+			roiDst.size.height, src.size.depth), ResizeMode::UNINITIALIZED);
 
-		cv::resize(cvSrc, cvDst, cvDst.size(), zm.x, zm.y, static_cast<int>(interp));
+		Resize(src, imgDst.GetView(), interp);
 	}
 
+	template <typename T>
+	void Resize(const ImageView<T> &src, const Point2D<double> &zm, Image<T> &imgDst,
+		Interpolation interp)
+	{
+		Resize(ImageView<const T>(src), zm, imgDst, interp);
+	}
 }
 #endif
@@ -0,0 +1,196 @@
+#if !defined(IMAGE_PYRAMID_H)
+#define IMAGE_PYRAMID_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "image.h"
+
+namespace Imaging
+{
+	/** The kernel to halve a level of a pyramid.
+
+	BOX averages 2 x 2 pixels, and GAUSSIAN weights 4 x 4 pixels by the binomial kernel
+	(1, 3, 3, 1) / 8 on each axis. Both kernels are centered at the same point, so the
+	levels of both filters are aligned in the same way. */
+	enum class PyramidFilter {BOX, GAUSSIAN};
+
+	/** Selects the type to sum the pixels of a kernel for an element type.
+
+	Floating-point elements are summed in double except float which is summed in float. */
+	template <typename T>
+	struct PyramidTraits
+	{
+		typedef double AccumType;
+
+		/** Divides a sum by 2^nBits, and rounds it for integers. */
+		static T Cast(AccumType sum, int nBits);
+	};
+
+	template <>
+	struct PyramidTraits<float>
+	{
+		typedef float AccumType;
+
+		static float Cast(AccumType sum, int nBits);
+	};
+
+	/** Integers are summed in A without overflow, and rounded by shifting the sum. */
+	template <typename T, typename A>
+	struct IntegerPyramidTraits
+	{
+		typedef A AccumType;
+
+		static T Cast(AccumType sum, int nBits);
+	};
+
+	template <>
+	struct PyramidTraits<unsigned char> :
+		public IntegerPyramidTraits<unsigned char, int> {};
+
+	template <>
+	struct PyramidTraits<signed char> : public IntegerPyramidTraits<signed char, int> {};
+
+	template <>
+	struct PyramidTraits<unsigned short> :
+		public IntegerPyramidTraits<unsigned short, int> {};
+
+	template <>
+	struct PyramidTraits<short> : public IntegerPyramidTraits<short, int> {};
+
+	template <>
+	struct PyramidTraits<unsigned int> :
+		public IntegerPyramidTraits<unsigned int, long long> {};
+
+	template <>
+	struct PyramidTraits<int> : public IntegerPyramidTraits<int, long long> {};
+
+	/** Presents a multi-resolution pyramid of an image, where level 0 is a copy of the
+	image and each level is the previous level halved by a PyramidFilter, until both sides
+	are 1 pixel.
+
+	All levels are stored in a single memory block in the image format of the source, and
+	each level is accessed by a view. A level is built tile by tile in parallel by the
+	shared thread pool, and only the tiles overlapping a changed region are built again by
+	Update(), so a viewer draws any zoom by reading the visible pixels of a level. */
+	template <typename T>
+	class ImagePyramid
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef std::vector<T, AlignedAllocator<T> > Container;
+		typedef typename Container::size_type SizeType;
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		ImagePyramid(void);
+		ImagePyramid(const ImagePyramid<T> &src);
+		ImagePyramid<T> &operator=(const ImagePyramid<T> &src);
+
+		/** Moves image data without copying it. The source pyramid becomes empty. */
+		ImagePyramid(ImagePyramid<T> &&src) IMAGING_NOEXCEPT;
+		ImagePyramid<T> &operator=(ImagePyramid<T> &&src) IMAGING_NOEXCEPT;
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** Builds the pyramid of a view. See Build(). */
+		explicit ImagePyramid(const ImageView<const T> &src, SizeType nLevels = 0,
+			PyramidFilter filter = PyramidFilter::BOX);
+
+		//////////////////////////////////////////////////
+		// Accessors.
+
+		/** Accesses a level by a view without copying data.
+
+		@exception std::out_of_range	if the level is out of range */
+		ImageView<T> operator[](SizeType level);
+		ImageView<const T> operator[](SizeType level) const;
+
+		const Container &data;
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** Builds all levels from an image, e.g., a view of an Image<T> or an
+		ImageFrame<T>. nLevels limits the number of levels including level 0, where zero
+		means all levels. The memory is reused if the levels have the same sizes. */
+		void Build(const ImageView<const T> &src, SizeType nLevels = 0,
+			PyramidFilter filter = PyramidFilter::BOX);
+		void Build(const ImageView<T> &src, SizeType nLevels = 0,
+			PyramidFilter filter = PyramidFilter::BOX);
+
+		/** Copies a changed ROI of the image into level 0, and builds the regions of the
+		other levels depending on the ROI again.
+
+		@exception std::invalid_argument	if the image has a different size or format
+		from level 0 */
+		void Update(const ImageView<const T> &src, const Region<SizeType, SizeType> &roi);
+		void Update(const ImageView<T> &src, const Region<SizeType, SizeType> &roi);
+
+		void Clear(void);
+
+		/** Exchanges image data with another pyramid without copying it. */
+		void Swap(ImagePyramid<T> &rhs) IMAGING_NOEXCEPT;
+
+		SizeType GetLevelCount(void) const;
+		PyramidFilter GetFilter(void) const;
+
+		/** Returns the level to draw the image zoomed by zm, i.e., the smallest level
+		which is not smaller than the zoomed image.
+
+		@exception std::invalid_argument	if zm is not positive */
+		SizeType GetLevel(double zm) const;
+
+		/** Returns the region of a level covering an ROI of level 0. */
+		Region<SizeType, SizeType> GetLevelRegion(const Region<SizeType, SizeType> &roi,
+			SizeType level) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** Returns the region of a level which depends on an ROI of the previous level. */
+		Region<SizeType, SizeType> GetDependentRegion(const Region<SizeType, SizeType> &roi,
+			SizeType level) const;
+
+		/** Builds an ROI of a level from the previous level. */
+		void Reduce(SizeType level, const Region<SizeType, SizeType> &roi);
+
+		//////////////////////////////////////////////////
+		// Data.
+		Container data_;
+		std::vector<Size3D<SizeType> > sizes_;
+		std::vector<SizeType> offsets_;
+		ImageFormat format_;
+		PyramidFilter filter_;
+	};
+
+	template <typename T>
+	void swap(ImagePyramid<T> &a, ImagePyramid<T> &b);
+
+	/** Halves a row of pixels of nCh interleaved channels into [x0, x1) of a destination
+	row, where rows are 2 source rows for BOX or 4 source rows for GAUSSIAN, and step is the
+	number of elements from a pixel to the next one. */
+	template <typename T>
+	void DecimateRow(const T *const *rows, ::size_t stepSrc, ::size_t nCh, ::size_t wLast,
+		::size_t x0, ::size_t x1, T *dst, ::size_t stepDst, PyramidFilter filter);
+
+	/** Halves a view into an ROI of another view, where destination pixel (x, y) is
+	computed from the source pixels around (2x + 0.5, 2y + 0.5) by a filter, and the
+	source pixels out of the view are clamped to the border.
+
+	Both views must have the same format and number of channels, and the destination
+	must be a half of the source rounded up. */
+	template <typename T>
+	void Decimate(const ImageView<const T> &src, const ImageView<T> &dst,
+		const Region< ::size_t, ::size_t> &roiDst, PyramidFilter filter);
+}
+
+#include "image_pyramid_inl.h"
+
+#endif
@@ -0,0 +1,378 @@
+#if !defined(IMAGE_PYRAMID_INL_H)
+#define IMAGE_PYRAMID_INL_H
+
+namespace Imaging
+{
+	//////////////////////////////////////////////////////////////////////////
+	// PyramidTraits<T> struct
+
+	template <typename T>
+	T PyramidTraits<T>::Cast(AccumType sum, int nBits)
+	{
+		const AccumType value = sum / static_cast<AccumType>(1 << nBits);
+		if (std::numeric_limits<T>::is_integer)
+			return static_cast<T>(std::floor(value + 0.5));
+		return static_cast<T>(value);
+	}
+
+	inline float PyramidTraits<float>::Cast(AccumType sum, int nBits)
+	{
+		return sum * (1.0f / (1 << nBits));
+	}
+
+	template <typename T, typename A>
+	T IntegerPyramidTraits<T, A>::Cast(AccumType sum, int nBits)
+	{
+		return static_cast<T>((sum + (static_cast<A>(1) << (nBits - 1))) >> nBits);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ImagePyramid<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T>
+	ImagePyramid<T>::ImagePyramid(void) : data(data_), format_(ImageFormat::BIP),
+		filter_(PyramidFilter::BOX) {}
+
+	template <typename T>
+	ImagePyramid<T>::ImagePyramid(const ImagePyramid<T> &src) : data(data_),
+		data_(src.data_), sizes_(src.sizes_), offsets_(src.offsets_), format_(src.format_),
+		filter_(src.filter_) {}
+
+	template <typename T>
+	ImagePyramid<T> &ImagePyramid<T>::operator=(const ImagePyramid<T> &src)
+	{
+		this->data_ = src.data_;
+		this->sizes_ = src.sizes_;
+		this->offsets_ = src.offsets_;
+		this->format_ = src.format_;
+		this->filter_ = src.filter_;
+		return *this;
+	}
+
+	template <typename T>
+	ImagePyramid<T>::ImagePyramid(ImagePyramid<T> &&src) IMAGING_NOEXCEPT : data(data_),
+		data_(std::move(src.data_)), sizes_(std::move(src.sizes_)),
+		offsets_(std::move(src.offsets_)), format_(src.format_), filter_(src.filter_)
+	{
+		src.Clear();
+	}
+
+	template <typename T>
+	ImagePyramid<T> &ImagePyramid<T>::operator=(ImagePyramid<T> &&src) IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->data_ = std::move(src.data_);
+			this->sizes_ = std::move(src.sizes_);
+			this->offsets_ = std::move(src.offsets_);
+			this->format_ = src.format_;
+			this->filter_ = src.filter_;
+			src.Clear();
+		}
+		return *this;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	template <typename T>
+	ImagePyramid<T>::ImagePyramid(const ImageView<const T> &src, SizeType nLevels,
+		PyramidFilter filter) : data(data_), format_(ImageFormat::BIP),
+		filter_(PyramidFilter::BOX)
+	{
+		this->Build(src, nLevels, filter);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+
+	/** A line of a level is a row of pixels for BIP, and a row of a channel for BSQ and
+	BIL, without padding elements. */
+	template <typename T>
+	ImageView<T> ImagePyramid<T>::operator[](SizeType level)
+	{
+		if (level >= this->sizes_.size())
+		{
+			std::ostringstream errMsg;
+			errMsg << "Level " << level << " is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+		const Size3D<SizeType> &sz = this->sizes_[level];
+		return ImageView<T>(this->data_.data() + this->offsets_[level], sz, this->format_,
+			this->format_ == ImageFormat::BIP ? sz.width * sz.depth : sz.width);
+	}
+
+	template <typename T>
+	ImageView<const T> ImagePyramid<T>::operator[](SizeType level) const
+	{
+		return const_cast<ImagePyramid<T> *>(this)->operator[](level);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	/** Every level starts at a multiple of DEFAULT_ALIGNMENT bytes in the block. */
+	template <typename T>
+	void ImagePyramid<T>::Build(const ImageView<const T> &src, SizeType nLevels,
+		PyramidFilter filter)
+	{
+		const SizeType nElemAlign = std::max<SizeType>(DEFAULT_ALIGNMENT / sizeof(T), 1);
+		this->sizes_.clear();
+		this->offsets_.clear();
+		Size3D<SizeType> sz = src.size;
+		SizeType nElem = 0;
+		for (;;)
+		{
+			this->sizes_.push_back(sz);
+			this->offsets_.push_back(nElem);
+			nElem += (sz.width * sz.height * sz.depth + nElemAlign - 1) / nElemAlign *
+				nElemAlign;
+			if ((sz.width <= 1 && sz.height <= 1) || this->sizes_.size() == nLevels)
+				break;
+			sz = Size3D<SizeType>((sz.width + 1) / 2, (sz.height + 1) / 2, sz.depth);
+		}
+		if (this->data_.size() != nElem)
+			this->data_.resize(nElem);
+		this->format_ = src.format;
+		this->filter_ = filter;
+
+		Copy(src, (*this)[0]);
+		for (SizeType L = 1; L < this->sizes_.size(); ++L)
+			this->Reduce(L, Region<SizeType, SizeType>(0, 0, this->sizes_[L].width,
+				this->sizes_[L].height));
+	}
+
+	template <typename T>
+	void ImagePyramid<T>::Build(const ImageView<T> &src, SizeType nLevels,
+		PyramidFilter filter)
+	{
+		this->Build(ImageView<const T>(src), nLevels, filter);
+	}
+
+	template <typename T>
+	void ImagePyramid<T>::Update(const ImageView<const T> &src,
+		const Region<SizeType, SizeType> &roi)
+	{
+		if (this->sizes_.empty() || src.size != this->sizes_[0] ||
+			src.format != this->format_)
+		{
+			std::ostringstream errMsg;
+			errMsg << "An image of " << src.size.width << " x " << src.size.height << " x " <<
+				src.size.depth << " and format " << static_cast<int>(src.format) <<
+				" is not the image of the pyramid.";
+			throw std::invalid_argument(errMsg.str());
+		}
+
+		Region<SizeType, SizeType> roiLevel = roi;
+		roiLevel.Clip(src.size.width, src.size.height);
+		if (roiLevel.IsEmpty())
+			return;
+		Copy(src.GetView(roiLevel), (*this)[0].GetView(roiLevel));
+		for (SizeType L = 1; L < this->sizes_.size(); ++L)
+		{
+			roiLevel = this->GetDependentRegion(roiLevel, L);
+			this->Reduce(L, roiLevel);
+		}
+	}
+
+	template <typename T>
+	void ImagePyramid<T>::Update(const ImageView<T> &src,
+		const Region<SizeType, SizeType> &roi)
+	{
+		this->Update(ImageView<const T>(src), roi);
+	}
+
+	template <typename T>
+	void ImagePyramid<T>::Clear(void)
+	{
+		this->data_.clear();
+		this->sizes_.clear();
+		this->offsets_.clear();
+	}
+
+	template <typename T>
+	void ImagePyramid<T>::Swap(ImagePyramid<T> &rhs) IMAGING_NOEXCEPT
+	{
+		this->data_.swap(rhs.data_);
+		this->sizes_.swap(rhs.sizes_);
+		this->offsets_.swap(rhs.offsets_);
+		std::swap(this->format_, rhs.format_);
+		std::swap(this->filter_, rhs.filter_);
+	}
+
+	template <typename T>
+	typename ImagePyramid<T>::SizeType ImagePyramid<T>::GetLevelCount(void) const
+	{
+		return this->sizes_.size();
+	}
+
+	template <typename T>
+	PyramidFilter ImagePyramid<T>::GetFilter(void) const
+	{
+		return this->filter_;
+	}
+
+	template <typename T>
+	typename ImagePyramid<T>::SizeType ImagePyramid<T>::GetLevel(double zm) const
+	{
+		if (!(zm > 0.0))
+		{
+			std::ostringstream errMsg;
+			errMsg << "Zoom " << zm << " is not positive.";
+			throw std::invalid_argument(errMsg.str());
+		}
+		if (zm >= 1.0 || this->sizes_.empty())
+			return 0;
+
+		// A small margin keeps an exact power of 2 at its own level.
+		const SizeType level = static_cast<SizeType>(std::floor(std::log(1.0 / zm) /
+			std::log(2.0) + 1e-9));
+		return std::min(level, this->sizes_.size() - 1);
+	}
+
+	template <typename T>
+	Region<typename ImagePyramid<T>::SizeType, typename ImagePyramid<T>::SizeType>
+		ImagePyramid<T>::GetLevelRegion(const Region<SizeType, SizeType> &roi,
+		SizeType level) const
+	{
+		if (level >= this->sizes_.size())
+		{
+			std::ostringstream errMsg;
+			errMsg << "Level " << level << " is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+		if (roi.IsEmpty())
+			return Region<SizeType, SizeType>(roi.origin.x >> level, roi.origin.y >> level,
+				0, 0);
+
+		const SizeType x0 = roi.origin.x >> level, y0 = roi.origin.y >> level;
+		const SizeType x1 = ((roi.origin.x + roi.size.width - 1) >> level) + 1;
+		const SizeType y1 = ((roi.origin.y + roi.size.height - 1) >> level) + 1;
+		Region<SizeType, SizeType> roiLevel(x0, y0, x1 - x0, y1 - y0);
+		roiLevel.Clip(this->sizes_[level].width, this->sizes_[level].height);
+		return roiLevel;
+	}
+
+	/** Destination pixel x reads source pixels 2x and 2x + 1 by BOX, and 2x - 1 to 2x + 2
+	by GAUSSIAN. */
+	template <typename T>
+	Region<typename ImagePyramid<T>::SizeType, typename ImagePyramid<T>::SizeType>
+		ImagePyramid<T>::GetDependentRegion(const Region<SizeType, SizeType> &roi,
+		SizeType level) const
+	{
+		const SizeType x1 = roi.origin.x + roi.size.width;
+		const SizeType y1 = roi.origin.y + roi.size.height;
+		Region<SizeType, SizeType> roiLevel;
+		if (this->filter_ == PyramidFilter::BOX)
+			roiLevel = Region<SizeType, SizeType>(roi.origin.x / 2, roi.origin.y / 2,
+				(x1 - 1) / 2 + 1 - roi.origin.x / 2, (y1 - 1) / 2 + 1 - roi.origin.y / 2);
+		else
+		{
+			const SizeType x0 = roi.origin.x != 0 ? (roi.origin.x - 1) / 2 : 0;
+			const SizeType y0 = roi.origin.y != 0 ? (roi.origin.y - 1) / 2 : 0;
+			roiLevel = Region<SizeType, SizeType>(x0, y0, x1 / 2 + 1 - x0, y1 / 2 + 1 - y0);
+		}
+		roiLevel.Clip(this->sizes_[level].width, this->sizes_[level].height);
+		return roiLevel;
+	}
+
+	/** A tile reads 2 x 2 source pixels for each pixel, so the tile size is chosen for
+	4 pixels of the source and a pixel of the destination. */
+	template <typename T>
+	void ImagePyramid<T>::Reduce(SizeType level, const Region<SizeType, SizeType> &roi)
+	{
+		if (roi.IsEmpty())
+			return;
+
+		const ImageView<const T> src = (*this)[level - 1];
+		const ImageView<T> dst = (*this)[level];
+		const PyramidFilter filter = this->filter_;
+		const Size2D<SizeType> tileSize = GetCacheTileSize(roi.size,
+			5 * dst.size.depth * sizeof(T));
+		ParallelFor(roi, tileSize, [&](const Region<SizeType, SizeType> &tile)
+		{
+			Decimate(src, dst, tile, filter);
+		});
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	template <typename T>
+	void swap(ImagePyramid<T> &a, ImagePyramid<T> &b)
+	{
+		a.Swap(b);
+	}
+
+	/** The pixels are read by offsets clamped at the right border, so the loop over the
+	channels runs over continuous elements. */
+	template <typename T>
+	void DecimateRow(const T *const *rows, ::size_t stepSrc, ::size_t nCh, ::size_t wLast,
+		::size_t x0, ::size_t x1, T *dst, ::size_t stepDst, PyramidFilter filter)
+	{
+		typedef typename PyramidTraits<T>::AccumType A;
+
+		if (filter == PyramidFilter::BOX)
+		{
+			const T *r0 = rows[0], *r1 = rows[1];
+			for (::size_t W = x0; W != x1; ++W, dst += stepDst)
+			{
+				const ::size_t a = 2 * W * stepSrc;
+				const ::size_t b = std::min(2 * W + 1, wLast) * stepSrc;
+				for (::size_t C = 0; C != nCh; ++C)
+					dst[C] = PyramidTraits<T>::Cast(static_cast<A>(r0[a + C]) + r0[b + C] +
+						r1[a + C] + r1[b + C], 2);
+			}
+			return;
+		}
+
+		for (::size_t W = x0; W != x1; ++W, dst += stepDst)
+		{
+			::size_t s[4];
+			for (::size_t K = 0; K != 4; ++K)
+				s[K] = (2 * W + K != 0 ? std::min(2 * W + K - 1, wLast) : 0) * stepSrc;
+			for (::size_t C = 0; C != nCh; ++C)
+			{
+				A sum[4];
+				for (::size_t K = 0; K != 4; ++K)
+				{
+					const T *r = rows[K] + C;
+					sum[K] = static_cast<A>(r[s[0]]) + r[s[3]] + 3 * (static_cast<A>(r[s[1]]) +
+						r[s[2]]);
+				}
+				dst[C] = PyramidTraits<T>::Cast(sum[0] + sum[3] + 3 * (sum[1] + sum[2]), 6);
+			}
+		}
+	}
+
+	template <typename T>
+	void Decimate(const ImageView<const T> &src, const ImageView<T> &dst,
+		const Region< ::size_t, ::size_t> &roiDst, PyramidFilter filter)
+	{
+		const bool isBip = src.format == ImageFormat::BIP;
+		const ::size_t nPlanes = isBip ? 1 : src.size.depth;
+		const ::size_t nCh = isBip ? src.size.depth : 1;
+		const ::size_t wLast = src.size.width - 1, hLast = src.size.height - 1;
+		const ::size_t x0 = roiDst.origin.x, x1 = x0 + roiDst.size.width;
+		const ::size_t y0 = roiDst.origin.y, y1 = y0 + roiDst.size.height;
+
+		// BOX reads rows 2y and 2y + 1, and GAUSSIAN reads rows 2y - 1 to 2y + 2.
+		const ::size_t nRows = filter == PyramidFilter::BOX ? 2 : 4;
+		const ::size_t offset = filter == PyramidFilter::BOX ? 0 : 1;
+		const T *rows[4];
+		for (::size_t P = 0; P != nPlanes; ++P)
+			for (::size_t H = y0; H != y1; ++H)
+			{
+				for (::size_t K = 0; K != nRows; ++K)
+				{
+					const ::size_t R = 2 * H + K >= offset ? 2 * H + K - offset : 0;
+					rows[K] = src.GetPointer(0, std::min(R, hLast), P);
+				}
+				DecimateRow(rows, src.step.x, nCh, wLast, x0, x1, dst.GetPointer(x0, H, P),
+					dst.step.x, filter);
+			}
+	}
+}
+
+#endif
@@ -0,0 +1,190 @@
+#if !defined(IMAGE_RANGE_H)
+#define IMAGE_RANGE_H
+
+#include <iterator>
+
+#include "image.h"
+
+namespace Imaging
+{
+	/** Presents a continuous sequence of elements, e.g., a line of an image or a pixel of
+	a BIP image, without owning the data.
+
+	The member functions follow the naming of the standard containers, so a span can be
+	used with range-based for loops and the standard algorithms.
+	Use Span<const T> for read-only data. */
+	template <typename T>
+	class Span
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef T value_type;
+		typedef ::size_t size_type;
+		typedef T *iterator;
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		Span(void);
+
+		/** Converts a span of writable data into a span of read-only data. */
+		template <typename U>
+		Span(const Span<U> &src);
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		Span(T *data, size_type n);
+
+		//////////////////////////////////////////////////
+		// Accessors.
+		T &operator[](size_type pos) const;
+		T *data(void) const;
+		T *begin(void) const;
+		T *end(void) const;
+
+		//////////////////////////////////////////////////
+		// Methods.
+		size_type size(void) const;
+		bool empty(void) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Data.
+		T *data_;
+		size_type size_;
+	};
+
+	/** Iterates spans of the same length placed at regular intervals in two levels, e.g.,
+	rows of channels of a BSQ image, or pixels of a row of a BIP image.
+
+	The n-th span starts at (n % nInner) * stepInner + (n / nInner) * stepOuter elements
+	from the first element.
+	This class is a random access iterator, so it can be used with the standard algorithms
+	and divided into partitions for parallel processing.
+	The iterator returns a span by value, so the span itself cannot be modified by the
+	iterator while its elements can be. */
+	template <typename T>
+	class SpanIterator
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef Span<T> value_type;
+		typedef ::ptrdiff_t difference_type;
+		typedef const Span<T> *pointer;
+		typedef Span<T> reference;
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		SpanIterator(void);
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		SpanIterator(T *data, difference_type pos, ::size_t nElem, ::size_t nInner,
+			::size_t stepInner, ::size_t stepOuter);
+
+		//////////////////////////////////////////////////
+		// Operators.
+		Span<T> operator*(void) const;
+		Span<T> operator[](difference_type n) const;
+		SpanIterator<T> &operator++(void);
+		SpanIterator<T> operator++(int);
+		SpanIterator<T> &operator--(void);
+		SpanIterator<T> operator--(int);
+		SpanIterator<T> &operator+=(difference_type n);
+		SpanIterator<T> &operator-=(difference_type n);
+		SpanIterator<T> operator+(difference_type n) const;
+		SpanIterator<T> operator-(difference_type n) const;
+		difference_type operator-(const SpanIterator<T> &rhs) const;
+		bool operator==(const SpanIterator<T> &rhs) const;
+		bool operator!=(const SpanIterator<T> &rhs) const;
+		bool operator<(const SpanIterator<T> &rhs) const;
+		bool operator>(const SpanIterator<T> &rhs) const;
+		bool operator<=(const SpanIterator<T> &rhs) const;
+		bool operator>=(const SpanIterator<T> &rhs) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Data.
+		T *data_;
+		difference_type pos_;
+		::size_t nElem_;
+		::size_t nInner_;
+		::size_t stepInner_;
+		::size_t stepOuter_;
+	};
+
+	template <typename T>
+	SpanIterator<T> operator+(typename SpanIterator<T>::difference_type n,
+		const SpanIterator<T> &it);
+
+	/** Presents a sequence of spans, e.g., lines of an image or pixels of a line.
+
+	See GetLines() and GetPixels(). */
+	template <typename T>
+	class SpanRange
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef SpanIterator<T> iterator;
+		typedef ::size_t size_type;
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		SpanRange(void);
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		SpanRange(T *data, size_type n, size_type nElem, size_type nInner,
+			size_type stepInner, size_type stepOuter);
+
+		//////////////////////////////////////////////////
+		// Accessors.
+		Span<T> operator[](size_type pos) const;
+		SpanIterator<T> begin(void) const;
+		SpanIterator<T> end(void) const;
+
+		//////////////////////////////////////////////////
+		// Methods.
+		size_type size(void) const;
+		bool empty(void) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Data.
+		SpanIterator<T> begin_;
+		size_type size_;
+	};
+
+	/** Returns all lines of a view as continuous spans in the order of memory.
+
+	A line is a row of pixels for BIP, and a row of a channel for BSQ and BIL, so the i-th
+	line is
+	BIP: row i
+	BSQ: row (i % height) of channel (i / height)
+	BIL: channel (i % depth) of row (i / depth)
+
+	@exception std::logic_error	if the elements of a line are not continuous, e.g., a view
+	with explicit steps skipping pixels */
+	template <typename T, RangeCheck R>
+	SpanRange<T> GetLines(const ImageView<T, R> &view);
+
+	/** Returns pixels of a line of a BIP image, where each pixel is a span of depth
+	channels. */
+	template <typename T>
+	SpanRange<T> GetPixels(const Span<T> &line, ::size_t depth);
+
+	/** Returns pixels of a row of a BIP view.
+
+	@exception std::logic_error	if the view is not BIP
+	@exception std::out_of_range	if the row is out of range */
+	template <typename T, RangeCheck R>
+	SpanRange<T> GetPixels(const ImageView<T, R> &view,
+		typename ImageView<T, R>::SizeType y);
+}
+
+#include "image_range_inl.h"
+
+#endif
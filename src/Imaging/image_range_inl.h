@@ -0,0 +1,318 @@
+#if !defined(IMAGE_RANGE_INL_H)
+#define IMAGE_RANGE_INL_H
+
+namespace Imaging
+{
+	//////////////////////////////////////////////////////////////////////////
+	// Span<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T>
+	Span<T>::Span(void) : data_(nullptr), size_(0) {}
+
+	template <typename T>
+	template <typename U>
+	Span<T>::Span(const Span<U> &src) : data_(src.data()), size_(src.size()) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	template <typename T>
+	Span<T>::Span(T *data, size_type n) : data_(data), size_(n) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+	template <typename T>
+	T &Span<T>::operator[](size_type pos) const
+	{
+		return this->data_[pos];
+	}
+
+	template <typename T>
+	T *Span<T>::data(void) const
+	{
+		return this->data_;
+	}
+
+	template <typename T>
+	T *Span<T>::begin(void) const
+	{
+		return this->data_;
+	}
+
+	template <typename T>
+	T *Span<T>::end(void) const
+	{
+		return this->data_ + this->size_;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+	template <typename T>
+	typename Span<T>::size_type Span<T>::size(void) const
+	{
+		return this->size_;
+	}
+
+	template <typename T>
+	bool Span<T>::empty(void) const
+	{
+		return this->size_ == 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// SpanIterator<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T>
+	SpanIterator<T>::SpanIterator(void) : data_(nullptr), pos_(0), nElem_(0), nInner_(1),
+		stepInner_(0), stepOuter_(0) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	template <typename T>
+	SpanIterator<T>::SpanIterator(T *data, difference_type pos, ::size_t nElem,
+		::size_t nInner, ::size_t stepInner, ::size_t stepOuter) : data_(data), pos_(pos),
+		nElem_(nElem), nInner_(nInner), stepInner_(stepInner), stepOuter_(stepOuter) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Operators.
+
+	// nInner_ is never zero, and pos_ is not negative for any dereferenceable iterator.
+	template <typename T>
+	Span<T> SpanIterator<T>::operator*(void) const
+	{
+		const ::size_t pos = static_cast<::size_t>(this->pos_);
+		return Span<T>(this->data_ + (pos % this->nInner_) * this->stepInner_ +
+			(pos / this->nInner_) * this->stepOuter_, this->nElem_);
+	}
+
+	template <typename T>
+	Span<T> SpanIterator<T>::operator[](difference_type n) const
+	{
+		return *(*this + n);
+	}
+
+	template <typename T>
+	SpanIterator<T> &SpanIterator<T>::operator++(void)
+	{
+		++this->pos_;
+		return *this;
+	}
+
+	template <typename T>
+	SpanIterator<T> SpanIterator<T>::operator++(int)
+	{
+		SpanIterator<T> it = *this;
+		++this->pos_;
+		return it;
+	}
+
+	template <typename T>
+	SpanIterator<T> &SpanIterator<T>::operator--(void)
+	{
+		--this->pos_;
+		return *this;
+	}
+
+	template <typename T>
+	SpanIterator<T> SpanIterator<T>::operator--(int)
+	{
+		SpanIterator<T> it = *this;
+		--this->pos_;
+		return it;
+	}
+
+	template <typename T>
+	SpanIterator<T> &SpanIterator<T>::operator+=(difference_type n)
+	{
+		this->pos_ += n;
+		return *this;
+	}
+
+	template <typename T>
+	SpanIterator<T> &SpanIterator<T>::operator-=(difference_type n)
+	{
+		this->pos_ -= n;
+		return *this;
+	}
+
+	template <typename T>
+	SpanIterator<T> SpanIterator<T>::operator+(difference_type n) const
+	{
+		SpanIterator<T> it = *this;
+		return it += n;
+	}
+
+	template <typename T>
+	SpanIterator<T> SpanIterator<T>::operator-(difference_type n) const
+	{
+		SpanIterator<T> it = *this;
+		return it -= n;
+	}
+
+	template <typename T>
+	typename SpanIterator<T>::difference_type SpanIterator<T>::operator-(
+		const SpanIterator<T> &rhs) const
+	{
+		return this->pos_ - rhs.pos_;
+	}
+
+	// Iterators of the same range differ only by the position.
+	template <typename T>
+	bool SpanIterator<T>::operator==(const SpanIterator<T> &rhs) const
+	{
+		return this->pos_ == rhs.pos_;
+	}
+
+	template <typename T>
+	bool SpanIterator<T>::operator!=(const SpanIterator<T> &rhs) const
+	{
+		return this->pos_ != rhs.pos_;
+	}
+
+	template <typename T>
+	bool SpanIterator<T>::operator<(const SpanIterator<T> &rhs) const
+	{
+		return this->pos_ < rhs.pos_;
+	}
+
+	template <typename T>
+	bool SpanIterator<T>::operator>(const SpanIterator<T> &rhs) const
+	{
+		return this->pos_ > rhs.pos_;
+	}
+
+	template <typename T>
+	bool SpanIterator<T>::operator<=(const SpanIterator<T> &rhs) const
+	{
+		return this->pos_ <= rhs.pos_;
+	}
+
+	template <typename T>
+	bool SpanIterator<T>::operator>=(const SpanIterator<T> &rhs) const
+	{
+		return this->pos_ >= rhs.pos_;
+	}
+
+	template <typename T>
+	SpanIterator<T> operator+(typename SpanIterator<T>::difference_type n,
+		const SpanIterator<T> &it)
+	{
+		return it + n;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// SpanRange<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+	template <typename T>
+	SpanRange<T>::SpanRange(void) : size_(0) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+
+	// The number of inner spans is at least one to avoid a division by zero even for an
+	// empty range.
+	template <typename T>
+	SpanRange<T>::SpanRange(T *data, size_type n, size_type nElem, size_type nInner,
+		size_type stepInner, size_type stepOuter) :
+		begin_(data, 0, nElem, nInner > 0 ? nInner : 1, stepInner, stepOuter), size_(n) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+	template <typename T>
+	Span<T> SpanRange<T>::operator[](size_type pos) const
+	{
+		return this->begin_[static_cast<typename SpanIterator<T>::difference_type>(pos)];
+	}
+
+	template <typename T>
+	SpanIterator<T> SpanRange<T>::begin(void) const
+	{
+		return this->begin_;
+	}
+
+	template <typename T>
+	SpanIterator<T> SpanRange<T>::end(void) const
+	{
+		return this->begin_ +
+			static_cast<typename SpanIterator<T>::difference_type>(this->size_);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+	template <typename T>
+	typename SpanRange<T>::size_type SpanRange<T>::size(void) const
+	{
+		return this->size_;
+	}
+
+	template <typename T>
+	bool SpanRange<T>::empty(void) const
+	{
+		return this->size_ == 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	template <typename T, RangeCheck R>
+	SpanRange<T> GetLines(const ImageView<T, R> &view)
+	{
+		const auto &size = view.size;
+		if (size.width == 0 || size.height == 0 || size.depth == 0)
+			return SpanRange<T>();
+
+		T *data = view.GetPointer(0, 0);
+		switch (view.format)
+		{
+		case ImageFormat::BIP:
+			if (view.step.x == size.depth && view.step.z == 1)
+				return SpanRange<T>(data, size.height, size.depth * size.width,
+				size.height, view.step.y, 0);
+			break;
+		case ImageFormat::BSQ:
+			if (view.step.x == 1)
+				return SpanRange<T>(data, size.depth * size.height, size.width,
+				size.height, view.step.y, view.step.z);
+			break;
+		case ImageFormat::BIL:
+			if (view.step.x == 1)
+				return SpanRange<T>(data, size.height * size.depth, size.width,
+				size.depth, view.step.z, view.step.y);
+			break;
+		default:
+			std::ostringstream errMsg;
+			errMsg << "Image format " << static_cast<int>(view.format) <<
+				" is not supported.";
+			throw std::logic_error(errMsg.str());
+		}
+
+		throw std::logic_error("Elements of a line are not continuous.");
+	}
+
+	template <typename T>
+	SpanRange<T> GetPixels(const Span<T> &line, ::size_t depth)
+	{
+		if (depth == 0)
+			return SpanRange<T>();
+		return SpanRange<T>(line.data(), line.size() / depth, depth, line.size() / depth,
+			depth, 0);
+	}
+
+	template <typename T, RangeCheck R>
+	SpanRange<T> GetPixels(const ImageView<T, R> &view,
+		typename ImageView<T, R>::SizeType y)
+	{
+		if (view.format != ImageFormat::BIP)
+			throw std::logic_error("Pixels are continuous only for BIP.");
+		return GetPixels(GetLines(view.GetView(
+			Region<typename ImageView<T, R>::SizeType, typename ImageView<T, R>::SizeType>(
+			0, y, view.size.width, 1)))[0], view.size.depth);
+	}
+}
+
+#endif
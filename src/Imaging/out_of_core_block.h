@@ -0,0 +1,225 @@
+#if !defined(OUT_OF_CORE_BLOCK_H)
+#define OUT_OF_CORE_BLOCK_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "image2.h"
+
+namespace Imaging
+{
+	/** Specifies whether the backing file of an out-of-core block is created or opened. */
+	enum class FileMode : int
+	{
+		CREATE,	// a new file filled with zeros, overwriting an existing file
+		OPEN	// an existing file holding all frames
+	};
+
+	/** Stores frames of the same size in a local file, and keeps up to a memory budget of
+	them in memory, so a block larger than the memory can be processed frame by frame.
+
+	The file holds the frames one after another without padding elements. A frame is read
+	when it is accessed, and the least recently used frames are evicted when the resident
+	frames exceed the budget, where modified frames are written back to the file.
+	If the frames are accessed at a constant stride, e.g., sequentially, the next frames
+	of the stride are read in advance by a background thread.
+
+	Read(), Write() and Overwrite() return shared pointers to the frames. A frame is pinned
+	in memory while its pointer is held outside the block, so hold a pointer only while the
+	frame is used, or the resident frames may exceed the budget.
+	The methods are thread-safe, but a frame itself is not. */
+	template <typename T>
+	class OutOfCoreBlock
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef typename ImageFrame<T>::SizeType SizeType;
+
+		/** Residency, hit rate and paging traffic of the block. */
+		struct Statistics
+		{
+			Statistics(void);
+
+			/** Returns nHits / (nHits + nMisses), or zero if nothing has been accessed. */
+			double GetHitRate(void) const;
+
+			::size_t nHits;				// accesses served by a resident frame
+			::size_t nMisses;			// accesses which waited for the file
+			::size_t nPrefetches;		// frames read in advance
+			::size_t nPrefetchHits;		// accesses served by a frame read in advance
+			::size_t nEvictions;
+			::size_t nBytesRead;
+			::size_t nBytesWritten;
+			::size_t nFramesResident;
+			::size_t nBytesResident;
+		};
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** @param [in] path			the backing file
+		@param [in] sz				size of every frame
+		@param [in] n				the number of frames
+		@param [in] nBytesBudget	the number of bytes of the resident frames
+		@param [in] mode			whether the file is created or opened
+		@exception std::runtime_error	if the file cannot be created or is too small */
+		OutOfCoreBlock(const std::string &path, const Size3D<SizeType> &sz, SizeType n,
+			::size_t nBytesBudget, FileMode mode = FileMode::CREATE);
+
+		/** Writes back all modified frames, and closes the file. */
+		~OutOfCoreBlock(void);
+
+		//////////////////////////////////////////////////
+		// Accessors.
+
+		/** Returns a frame for reading. The frame must not be modified. */
+		std::shared_ptr<const ImageFrame<T> > Read(SizeType pos);
+
+		/** Returns a frame for writing, which is written back to the file when it is
+		evicted or flushed. */
+		std::shared_ptr<ImageFrame<T> > Write(SizeType pos);
+
+		/** Returns a frame for writing every element as Write(), but the frame is not read
+		from the file, so the elements are undefined unless the frame is resident.
+		A frame on the file is counted as neither a hit nor a miss, and other frames are
+		not prefetched, since they would be overwritten as well. */
+		std::shared_ptr<ImageFrame<T> > Overwrite(SizeType pos);
+
+		/** Size of every frame. */
+		const Size3D<SizeType> &size;
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** Writes back all modified resident frames to the file. */
+		void Flush(void);
+
+		SizeType GetFrameCount(void) const;
+
+		::size_t GetMemoryBudget(void) const;
+
+		/** Changes the memory budget, and evicts frames exceeding it. */
+		void SetMemoryBudget(::size_t nBytesBudget);
+
+		/** Returns the number of frames read in advance when a stride is detected. */
+		SizeType GetPrefetchDepth(void) const;
+
+		/** Sets the number of frames read in advance. Zero disables prefetching. */
+		void SetPrefetchDepth(SizeType n);
+
+		/** Returns true if the frame is in memory. */
+		bool IsResident(SizeType pos) const;
+
+		Statistics GetStatistics(void) const;
+
+		/** Resets the access and paging counts, but not the residency. */
+		void ResetStatistics(void);
+
+	protected:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		enum class FrameState : int
+		{
+			ON_FILE,
+			LOADING,
+			RESIDENT,
+			WRITING		// a modified frame being written back at its eviction
+		};
+
+		struct Entry
+		{
+			Entry(void);
+
+			std::shared_ptr<ImageFrame<T> > frame;
+			FrameState state;
+			bool isDirty;
+			bool isPrefetched;
+			typename std::list<SizeType>::iterator it_lru;
+		};
+
+		/** Frames to be written to the file, and their positions. */
+		typedef std::vector<std::pair<SizeType, std::shared_ptr<ImageFrame<T> > > > FrameList;
+
+		//////////////////////////////////////////////////
+		// Methods.
+		void CheckRange(SizeType pos) const;
+		std::shared_ptr<ImageFrame<T> > Access(SizeType pos, bool isWritten,
+			bool isOverwritten);
+
+		/** Detects a constant stride of accesses, and queues the next frames. */
+		void Prefetch(SizeType pos);
+
+		/** Runs on the background thread to read queued frames. */
+		void RunPrefetcher(void);
+
+		/** Allocates a frame of uninitialized elements. */
+		std::shared_ptr<ImageFrame<T> > CreateFrame(void) const;
+
+		/** Reads a frame from the file without locking mutex_. */
+		std::shared_ptr<ImageFrame<T> > ReadFrame(SizeType pos);
+		void WriteFrame(SizeType pos, const ImageFrame<T> &frame);
+
+		/** Makes a frame resident, and evicts other frames as necessary, where the
+		modified frames evicted are appended to victims. mutex_ must be locked. */
+		void Insert(SizeType pos, const std::shared_ptr<ImageFrame<T> > &frame,
+			FrameList &victims);
+
+		/** Evicts the least recently used frames which are not pinned until the resident
+		frames fit the budget. An unmodified frame is dropped at once, and a modified frame
+		becomes WRITING and is appended to victims to be written by WriteBack().
+		mutex_ must be locked. */
+		void Evict(SizeType posKept, FrameList &victims);
+
+		/** Writes the frames evicted by Evict() with mutex_ unlocked, so other frames are
+		accessed during the disk I/O, and then drops them. A frame which cannot be written
+		becomes resident again, and the first error is rethrown after all frames are
+		handled. lock must hold mutex_, and holds it again at the return. */
+		void WriteBack(std::unique_lock<std::mutex> &lock, const FrameList &victims);
+
+		::size_t GetBytesPerFrame(void) const;
+
+		//////////////////////////////////////////////////
+		// Data.
+		Size3D<SizeType> size_;
+		::size_t nBytesBudget_;
+		SizeType nPrefetch_;
+		std::vector<Entry> entries_;
+		std::list<SizeType> lru_;		// the most recently used frame at the front.
+		Statistics stats_;
+
+		SizeType posLast_;
+		::ptrdiff_t strideLast_;
+		std::deque<SizeType> queue_;	// frames to be prefetched.
+		SizeType nWriting_;				// frames being written back.
+		bool isStopped_;
+
+		std::fstream file_;
+		std::mutex mutexFile_;			// locked after mutex_ if both are locked.
+		mutable std::mutex mutex_;
+		std::condition_variable cvLoaded_;	// a frame has left LOADING or WRITING.
+		std::condition_variable cvQueued_;
+		std::thread prefetcher_;
+
+	private:
+		// Not copyable because the block owns the file.
+		OutOfCoreBlock(const OutOfCoreBlock<T> &);
+		OutOfCoreBlock<T> &operator=(const OutOfCoreBlock<T> &);
+	};
+}
+
+#include "out_of_core_block_inl.h"
+
+#endif
@@ -0,0 +1,585 @@
+#if !defined(OUT_OF_CORE_BLOCK_INL_H)
+#define OUT_OF_CORE_BLOCK_INL_H
+
+namespace Imaging
+{
+	//////////////////////////////////////////////////////////////////////////
+	// OutOfCoreBlock<T>::Statistics struct
+
+	template <typename T>
+	OutOfCoreBlock<T>::Statistics::Statistics(void) : nHits(0), nMisses(0), nPrefetches(0),
+		nPrefetchHits(0), nEvictions(0), nBytesRead(0), nBytesWritten(0), nFramesResident(0),
+		nBytesResident(0) {}
+
+	template <typename T>
+	double OutOfCoreBlock<T>::Statistics::GetHitRate(void) const
+	{
+		if (this->nHits + this->nMisses == 0)
+			return 0.0;
+		return static_cast<double>(this->nHits) / (this->nHits + this->nMisses);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// OutOfCoreBlock<T>::Entry struct
+
+	template <typename T>
+	OutOfCoreBlock<T>::Entry::Entry(void) : state(FrameState::ON_FILE), isDirty(false),
+		isPrefetched(false) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// OutOfCoreBlock<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+
+	/** A new file is extended to the full size by writing its last byte, so the frames
+	never written are read as zeros. */
+	template <typename T>
+	OutOfCoreBlock<T>::OutOfCoreBlock(const std::string &path, const Size3D<SizeType> &sz,
+		SizeType n, ::size_t nBytesBudget, FileMode mode) : size(size_), size_(sz),
+		nBytesBudget_(nBytesBudget), nPrefetch_(2), entries_(n), posLast_(0),
+		strideLast_(0), nWriting_(0), isStopped_(false)
+	{
+		std::ios_base::openmode flags = std::ios_base::in | std::ios_base::out |
+			std::ios_base::binary;
+		if (mode == FileMode::CREATE)
+			flags |= std::ios_base::trunc;
+		this->file_.open(path.c_str(), flags);
+		if (!this->file_)
+		{
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " cannot be opened.";
+			throw std::runtime_error(errMsg.str());
+		}
+
+		const std::streamoff nBytes = static_cast<std::streamoff>(this->GetBytesPerFrame()) *
+			static_cast<std::streamoff>(n);
+		if (mode == FileMode::CREATE)
+		{
+			if (nBytes > 0)
+			{
+				this->file_.seekp(nBytes - 1);
+				this->file_.put(0);
+			}
+		}
+		else
+		{
+			this->file_.seekg(0, std::ios_base::end);
+			if (this->file_.tellg() < nBytes)
+			{
+				std::ostringstream errMsg;
+				errMsg << "File " << path << " is smaller than " << nBytes << " bytes.";
+				throw std::runtime_error(errMsg.str());
+			}
+		}
+		if (!this->file_)
+		{
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " cannot be extended to " << nBytes << " bytes.";
+			throw std::runtime_error(errMsg.str());
+		}
+
+		this->prefetcher_ = std::thread(&OutOfCoreBlock<T>::RunPrefetcher, this);
+	}
+
+	/** A destructor must not throw, so an error at writing back is ignored. Call Flush()
+	before the destruction to detect it. */
+	template <typename T>
+	OutOfCoreBlock<T>::~OutOfCoreBlock(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex_);
+			this->isStopped_ = true;
+		}
+		this->cvQueued_.notify_all();
+		this->prefetcher_.join();
+
+		try
+		{
+			this->Flush();
+		}
+		catch (...) {}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+
+	template <typename T>
+	std::shared_ptr<const ImageFrame<T> > OutOfCoreBlock<T>::Read(SizeType pos)
+	{
+		return this->Access(pos, false, false);
+	}
+
+	template <typename T>
+	std::shared_ptr<ImageFrame<T> > OutOfCoreBlock<T>::Write(SizeType pos)
+	{
+		return this->Access(pos, true, false);
+	}
+
+	template <typename T>
+	std::shared_ptr<ImageFrame<T> > OutOfCoreBlock<T>::Overwrite(SizeType pos)
+	{
+		return this->Access(pos, true, true);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	/** The modified frames are pinned and written with mutex_ unlocked, and then the
+	frames being written back by evictions are waited for. */
+	template <typename T>
+	void OutOfCoreBlock<T>::Flush(void)
+	{
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		FrameList frames;
+		for (SizeType N = 0; N != this->entries_.size(); ++N)
+		{
+			Entry &entry = this->entries_[N];
+			if (entry.state == FrameState::RESIDENT && entry.isDirty)
+				frames.push_back(std::make_pair(N, entry.frame));
+		}
+		for (auto it = frames.begin(); it != frames.end(); ++it)
+			this->entries_[it->first].isDirty = false;
+		lock.unlock();
+
+		std::exception_ptr error;
+		SizeType nWritten = 0;
+		for (auto it = frames.begin(); it != frames.end(); ++it)
+		{
+			try
+			{
+				this->WriteFrame(it->first, *it->second);
+				it->second.reset();
+				++nWritten;
+			}
+			catch (...)
+			{
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+
+		lock.lock();
+		this->stats_.nBytesWritten += nWritten * this->GetBytesPerFrame();
+		for (auto it = frames.begin(); it != frames.end(); ++it)
+			if (it->second)
+				this->entries_[it->first].isDirty = true;
+		while (this->nWriting_ > 0)
+			this->cvLoaded_.wait(lock);
+		if (error)
+			std::rethrow_exception(error);
+
+		std::lock_guard<std::mutex> lockFile(this->mutexFile_);
+		this->file_.flush();
+	}
+
+	template <typename T>
+	typename OutOfCoreBlock<T>::SizeType OutOfCoreBlock<T>::GetFrameCount(void) const
+	{
+		return this->entries_.size();
+	}
+
+	template <typename T>
+	::size_t OutOfCoreBlock<T>::GetMemoryBudget(void) const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		return this->nBytesBudget_;
+	}
+
+	template <typename T>
+	void OutOfCoreBlock<T>::SetMemoryBudget(::size_t nBytesBudget)
+	{
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		this->nBytesBudget_ = nBytesBudget;
+		FrameList victims;
+		this->Evict(this->entries_.size(), victims);
+		this->WriteBack(lock, victims);
+	}
+
+	template <typename T>
+	typename OutOfCoreBlock<T>::SizeType OutOfCoreBlock<T>::GetPrefetchDepth(void) const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		return this->nPrefetch_;
+	}
+
+	template <typename T>
+	void OutOfCoreBlock<T>::SetPrefetchDepth(SizeType n)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->nPrefetch_ = n;
+	}
+
+	template <typename T>
+	bool OutOfCoreBlock<T>::IsResident(SizeType pos) const
+	{
+		this->CheckRange(pos);
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		return this->entries_[pos].state == FrameState::RESIDENT;
+	}
+
+	template <typename T>
+	typename OutOfCoreBlock<T>::Statistics OutOfCoreBlock<T>::GetStatistics(void) const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		return this->stats_;
+	}
+
+	template <typename T>
+	void OutOfCoreBlock<T>::ResetStatistics(void)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->stats_.nHits = 0;
+		this->stats_.nMisses = 0;
+		this->stats_.nPrefetches = 0;
+		this->stats_.nPrefetchHits = 0;
+		this->stats_.nEvictions = 0;
+		this->stats_.nBytesRead = 0;
+		this->stats_.nBytesWritten = 0;
+	}
+
+	template <typename T>
+	void OutOfCoreBlock<T>::CheckRange(SizeType pos) const
+	{
+		if (pos >= this->entries_.size())
+		{
+			std::ostringstream errMsg;
+			errMsg << "Frame " << pos << " is out of range.";
+			throw std::out_of_range(errMsg.str());
+		}
+	}
+
+	/** A frame being read by the prefetcher is waited for instead of being read twice, and
+	a frame being written back is waited for until it is on the file.
+	A miss reads the frame and writes back the evicted frames without locking mutex_, so
+	other frames are accessed in the meantime. The waiters of the frame are notified even
+	if it cannot be read or inserted. An overwritten frame on the file is allocated instead
+	of being read, which takes no disk I/O, so it is inserted with mutex_ locked. */
+	template <typename T>
+	std::shared_ptr<ImageFrame<T> > OutOfCoreBlock<T>::Access(SizeType pos, bool isWritten,
+		bool isOverwritten)
+	{
+		this->CheckRange(pos);
+
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		if (!isOverwritten)
+			this->Prefetch(pos);
+		Entry &entry = this->entries_[pos];
+		while (entry.state == FrameState::LOADING || entry.state == FrameState::WRITING)
+			this->cvLoaded_.wait(lock);
+
+		FrameList victims;
+		if (isOverwritten && entry.state == FrameState::ON_FILE)
+			this->Insert(pos, this->CreateFrame(), victims);
+		else if (entry.state == FrameState::RESIDENT)
+		{
+			++this->stats_.nHits;
+			if (entry.isPrefetched)
+			{
+				++this->stats_.nPrefetchHits;
+				entry.isPrefetched = false;
+			}
+			this->lru_.splice(this->lru_.begin(), this->lru_, entry.it_lru);
+		}
+		else
+		{
+			++this->stats_.nMisses;
+			entry.state = FrameState::LOADING;
+			lock.unlock();
+
+			std::shared_ptr<ImageFrame<T> > frame;
+			try
+			{
+				frame = this->ReadFrame(pos);
+			}
+			catch (...)
+			{
+				lock.lock();
+				entry.state = FrameState::ON_FILE;
+				this->cvLoaded_.notify_all();
+				throw;
+			}
+
+			lock.lock();
+			this->stats_.nBytesRead += this->GetBytesPerFrame();
+			try
+			{
+				this->Insert(pos, frame, victims);
+			}
+			catch (...)
+			{
+				if (entry.state == FrameState::LOADING)
+					entry.state = FrameState::ON_FILE;
+				this->cvLoaded_.notify_all();
+				throw;
+			}
+			this->cvLoaded_.notify_all();
+		}
+
+		// The frame is pinned by the pointer while the evicted frames are written.
+		if (isWritten)
+			entry.isDirty = true;
+		const std::shared_ptr<ImageFrame<T> > frame = entry.frame;
+		this->WriteBack(lock, victims);
+		return frame;
+	}
+
+	/** Prefetching is limited by the budget, so a frame read in advance does not evict
+	another frame read in advance before it is accessed. */
+	template <typename T>
+	void OutOfCoreBlock<T>::Prefetch(SizeType pos)
+	{
+		const ::ptrdiff_t stride = static_cast< ::ptrdiff_t>(pos) -
+			static_cast< ::ptrdiff_t>(this->posLast_);
+		if (stride != 0 && stride == this->strideLast_)
+		{
+			const ::size_t nBytesFrame = std::max< ::size_t>(this->GetBytesPerFrame(), 1);
+			const SizeType nFit = this->nBytesBudget_ / nBytesFrame;
+			const SizeType nPrefetch = std::min(this->nPrefetch_, nFit > 0 ? nFit - 1 : 0);
+
+			bool isQueued = false;
+			for (SizeType K = 1; K <= nPrefetch; ++K)
+			{
+				const ::ptrdiff_t next = static_cast< ::ptrdiff_t>(pos) +
+					static_cast< ::ptrdiff_t>(K) * stride;
+				if (next < 0 || next >= static_cast< ::ptrdiff_t>(this->entries_.size()))
+					break;
+				if (this->entries_[next].state == FrameState::ON_FILE &&
+					std::find(this->queue_.begin(), this->queue_.end(),
+					static_cast<SizeType>(next)) == this->queue_.end())
+				{
+					this->queue_.push_back(static_cast<SizeType>(next));
+					isQueued = true;
+				}
+			}
+			if (isQueued)
+				this->cvQueued_.notify_one();
+		}
+		this->posLast_ = pos;
+		this->strideLast_ = stride;
+	}
+
+	/** An error on the background thread is ignored, so the frame is read again and the
+	error is reported when the frame is accessed. */
+	template <typename T>
+	void OutOfCoreBlock<T>::RunPrefetcher(void)
+	{
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		for (;;)
+		{
+			while (!this->isStopped_ && this->queue_.empty())
+				this->cvQueued_.wait(lock);
+			if (this->isStopped_)
+				return;
+
+			const SizeType pos = this->queue_.front();
+			this->queue_.pop_front();
+			Entry &entry = this->entries_[pos];
+			if (entry.state != FrameState::ON_FILE)
+				continue;
+			entry.state = FrameState::LOADING;
+			lock.unlock();
+
+			std::shared_ptr<ImageFrame<T> > frame;
+			try
+			{
+				frame = this->ReadFrame(pos);
+			}
+			catch (...) {}
+
+			lock.lock();
+			FrameList victims;
+			if (frame)
+			{
+				this->stats_.nBytesRead += this->GetBytesPerFrame();
+				try
+				{
+					this->Insert(pos, frame, victims);
+				}
+				catch (...) {}
+			}
+			if (entry.state == FrameState::RESIDENT)
+			{
+				entry.isPrefetched = true;
+				++this->stats_.nPrefetches;
+			}
+			else
+				entry.state = FrameState::ON_FILE;
+			this->cvLoaded_.notify_all();
+
+			try
+			{
+				this->WriteBack(lock, victims);
+			}
+			catch (...) {}
+		}
+	}
+
+	template <typename T>
+	std::shared_ptr<ImageFrame<T> > OutOfCoreBlock<T>::CreateFrame(void) const
+	{
+		std::shared_ptr<ImageFrame<T> > frame = std::make_shared<ImageFrame<T> >();
+		frame->Resize(this->size, ResizeMode::UNINITIALIZED);
+		return frame;
+	}
+
+	template <typename T>
+	std::shared_ptr<ImageFrame<T> > OutOfCoreBlock<T>::ReadFrame(SizeType pos)
+	{
+		std::shared_ptr<ImageFrame<T> > frame = this->CreateFrame();
+		const ::size_t nBytes = this->GetBytesPerFrame();
+		if (nBytes == 0)
+			return frame;
+
+		std::lock_guard<std::mutex> lock(this->mutexFile_);
+		this->file_.seekg(static_cast<std::streamoff>(pos) *
+			static_cast<std::streamoff>(nBytes));
+		this->file_.read(reinterpret_cast<char *>(frame->GetView().GetPointer(0, 0)),
+			static_cast<std::streamsize>(nBytes));
+		if (!this->file_)
+		{
+			this->file_.clear();
+			std::ostringstream errMsg;
+			errMsg << "Frame " << pos << " cannot be read.";
+			throw std::runtime_error(errMsg.str());
+		}
+		return frame;
+	}
+
+	template <typename T>
+	void OutOfCoreBlock<T>::WriteFrame(SizeType pos, const ImageFrame<T> &frame)
+	{
+		const ::size_t nBytes = this->GetBytesPerFrame();
+		if (nBytes == 0)
+			return;
+
+		std::lock_guard<std::mutex> lock(this->mutexFile_);
+		this->file_.seekp(static_cast<std::streamoff>(pos) *
+			static_cast<std::streamoff>(nBytes));
+		this->file_.write(reinterpret_cast<const char *>(frame.GetView().GetPointer(0, 0)),
+			static_cast<std::streamsize>(nBytes));
+		if (!this->file_)
+		{
+			this->file_.clear();
+			std::ostringstream errMsg;
+			errMsg << "Frame " << pos << " cannot be written.";
+			throw std::runtime_error(errMsg.str());
+		}
+	}
+
+	/** The frame is added to the LRU list first, so the entry is unchanged if it throws. */
+	template <typename T>
+	void OutOfCoreBlock<T>::Insert(SizeType pos,
+		const std::shared_ptr<ImageFrame<T> > &frame, FrameList &victims)
+	{
+		this->lru_.push_front(pos);
+		Entry &entry = this->entries_[pos];
+		entry.frame = frame;
+		entry.state = FrameState::RESIDENT;
+		entry.it_lru = this->lru_.begin();
+
+		const ::size_t nBytes = this->GetBytesPerFrame();
+		++this->stats_.nFramesResident;
+		this->stats_.nBytesResident += nBytes;
+		this->Evict(pos, victims);
+	}
+
+	/** A frame is pinned if its pointer is held outside the block. A frame being written
+	keeps its node of the LRU list until WriteBack(), and victims is reserved in advance, so
+	no frame becomes WRITING unless it is returned. */
+	template <typename T>
+	void OutOfCoreBlock<T>::Evict(SizeType posKept, FrameList &victims)
+	{
+		victims.reserve(victims.size() + this->lru_.size());
+		auto it = this->lru_.end();
+		while (this->stats_.nBytesResident > this->nBytesBudget_ && it != this->lru_.begin())
+		{
+			--it;
+			const SizeType pos = *it;
+			Entry &entry = this->entries_[pos];
+			if (pos == posKept || entry.state != FrameState::RESIDENT ||
+				entry.frame.use_count() > 1)
+				continue;
+
+			if (entry.isDirty)
+			{
+				victims.push_back(std::make_pair(pos, entry.frame));
+				entry.state = FrameState::WRITING;
+				++this->nWriting_;
+			}
+			else
+			{
+				entry.frame.reset();
+				entry.state = FrameState::ON_FILE;
+				it = this->lru_.erase(it);
+			}
+			entry.isPrefetched = false;
+
+			--this->stats_.nFramesResident;
+			this->stats_.nBytesResident -= this->GetBytesPerFrame();
+			++this->stats_.nEvictions;
+		}
+	}
+
+	/** A frame which cannot be written is moved to the back of the LRU list, so it is the
+	first to be evicted again. */
+	template <typename T>
+	void OutOfCoreBlock<T>::WriteBack(std::unique_lock<std::mutex> &lock,
+		const FrameList &victims)
+	{
+		if (victims.empty())
+			return;
+
+		lock.unlock();
+		std::exception_ptr error;
+		std::vector<char> isWritten(victims.size(), 0);
+		for (::size_t I = 0; I != victims.size(); ++I)
+		{
+			try
+			{
+				this->WriteFrame(victims[I].first, *victims[I].second);
+				isWritten[I] = 1;
+			}
+			catch (...)
+			{
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+
+		lock.lock();
+		const ::size_t nBytes = this->GetBytesPerFrame();
+		for (::size_t I = 0; I != victims.size(); ++I)
+		{
+			Entry &entry = this->entries_[victims[I].first];
+			if (isWritten[I])
+			{
+				entry.frame.reset();
+				entry.state = FrameState::ON_FILE;
+				entry.isDirty = false;
+				this->lru_.erase(entry.it_lru);
+				this->stats_.nBytesWritten += nBytes;
+			}
+			else
+			{
+				this->lru_.splice(this->lru_.end(), this->lru_, entry.it_lru);
+				entry.state = FrameState::RESIDENT;
+				++this->stats_.nFramesResident;
+				this->stats_.nBytesResident += nBytes;
+				--this->stats_.nEvictions;
+			}
+		}
+		this->nWriting_ -= victims.size();
+		this->cvLoaded_.notify_all();
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	template <typename T>
+	::size_t OutOfCoreBlock<T>::GetBytesPerFrame(void) const
+	{
+		return this->size.width * this->size.height * this->size.depth * sizeof(T);
+	}
+}
+
+#endif
@@ -0,0 +1,331 @@
+#if !defined(RAW_FILE_H)
+#define RAW_FILE_H
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "image.h"
+
+namespace Imaging
+{
+	enum class ByteOrder {LITTLE, BIG};
+
+	/** Hints how a mapped file is accessed, so the operating system reads ahead or not. */
+	enum class AccessPattern {NORMAL, SEQUENTIAL, RANDOM, WILL_NEED};
+
+	/** Returns the byte order of this machine. */
+	ByteOrder GetNativeByteOrder(void);
+
+	/** Describes the binary body of a raw image file. */
+	struct RawFileInfo
+	{
+		RawFileInfo(void);
+
+		Size3D< ::size_t> size;		// samples, lines and bands
+		ImageFormat format;
+		ImageDataType dataType;
+		::size_t headerOffset;		// the number of bytes before the image data
+		ByteOrder byteOrder;
+	};
+
+	/** Reads an ENVI header file (.hdr) describing a raw image file.
+
+	samples, lines, bands, data type and interleave are required, and header offset and
+	byte order are optional.
+	@exception std::runtime_error	if the file cannot be read, or a required field is
+	missing or not supported */
+	RawFileInfo ReadEnviHeader(const std::string &path);
+
+	/** Maps an entire file into memory for reading.
+
+	Pages are read by the operating system when they are accessed for the first time, so
+	opening a file does not read it. */
+	class MappedFile
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Default constructors.
+		MappedFile(void);
+		~MappedFile(void);
+
+		/** Moves the mapping. The source becomes closed. */
+		MappedFile(MappedFile &&src) IMAGING_NOEXCEPT;
+		MappedFile &operator=(MappedFile &&src) IMAGING_NOEXCEPT;
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		explicit MappedFile(const std::string &path,
+			AccessPattern pattern = AccessPattern::NORMAL);
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** @exception std::runtime_error	if the file cannot be opened or mapped */
+		void Open(const std::string &path, AccessPattern pattern = AccessPattern::NORMAL);
+		void Close(void);
+		bool IsOpen(void) const;
+
+		/** Returns the first byte of the file, or nullptr if the file is empty. */
+		const unsigned char *GetData(void) const;
+		::size_t GetSize(void) const;
+
+		/** Gives a hint for a range of bytes by madvise().
+
+		On Windows, the hint of the entire file is given when the file is opened, and
+		WILL_NEED reads the range in advance from Windows 8. */
+		void Advise(AccessPattern pattern, ::size_t offset, ::size_t nBytes) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Data.
+		const unsigned char *data_;
+		::size_t size_;
+#if defined(_WIN32)
+		HANDLE file_;
+		HANDLE mapping_;
+#else
+		int file_;
+#endif
+
+	private:
+		// Not copyable because the object owns the mapping.
+		MappedFile(const MappedFile &);
+		MappedFile &operator=(const MappedFile &);
+	};
+
+	/** Presents a raw BIP, BSQ or BIL image file as a read-only image without copying it.
+
+	If the byte order of the file is not the native one, the elements cannot be read
+	through a view, so use Load() to copy an ROI with swapping the bytes. */
+	template <typename T>
+	class MappedImage
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef ::size_t SizeType;
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** @param [in] headerOffset	the number of bytes before the image data, which must
+		be a multiple of the alignment of T
+		@exception std::runtime_error	if the file is smaller than the image */
+		MappedImage(const std::string &path, const Size3D<SizeType> &sz, ImageFormat fmt,
+			::size_t headerOffset = 0, ByteOrder byteOrder = GetNativeByteOrder(),
+			AccessPattern pattern = AccessPattern::NORMAL);
+
+		/** Maps a file described by ReadEnviHeader().
+
+		@exception std::invalid_argument	if the data type is not matched with T */
+		MappedImage(const std::string &path, const RawFileInfo &info,
+			AccessPattern pattern = AccessPattern::NORMAL);
+
+		//////////////////////////////////////////////////
+		// Accessors.
+
+		/** Accesses the entire image or an ROI without copying data.
+
+		@exception std::logic_error	if the bytes must be swapped */
+		ImageView<const T> GetView(void) const;
+		ImageView<const T> GetView(const Region<SizeType, SizeType> &roi) const;
+
+		const Size3D<SizeType> &size;
+		const ImageFormat &format;
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** Copies an ROI to an image of the same format, swapping the bytes if
+		necessary. */
+		void Load(const Region<SizeType, SizeType> &roi, Image<T> &imgDst) const;
+
+		/** Gives a hint for the entire image. */
+		void Advise(AccessPattern pattern) const;
+
+		/** Gives a hint for the lines of an ROI, e.g., WILL_NEED before reading it. */
+		void Advise(AccessPattern pattern, const Region<SizeType, SizeType> &roi) const;
+
+		bool IsByteSwapped(void) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Methods.
+		void Map(const std::string &path, AccessPattern pattern);
+
+		/** Returns a view regardless of the byte order. */
+		ImageView<const T> GetRawView(void) const;
+
+		//////////////////////////////////////////////////
+		// Data.
+		MappedFile file_;
+		Size3D<SizeType> size_;
+		ImageFormat format_;
+		::size_t headerOffset_;
+		bool isByteSwapped_;
+	};
+
+	/** Reads byte ranges of a file at given positions by pread() or ReadFile() with an
+	offset, so the file pointer is never moved. */
+	class RandomAccessFile
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Default constructors.
+		RandomAccessFile(void);
+		~RandomAccessFile(void);
+
+		/** Moves the file. The source becomes closed. */
+		RandomAccessFile(RandomAccessFile &&src) IMAGING_NOEXCEPT;
+		RandomAccessFile &operator=(RandomAccessFile &&src) IMAGING_NOEXCEPT;
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+		explicit RandomAccessFile(const std::string &path);
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** @exception std::runtime_error	if the file cannot be opened */
+		void Open(const std::string &path);
+		void Close(void);
+		bool IsOpen(void) const;
+		std::uint64_t GetSize(void) const;
+
+		/** Reads nBytes bytes from offset to dst.
+
+		@exception std::runtime_error	if the bytes cannot be read */
+		void Read(std::uint64_t offset, ::size_t nBytes, void *dst) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Data.
+		std::uint64_t size_;
+#if defined(_WIN32)
+		HANDLE file_;
+#else
+		int file_;
+#endif
+
+	private:
+		// Not copyable because the object owns the file.
+		RandomAccessFile(const RandomAccessFile &);
+		RandomAccessFile &operator=(const RandomAccessFile &);
+	};
+
+	/** Reads ROIs and bands of a raw BIP, BSQ or BIL image file which may be far larger
+	than the memory.
+
+	Only the lines of an ROI are read, where lines separated by a small gap are read at
+	once into a staging buffer, and copied to the destination image by Copy(). */
+	template <typename T>
+	class RawImageFile
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef ::size_t SizeType;
+
+		/** Lines separated by up to this number of bytes are read at once. */
+		static const ::size_t DEFAULT_MAX_GAP = 64 * 1024;
+
+		/** The maximum number of bytes of the staging buffer. */
+		static const ::size_t DEFAULT_BUFFER_SIZE = 16 * 1024 * 1024;
+
+		/** Number of reads and bytes read from the file. */
+		struct Statistics
+		{
+			Statistics(void);
+
+			::size_t nReads;
+			::size_t nBytesRead;
+		};
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** @exception std::runtime_error	if the file is smaller than the image */
+		RawImageFile(const std::string &path, const Size3D<SizeType> &sz, ImageFormat fmt,
+			::size_t headerOffset = 0, ByteOrder byteOrder = GetNativeByteOrder());
+
+		/** Opens a file described by ReadEnviHeader().
+
+		@exception std::invalid_argument	if the data type is not matched with T */
+		RawImageFile(const std::string &path, const RawFileInfo &info);
+
+		//////////////////////////////////////////////////
+		// Accessors.
+		const Size3D<SizeType> &size;
+		const ImageFormat &format;
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** Reads all bands of an ROI to an image of the same format. */
+		void Read(const Region<SizeType, SizeType> &roi, Image<T> &imgDst);
+
+		/** Reads bands of an ROI, where channel k of the destination image is bands[k].
+
+		@exception std::out_of_range	if the ROI or a band is out of the image */
+		void Read(const Region<SizeType, SizeType> &roi, const std::vector<SizeType> &bands,
+			Image<T> &imgDst);
+
+		void SetMaxGap(::size_t nBytes);
+		void SetBufferSize(::size_t nBytes);
+
+		Statistics GetStatistics(void) const;
+		void ResetStatistics(void);
+
+	protected:
+		//////////////////////////////////////////////////
+		// Methods.
+		void Open(const std::string &path);
+
+		/** Reads the lines of bands [band, band + nBands) of an ROI, and copies them to
+		every destination channel k where bands[k] is in the range. */
+		void ReadBands(const Region<SizeType, SizeType> &roi, SizeType band,
+			SizeType nBands, const std::vector<SizeType> &bands, const ImageView<T> &dst);
+
+		//////////////////////////////////////////////////
+		// Data.
+		RandomAccessFile file_;
+		Size3D<SizeType> size_;
+		ImageFormat format_;
+		Point3D<SizeType> step_;	// steps of elements in the file
+		::size_t headerOffset_;
+		bool isByteSwapped_;
+		::size_t nBytesMaxGap_;
+		::size_t nBytesBuffer_;
+		std::vector<T> buffer_;
+		Statistics stats_;
+	};
+
+	/** Reverses the byte order of all elements of a view in place. */
+	template <typename T, RangeCheck R>
+	void SwapBytes(const ImageView<T, R> &view);
+}
+
+#include "raw_file_inl.h"
+
+#endif
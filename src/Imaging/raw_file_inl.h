@@ -0,0 +1,855 @@
+#if !defined(RAW_FILE_INL_H)
+#define RAW_FILE_INL_H
+
+namespace Imaging
+{
+	inline ByteOrder GetNativeByteOrder(void)
+	{
+		const unsigned short value = 1;
+		unsigned char bytes[sizeof(value)];
+		std::memcpy(bytes, &value, sizeof(value));
+		return bytes[0] == 1 ? ByteOrder::LITTLE : ByteOrder::BIG;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// RawFileInfo struct
+
+	inline RawFileInfo::RawFileInfo(void) : size(0, 0, 0), format(ImageFormat::UNKNOWN),
+		dataType(ImageDataType::UINT8), headerOffset(0), byteOrder(ByteOrder::LITTLE) {}
+
+	/** A value in braces may continue to the following lines, e.g., description, and it
+	is skipped until the closing brace. */
+	inline RawFileInfo ReadEnviHeader(const std::string &path)
+	{
+		std::ifstream file(path.c_str());
+		std::string line;
+		if (!std::getline(file, line) || line.compare(0, 4, "ENVI") != 0)
+		{
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " is not an ENVI header.";
+			throw std::runtime_error(errMsg.str());
+		}
+
+		RawFileInfo info;
+		int nFields = 0;	// required fields found.
+		while (std::getline(file, line))
+		{
+			const ::size_t pos = line.find('=');
+			if (pos == std::string::npos)
+				continue;
+
+			std::string key = line.substr(0, pos), value = line.substr(pos + 1);
+			key.erase(0, key.find_first_not_of(" \t"));
+			key.erase(key.find_last_not_of(" \t\r") + 1);
+			std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+			value.erase(0, value.find_first_not_of(" \t"));
+			value.erase(value.find_last_not_of(" \t\r") + 1);
+			if (!value.empty() && value[0] == '{')
+			{
+				while (value.find('}') == std::string::npos && std::getline(file, line))
+					value += line;
+				continue;
+			}
+			std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+			std::istringstream stream(value);
+			if (key == "samples" && (stream >> info.size.width))
+				++nFields;
+			else if (key == "lines" && (stream >> info.size.height))
+				++nFields;
+			else if (key == "bands" && (stream >> info.size.depth))
+				++nFields;
+			else if (key == "header offset")
+				stream >> info.headerOffset;
+			else if (key == "byte order")
+			{
+				int order = 0;
+				stream >> order;
+				info.byteOrder = order == 0 ? ByteOrder::LITTLE : ByteOrder::BIG;
+			}
+			else if (key == "interleave")
+			{
+				if (value == "bip")
+					info.format = ImageFormat::BIP;
+				else if (value == "bsq")
+					info.format = ImageFormat::BSQ;
+				else if (value == "bil")
+					info.format = ImageFormat::BIL;
+				else
+				{
+					std::ostringstream errMsg;
+					errMsg << "Interleave " << value << " is not supported.";
+					throw std::runtime_error(errMsg.str());
+				}
+				++nFields;
+			}
+			else if (key == "data type")
+			{
+				int type = 0;
+				stream >> type;
+				switch (type)
+				{
+				case 1:
+					info.dataType = ImageDataType::UINT8;
+					break;
+				case 2:
+					info.dataType = ImageDataType::INT16;
+					break;
+				case 3:
+					info.dataType = ImageDataType::INT32;
+					break;
+				case 4:
+					info.dataType = ImageDataType::FLOAT32;
+					break;
+				case 5:
+					info.dataType = ImageDataType::FLOAT64;
+					break;
+				case 12:
+					info.dataType = ImageDataType::UINT16;
+					break;
+				case 13:
+					info.dataType = ImageDataType::UINT32;
+					break;
+				case 14:
+					info.dataType = ImageDataType::INT64;
+					break;
+				case 15:
+					info.dataType = ImageDataType::UINT64;
+					break;
+				default:
+					std::ostringstream errMsg;
+					errMsg << "Data type " << type << " is not supported.";
+					throw std::runtime_error(errMsg.str());
+				}
+				++nFields;
+			}
+		}
+
+		if (nFields != 5)
+		{
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " lacks samples, lines, bands, data type or " <<
+				"interleave.";
+			throw std::runtime_error(errMsg.str());
+		}
+		return info;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// MappedFile class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+#if defined(_WIN32)
+	inline MappedFile::MappedFile(void) : data_(nullptr), size_(0),
+		file_(INVALID_HANDLE_VALUE), mapping_(nullptr) {}
+#else
+	inline MappedFile::MappedFile(void) : data_(nullptr), size_(0), file_(-1) {}
+#endif
+
+	inline MappedFile::~MappedFile(void)
+	{
+		this->Close();
+	}
+
+#if defined(_WIN32)
+	inline MappedFile::MappedFile(MappedFile &&src) IMAGING_NOEXCEPT : data_(src.data_),
+		size_(src.size_), file_(src.file_), mapping_(src.mapping_)
+	{
+		src.data_ = nullptr;
+		src.size_ = 0;
+		src.file_ = INVALID_HANDLE_VALUE;
+		src.mapping_ = nullptr;
+	}
+#else
+	inline MappedFile::MappedFile(MappedFile &&src) IMAGING_NOEXCEPT : data_(src.data_),
+		size_(src.size_), file_(src.file_)
+	{
+		src.data_ = nullptr;
+		src.size_ = 0;
+		src.file_ = -1;
+	}
+#endif
+
+	inline MappedFile &MappedFile::operator=(MappedFile &&src) IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->Close();
+			std::swap(this->data_, src.data_);
+			std::swap(this->size_, src.size_);
+			std::swap(this->file_, src.file_);
+#if defined(_WIN32)
+			std::swap(this->mapping_, src.mapping_);
+#endif
+		}
+		return *this;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	inline MappedFile::MappedFile(const std::string &path, AccessPattern pattern) :
+#if _MSC_VER > 1700	// from VS2013
+		MappedFile()
+#elif defined(_WIN32)	// up to VS2012
+		data_(nullptr), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#else
+		data_(nullptr), size_(0), file_(-1)
+#endif
+	{
+		this->Open(path, pattern);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	/** An empty file cannot be mapped, so it is opened without a mapping. */
+	inline void MappedFile::Open(const std::string &path, AccessPattern pattern)
+	{
+		this->Close();
+
+#if defined(_WIN32)
+		DWORD flags = FILE_ATTRIBUTE_NORMAL;
+		if (pattern == AccessPattern::SEQUENTIAL)
+			flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+		else if (pattern == AccessPattern::RANDOM)
+			flags |= FILE_FLAG_RANDOM_ACCESS;
+		this->file_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, flags, nullptr);
+		LARGE_INTEGER size;
+		if (this->file_ == INVALID_HANDLE_VALUE || !::GetFileSizeEx(this->file_, &size))
+		{
+			this->Close();
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " cannot be opened.";
+			throw std::runtime_error(errMsg.str());
+		}
+		this->size_ = static_cast< ::size_t>(size.QuadPart);
+		if (this->size_ == 0)
+			return;
+
+		this->mapping_ = ::CreateFileMappingA(this->file_, nullptr, PAGE_READONLY, 0, 0,
+			nullptr);
+		if (this->mapping_ != nullptr)
+			this->data_ = static_cast<const unsigned char *>(::MapViewOfFile(this->mapping_,
+			FILE_MAP_READ, 0, 0, 0));
+#else
+		this->file_ = ::open(path.c_str(), O_RDONLY);
+		struct stat status;
+		if (this->file_ < 0 || ::fstat(this->file_, &status) != 0)
+		{
+			this->Close();
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " cannot be opened.";
+			throw std::runtime_error(errMsg.str());
+		}
+		this->size_ = static_cast< ::size_t>(status.st_size);
+		if (this->size_ == 0)
+			return;
+
+		void *data = ::mmap(nullptr, this->size_, PROT_READ, MAP_SHARED, this->file_, 0);
+		if (data != MAP_FAILED)
+			this->data_ = static_cast<const unsigned char *>(data);
+#endif
+		if (this->data_ == nullptr)
+		{
+			this->Close();
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " cannot be mapped.";
+			throw std::runtime_error(errMsg.str());
+		}
+		this->Advise(pattern, 0, this->size_);
+	}
+
+	inline void MappedFile::Close(void)
+	{
+#if defined(_WIN32)
+		if (this->data_ != nullptr)
+			::UnmapViewOfFile(this->data_);
+		if (this->mapping_ != nullptr)
+			::CloseHandle(this->mapping_);
+		if (this->file_ != INVALID_HANDLE_VALUE)
+			::CloseHandle(this->file_);
+		this->mapping_ = nullptr;
+		this->file_ = INVALID_HANDLE_VALUE;
+#else
+		if (this->data_ != nullptr)
+			::munmap(const_cast<unsigned char *>(this->data_), this->size_);
+		if (this->file_ >= 0)
+			::close(this->file_);
+		this->file_ = -1;
+#endif
+		this->data_ = nullptr;
+		this->size_ = 0;
+	}
+
+	inline bool MappedFile::IsOpen(void) const
+	{
+#if defined(_WIN32)
+		return this->file_ != INVALID_HANDLE_VALUE;
+#else
+		return this->file_ >= 0;
+#endif
+	}
+
+	inline const unsigned char *MappedFile::GetData(void) const
+	{
+		return this->data_;
+	}
+
+	inline ::size_t MappedFile::GetSize(void) const
+	{
+		return this->size_;
+	}
+
+	/** A hint is not an error even if the operating system ignores it. */
+	inline void MappedFile::Advise(AccessPattern pattern, ::size_t offset,
+		::size_t nBytes) const
+	{
+		if (this->data_ == nullptr || offset >= this->size_ || nBytes == 0)
+			return;
+		nBytes = std::min(nBytes, this->size_ - offset);
+
+#if defined(_WIN32)
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602	// from Windows 8
+		if (pattern == AccessPattern::WILL_NEED)
+		{
+			WIN32_MEMORY_RANGE_ENTRY range;
+			range.VirtualAddress = const_cast<unsigned char *>(this->data_ + offset);
+			range.NumberOfBytes = nBytes;
+			::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+		}
+#endif
+#else
+		// madvise() requires the address aligned to a page.
+		const ::size_t nBytesPage = static_cast< ::size_t>(::sysconf(_SC_PAGESIZE));
+		const ::size_t begin = offset / nBytesPage * nBytesPage;
+		int advice = MADV_NORMAL;
+		switch (pattern)
+		{
+		case AccessPattern::SEQUENTIAL:
+			advice = MADV_SEQUENTIAL;
+			break;
+		case AccessPattern::RANDOM:
+			advice = MADV_RANDOM;
+			break;
+		case AccessPattern::WILL_NEED:
+			advice = MADV_WILLNEED;
+			break;
+		default:
+			break;
+		}
+		::madvise(const_cast<unsigned char *>(this->data_ + begin), offset + nBytes - begin,
+			advice);
+#endif
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// MappedImage<T> class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	template <typename T>
+	MappedImage<T>::MappedImage(const std::string &path, const Size3D<SizeType> &sz,
+		ImageFormat fmt, ::size_t headerOffset, ByteOrder byteOrder,
+		AccessPattern pattern) : size(size_), format(format_), size_(sz), format_(fmt),
+		headerOffset_(headerOffset), isByteSwapped_(byteOrder != GetNativeByteOrder())
+	{
+		this->Map(path, pattern);
+	}
+
+	template <typename T>
+	MappedImage<T>::MappedImage(const std::string &path, const RawFileInfo &info,
+		AccessPattern pattern) : size(size_), format(format_), size_(info.size),
+		format_(info.format), headerOffset_(info.headerOffset),
+		isByteSwapped_(info.byteOrder != GetNativeByteOrder())
+	{
+		if (info.dataType != DataTypeOf<T>::value)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Data type " << static_cast<int>(info.dataType) <<
+				" is not matched with " << static_cast<int>(DataTypeOf<T>::value) << ".";
+			throw std::invalid_argument(errMsg.str());
+		}
+		this->Map(path, pattern);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Accessors.
+	template <typename T>
+	ImageView<const T> MappedImage<T>::GetView(void) const
+	{
+		if (this->isByteSwapped_)
+			throw std::logic_error(
+			"Image data in a different byte order cannot be viewed. Use Load().");
+		return this->GetRawView();
+	}
+
+	template <typename T>
+	ImageView<const T> MappedImage<T>::GetView(const Region<SizeType, SizeType> &roi) const
+	{
+		return this->GetView().GetView(roi);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+	template <typename T>
+	void MappedImage<T>::Load(const Region<SizeType, SizeType> &roi, Image<T> &imgDst) const
+	{
+		Copy(this->GetRawView().GetView(roi), imgDst);
+		if (this->isByteSwapped_)
+			SwapBytes(imgDst.GetView());
+	}
+
+	template <typename T>
+	void MappedImage<T>::Advise(AccessPattern pattern) const
+	{
+		this->file_.Advise(pattern, this->headerOffset_,
+			this->size.width * this->size.height * this->size.depth * sizeof(T));
+	}
+
+	/** BIP and BIL lines of a row are continuous, so the rows of an ROI are a single
+	range. BSQ rows are continuous for each band. */
+	template <typename T>
+	void MappedImage<T>::Advise(AccessPattern pattern,
+		const Region<SizeType, SizeType> &roi) const
+	{
+		const ImageView<const T> view = this->GetRawView().GetView(roi);
+		if (view.size.width == 0 || view.size.height == 0 || view.size.depth == 0)
+			return;
+
+		const ::size_t nBytesRow = view.step.y * sizeof(T);
+		const ::size_t nChannels = this->format == ImageFormat::BSQ ? view.size.depth : 1;
+		for (::size_t C = 0; C != nChannels; ++C)
+		{
+			const ::size_t offset = reinterpret_cast<const unsigned char *>(
+				view.GetPointer(0, 0, C) - view.step.x * roi.origin.x) - this->file_.GetData();
+			this->file_.Advise(pattern, offset, nBytesRow * view.size.height);
+		}
+	}
+
+	template <typename T>
+	bool MappedImage<T>::IsByteSwapped(void) const
+	{
+		return this->isByteSwapped_;
+	}
+
+	template <typename T>
+	void MappedImage<T>::Map(const std::string &path, AccessPattern pattern)
+	{
+		if (this->headerOffset_ % std::alignment_of<T>::value != 0)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Header offset " << this->headerOffset_ << " is not a multiple of " <<
+				std::alignment_of<T>::value << " bytes.";
+			throw std::invalid_argument(errMsg.str());
+		}
+
+		this->file_.Open(path, pattern);
+		const ::size_t nBytes = this->size.width * this->size.height * this->size.depth *
+			sizeof(T);
+		if (this->file_.GetSize() < this->headerOffset_ + nBytes)
+		{
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " is smaller than " <<
+				this->headerOffset_ + nBytes << " bytes.";
+			throw std::runtime_error(errMsg.str());
+		}
+	}
+
+	/** The pages are aligned, so the elements are aligned if the header offset is a
+	multiple of the alignment of T. */
+	template <typename T>
+	ImageView<const T> MappedImage<T>::GetRawView(void) const
+	{
+		const T *data = reinterpret_cast<const T *>(this->file_.GetData() +
+			this->headerOffset_);
+		return ImageView<const T>(data, this->size, this->format,
+			this->format == ImageFormat::BIP ? this->size.width * this->size.depth :
+			this->size.width);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// RandomAccessFile class
+
+	//////////////////////////////////////////////////////////////////////////
+	// Default constructors.
+#if defined(_WIN32)
+	inline RandomAccessFile::RandomAccessFile(void) : size_(0),
+		file_(INVALID_HANDLE_VALUE) {}
+#else
+	inline RandomAccessFile::RandomAccessFile(void) : size_(0), file_(-1) {}
+#endif
+
+	inline RandomAccessFile::~RandomAccessFile(void)
+	{
+		this->Close();
+	}
+
+	inline RandomAccessFile::RandomAccessFile(RandomAccessFile &&src) IMAGING_NOEXCEPT :
+		size_(src.size_), file_(src.file_)
+	{
+		src.size_ = 0;
+#if defined(_WIN32)
+		src.file_ = INVALID_HANDLE_VALUE;
+#else
+		src.file_ = -1;
+#endif
+	}
+
+	inline RandomAccessFile &RandomAccessFile::operator=(RandomAccessFile &&src)
+		IMAGING_NOEXCEPT
+	{
+		if (this != &src)
+		{
+			this->Close();
+			std::swap(this->size_, src.size_);
+			std::swap(this->file_, src.file_);
+		}
+		return *this;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	inline RandomAccessFile::RandomAccessFile(const std::string &path) :
+#if _MSC_VER > 1700	// from VS2013
+		RandomAccessFile()
+#elif defined(_WIN32)	// up to VS2012
+		size_(0), file_(INVALID_HANDLE_VALUE)
+#else
+		size_(0), file_(-1)
+#endif
+	{
+		this->Open(path);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+	inline void RandomAccessFile::Open(const std::string &path)
+	{
+		this->Close();
+
+#if defined(_WIN32)
+		this->file_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+		LARGE_INTEGER size;
+		const bool isOpen = this->file_ != INVALID_HANDLE_VALUE &&
+			::GetFileSizeEx(this->file_, &size);
+		if (isOpen)
+			this->size_ = static_cast<std::uint64_t>(size.QuadPart);
+#else
+		this->file_ = ::open(path.c_str(), O_RDONLY);
+		struct stat status;
+		const bool isOpen = this->file_ >= 0 && ::fstat(this->file_, &status) == 0;
+		if (isOpen)
+			this->size_ = static_cast<std::uint64_t>(status.st_size);
+#endif
+		if (!isOpen)
+		{
+			this->Close();
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " cannot be opened.";
+			throw std::runtime_error(errMsg.str());
+		}
+	}
+
+	inline void RandomAccessFile::Close(void)
+	{
+#if defined(_WIN32)
+		if (this->file_ != INVALID_HANDLE_VALUE)
+			::CloseHandle(this->file_);
+		this->file_ = INVALID_HANDLE_VALUE;
+#else
+		if (this->file_ >= 0)
+			::close(this->file_);
+		this->file_ = -1;
+#endif
+		this->size_ = 0;
+	}
+
+	inline bool RandomAccessFile::IsOpen(void) const
+	{
+#if defined(_WIN32)
+		return this->file_ != INVALID_HANDLE_VALUE;
+#else
+		return this->file_ >= 0;
+#endif
+	}
+
+	inline std::uint64_t RandomAccessFile::GetSize(void) const
+	{
+		return this->size_;
+	}
+
+	/** A read may return fewer bytes than requested, so the rest is read again. */
+	inline void RandomAccessFile::Read(std::uint64_t offset, ::size_t nBytes,
+		void *dst) const
+	{
+		unsigned char *p = static_cast<unsigned char *>(dst);
+		while (nBytes != 0)
+		{
+#if defined(_WIN32)
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD nBytesRead = 0;
+			const DWORD nBytesRequested = static_cast<DWORD>(
+				std::min< ::size_t>(nBytes, 1 << 30));
+			if (!::ReadFile(this->file_, p, nBytesRequested, &nBytesRead, &overlapped))
+				nBytesRead = 0;
+#else
+			const ssize_t nBytesRead = ::pread(this->file_, p, nBytes,
+				static_cast<off_t>(offset));
+			if (nBytesRead < 0 && errno == EINTR)
+				continue;
+#endif
+			if (nBytesRead <= 0)
+			{
+				std::ostringstream errMsg;
+				errMsg << nBytes << " bytes at " << offset << " cannot be read.";
+				throw std::runtime_error(errMsg.str());
+			}
+			p += nBytesRead;
+			offset += nBytesRead;
+			nBytes -= nBytesRead;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// RawImageFile<T> class
+
+	template <typename T>
+	RawImageFile<T>::Statistics::Statistics(void) : nReads(0), nBytesRead(0) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	template <typename T>
+	RawImageFile<T>::RawImageFile(const std::string &path, const Size3D<SizeType> &sz,
+		ImageFormat fmt, ::size_t headerOffset, ByteOrder byteOrder) : size(size_),
+		format(format_), size_(sz), format_(fmt), headerOffset_(headerOffset),
+		isByteSwapped_(byteOrder != GetNativeByteOrder()), nBytesMaxGap_(DEFAULT_MAX_GAP),
+		nBytesBuffer_(DEFAULT_BUFFER_SIZE)
+	{
+		this->Open(path);
+	}
+
+	template <typename T>
+	RawImageFile<T>::RawImageFile(const std::string &path, const RawFileInfo &info) :
+		size(size_), format(format_), size_(info.size), format_(info.format),
+		headerOffset_(info.headerOffset),
+		isByteSwapped_(info.byteOrder != GetNativeByteOrder()),
+		nBytesMaxGap_(DEFAULT_MAX_GAP), nBytesBuffer_(DEFAULT_BUFFER_SIZE)
+	{
+		if (info.dataType != DataTypeOf<T>::value)
+		{
+			std::ostringstream errMsg;
+			errMsg << "Data type " << static_cast<int>(info.dataType) <<
+				" is not matched with " << static_cast<int>(DataTypeOf<T>::value) << ".";
+			throw std::invalid_argument(errMsg.str());
+		}
+		this->Open(path);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+	template <typename T>
+	void RawImageFile<T>::Read(const Region<SizeType, SizeType> &roi, Image<T> &imgDst)
+	{
+		std::vector<SizeType> bands(this->size.depth);
+		for (SizeType C = 0; C != bands.size(); ++C)
+			bands[C] = C;
+		this->Read(roi, bands, imgDst);
+	}
+
+	/** Bands of BIP are interleaved in every pixel, so the lines of all bands between the
+	first and the last ones are read at once. Consecutive bands of BIL are read at once
+	unless the gap between the lines of two bands is large. Each band of BSQ is read
+	separately. */
+	template <typename T>
+	void RawImageFile<T>::Read(const Region<SizeType, SizeType> &roi,
+		const std::vector<SizeType> &bands, Image<T> &imgDst)
+	{
+		if (roi.origin.x + roi.size.width > this->size.width ||
+			roi.origin.y + roi.size.height > this->size.height)
+		{
+			std::ostringstream errMsg;
+			errMsg << "ROI (" << roi.origin.x << ", " << roi.origin.y << ", " <<
+				roi.size.width << ", " << roi.size.height << ") is out of the image.";
+			throw std::out_of_range(errMsg.str());
+		}
+		for (auto it = bands.begin(); it != bands.end(); ++it)
+		{
+			if (*it >= this->size.depth)
+			{
+				std::ostringstream errMsg;
+				errMsg << "Band " << *it << " is out of " << this->size.depth << " bands.";
+				throw std::out_of_range(errMsg.str());
+			}
+		}
+
+		imgDst.SetFormat(this->format);
+		imgDst.resize(Size3D<SizeType>(roi.size.width, roi.size.height, bands.size()),
+			ResizeMode::UNINITIALIZED);
+		if (roi.size.width == 0 || roi.size.height == 0 || bands.empty())
+			return;
+		const ImageView<T> dst = imgDst.GetView();
+
+		if (this->format == ImageFormat::BIP)
+		{
+			const auto range = std::minmax_element(bands.begin(), bands.end());
+			this->ReadBands(roi, *range.first, *range.second - *range.first + 1, bands, dst);
+		}
+		else
+		{
+			const bool isGapSmall = this->format == ImageFormat::BIL &&
+				(this->size.width - roi.size.width) * sizeof(T) <= this->nBytesMaxGap_;
+			for (SizeType K = 0; K != bands.size(); )
+			{
+				SizeType nBands = 1;
+				while (isGapSmall && K + nBands != bands.size() &&
+					bands[K + nBands] == bands[K] + nBands)
+					++nBands;
+				this->ReadBands(roi, bands[K], nBands, bands, dst);
+				K += nBands;
+			}
+		}
+
+		if (this->isByteSwapped_)
+			SwapBytes(dst);
+	}
+
+	template <typename T>
+	void RawImageFile<T>::SetMaxGap(::size_t nBytes)
+	{
+		this->nBytesMaxGap_ = nBytes;
+	}
+
+	template <typename T>
+	void RawImageFile<T>::SetBufferSize(::size_t nBytes)
+	{
+		this->nBytesBuffer_ = nBytes;
+		std::vector<T>().swap(this->buffer_);
+	}
+
+	template <typename T>
+	typename RawImageFile<T>::Statistics RawImageFile<T>::GetStatistics(void) const
+	{
+		return this->stats_;
+	}
+
+	template <typename T>
+	void RawImageFile<T>::ResetStatistics(void)
+	{
+		this->stats_ = Statistics();
+	}
+
+	/** The steps of the file are those of a view of the file without padding. */
+	template <typename T>
+	void RawImageFile<T>::Open(const std::string &path)
+	{
+		this->step_ = ImageView<const T>(nullptr, this->size, this->format,
+			this->format == ImageFormat::BIP ? this->size.width * this->size.depth :
+			this->size.width).step;
+
+		this->file_.Open(path);
+		const std::uint64_t nBytes = static_cast<std::uint64_t>(this->size.width) *
+			this->size.height * this->size.depth * sizeof(T);
+		if (this->file_.GetSize() < this->headerOffset_ + nBytes)
+		{
+			std::ostringstream errMsg;
+			errMsg << "File " << path << " is smaller than " <<
+				this->headerOffset_ + nBytes << " bytes.";
+			throw std::runtime_error(errMsg.str());
+		}
+	}
+
+	/** A line is the range of elements of a row from the first pixel to the last one,
+	and from the first band to the last one. Rows are read by chunks which fit into the
+	staging buffer, where a chunk is read at once including the gaps between the lines if
+	the gap is small, or line by line without the gaps. Either way, the chunk is a view
+	of the file with a different row step. */
+	template <typename T>
+	void RawImageFile<T>::ReadBands(const Region<SizeType, SizeType> &roi, SizeType band,
+		SizeType nBands, const std::vector<SizeType> &bands, const ImageView<T> &dst)
+	{
+		const Point3D<SizeType> &step = this->step_;
+		const ::size_t nElemLine = (roi.size.width - 1) * step.x + (nBands - 1) * step.z + 1;
+		const bool isCoalesced = (step.y - nElemLine) * sizeof(T) <= this->nBytesMaxGap_;
+		const ::size_t nElemPerLine = isCoalesced ? step.y : nElemLine;
+
+		const ::size_t nElemBuffer = this->nBytesBuffer_ / sizeof(T);
+		const SizeType nRowsChunk = std::min(roi.size.height, nElemBuffer < nElemLine ? 1 :
+			(nElemBuffer - nElemLine) / nElemPerLine + 1);
+		const ::size_t nElemChunk = (nRowsChunk - 1) * nElemPerLine + nElemLine;
+		if (this->buffer_.size() < nElemChunk)
+			this->buffer_.resize(nElemChunk);
+
+		for (SizeType Y0 = 0; Y0 < roi.size.height; Y0 += nRowsChunk)
+		{
+			const SizeType nRows = std::min(nRowsChunk, roi.size.height - Y0);
+			const std::uint64_t offset = this->headerOffset_ + sizeof(T) *
+				(static_cast<std::uint64_t>(roi.origin.y + Y0) * step.y +
+				static_cast<std::uint64_t>(roi.origin.x) * step.x +
+				static_cast<std::uint64_t>(band) * step.z);
+			if (isCoalesced)
+			{
+				const ::size_t nBytes = ((nRows - 1) * nElemPerLine + nElemLine) * sizeof(T);
+				this->file_.Read(offset, nBytes, this->buffer_.data());
+				++this->stats_.nReads;
+				this->stats_.nBytesRead += nBytes;
+			}
+			else
+			{
+				for (SizeType H = 0; H != nRows; ++H)
+				{
+					this->file_.Read(offset + static_cast<std::uint64_t>(H) * step.y *
+						sizeof(T), nElemLine * sizeof(T), &this->buffer_[H * nElemLine]);
+					++this->stats_.nReads;
+					this->stats_.nBytesRead += nElemLine * sizeof(T);
+				}
+			}
+
+			// Copy the runs of consecutive bands in the range at once.
+			const ImageView<const T> src(this->buffer_.data(),
+				Size3D<SizeType>(roi.size.width, nRows, nBands), this->format,
+				Point3D<SizeType>(step.x, nElemPerLine, step.z));
+			for (SizeType K = 0; K != bands.size(); )
+			{
+				if (bands[K] < band || bands[K] >= band + nBands)
+				{
+					++K;
+					continue;
+				}
+				SizeType nChannels = 1;
+				while (K + nChannels != bands.size() &&
+					bands[K + nChannels] == bands[K] + nChannels &&
+					bands[K + nChannels] < band + nBands)
+					++nChannels;
+				const Size3D<SizeType> sz(roi.size.width, nRows, nChannels);
+				Copy(ImageView<const T>(src.GetPointer(0, 0, bands[K] - band), sz,
+					this->format, src.step),
+					ImageView<T>(dst.GetPointer(0, Y0, K), sz, this->format, dst.step));
+				K += nChannels;
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	template <typename T, RangeCheck R>
+	void SwapBytes(const ImageView<T, R> &view)
+	{
+		for (typename ImageView<T, R>::SizeType C = 0; C != view.size.depth; ++C)
+		{
+			for (typename ImageView<T, R>::SizeType H = 0; H != view.size.height; ++H)
+			{
+				T *p = view.GetPointer(0, H, C);
+				for (typename ImageView<T, R>::SizeType W = 0; W != view.size.width; ++W)
+					p[W * view.step.x] = SwapBytes(p[W * view.step.x]);
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,217 @@
+#if !defined(THREAD_POOL_H)
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// thread_local is supported from VS2015.
+#if defined(_MSC_VER) && _MSC_VER < 1900	// up to VS2013
+#define IMAGING_THREAD_LOCAL __declspec(thread)
+#else
+#define IMAGING_THREAD_LOCAL thread_local
+#endif
+
+namespace Imaging
+{
+	/** Runs parallel loops by a fixed set of worker threads shared by the entire library,
+	so kernels running at the same time never oversubscribe the cores.
+
+	A loop is divided into tasks of a grain of indices. Each worker has its own deque of
+	tasks, takes the newest task of its own deque, and steals the oldest task of another
+	deque if its own deque is empty, so the load is balanced without a central queue.
+	A thread waiting for a loop runs tasks while waiting, so a loop nested in a task
+	neither adds threads nor deadlocks.
+	The calling thread counts as one of the threads, so a pool of N threads has N - 1
+	workers. */
+	class ThreadPool
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** @param [in] nThreads	the number of threads including the calling thread, or
+		zero for the number of hardware threads */
+		explicit ThreadPool(::size_t nThreads = 0);
+		~ThreadPool(void);
+
+		//////////////////////////////////////////////////
+		// Methods.
+
+		/** Returns the pool shared by the library, e.g., by ParallelFor(). */
+		static ThreadPool &GetInstance(void);
+
+		::size_t GetThreadCount(void) const;
+
+		/** Restarts the workers for a number of threads, or the number of hardware threads
+		if it is zero.
+
+		@NOTE It must not be called while a loop is running. */
+		void SetThreadCount(::size_t nThreads);
+
+		/** Pins worker k to logical processor k + 1, so processor 0 is left for the
+		calling thread, or lets the operating system move the workers. The affinity is
+		ignored on a platform without the API.
+
+		@NOTE It must not be called while a loop is running. */
+		void SetAffinity(bool isPinned);
+		bool GetAffinity(void) const;
+
+		/** Calls func(i) for every index i in [begin, end), where a task is a range of
+		grain indices, or of a size giving 4 tasks for each thread if grain is zero.
+
+		An exception thrown by func is rethrown after all tasks have finished, and the
+		tasks which have not started yet are skipped. */
+		template <typename Function>
+		void ParallelFor(::size_t begin, ::size_t end, ::size_t grain, Function &func);
+
+	protected:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		struct Job;
+
+		struct Task
+		{
+			Job *job;
+			::size_t begin;
+			::size_t end;
+		};
+
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+			std::thread thread;
+		};
+
+		//////////////////////////////////////////////////
+		// Methods.
+		void Start(::size_t nThreads);
+		void Stop(void);
+
+		/** The main loop of a worker. */
+		void Run(::size_t index);
+
+		/** Takes a task from the deque of the worker, or steals a task from another deque.
+		index is the number of workers for a thread which is not a worker. */
+		bool TryPop(::size_t index, Task &task);
+		void Execute(const Task &task);
+
+		/** Wakes the workers and the waiting threads for pushed tasks. */
+		void Notify(void);
+
+		/** Runs tasks until all tasks of the job have finished, and sleeps while no task can
+		be taken. */
+		void Wait(const Job &job, ::size_t index);
+
+		/** Returns the index of the calling thread if it is a worker of this pool, or the
+		number of workers otherwise. */
+		::size_t GetWorkerIndex(void) const;
+
+		template <typename Function>
+		static void RunRange(void *func, ::size_t begin, ::size_t end);
+
+		static void Pin(::size_t index);
+
+		//////////////////////////////////////////////////
+		// Data.
+		std::vector<std::unique_ptr<Worker> > workers_;
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		std::condition_variable cvWait_;	// a job has finished, or tasks are pushed.
+		std::atomic< ::size_t> nPending_;	// tasks in the deques
+		bool isStopping_;
+		bool isPinned_;
+		::size_t nThreads_;
+
+	private:
+		// Not copyable because the object owns the threads.
+		ThreadPool(const ThreadPool &);
+		ThreadPool &operator=(const ThreadPool &);
+	};
+
+	/** Borrows an object of type T kept for the calling thread, so a kernel called
+	repeatedly reuses its buffers instead of allocating them on every call.
+
+	The object of a thread is created at the first use and destroyed at the exit of the
+	thread, so the objects of the workers of a restarted pool or of short-lived threads are
+	freed. If the thread has already borrowed it, e.g., in a task taken while the thread
+	waits for a loop, a temporary object is created instead. */
+	template <typename T>
+	class ThreadBuffer
+	{
+	public:
+		ThreadBuffer(void);
+		~ThreadBuffer(void);
+
+		T &operator*(void) const;
+		T *operator->(void) const;
+
+		/** Returns the number of objects kept for the running threads. */
+		static ::size_t GetObjectCount(void);
+
+	private:
+#if !defined(_MSC_VER) || _MSC_VER >= 1900	// from VS2015
+		/** Owns the object of a thread, and destroys it at the exit of the thread. */
+		struct Holder
+		{
+			Holder(void);
+			~Holder(void);
+
+			T *object;
+		};
+#endif
+
+		/** Returns the object of the calling thread, which is created at the first call. */
+		static T &GetLocalObject(void);
+		static bool &GetBorrowed(void);
+		static void Destroy(T *object);
+
+		T *object_;
+		std::unique_ptr<T> temp_;
+
+		static std::atomic< ::size_t> nObjects_;
+
+	private:
+		// Not copyable because the object is returned by the destructor.
+		ThreadBuffer(const ThreadBuffer &);
+		ThreadBuffer &operator=(const ThreadBuffer &);
+	};
+
+	/** Returns the number of threads of the shared thread pool. */
+	::size_t GetThreadCount(void);
+
+	/** Sets the number of threads of the shared thread pool, e.g., 1 to run everything on
+	the calling thread. Zero resets it to the number of hardware threads. */
+	void SetThreadCount(::size_t nThreads);
+
+	/** Calls func(i) for every index i in [begin, end) in parallel by the shared thread
+	pool. See ThreadPool::ParallelFor(). */
+	template <typename Function>
+	void ParallelFor(::size_t begin, ::size_t end, Function func, ::size_t grain = 0);
+}
+
+#include "thread_pool_inl.h"
+
+#endif
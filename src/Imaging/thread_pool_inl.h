@@ -0,0 +1,467 @@
+#if !defined(THREAD_POOL_INL_H)
+#define THREAD_POOL_INL_H
+
+namespace Imaging
+{
+	//////////////////////////////////////////////////////////////////////////
+	// ThreadPool class
+
+	/** A loop waiting for its tasks. It lives on the stack of the calling thread, so the
+	count of remaining tasks is decremented as the last access of a task. */
+	struct ThreadPool::Job
+	{
+		void (*run)(void *func, ::size_t begin, ::size_t end);
+		void *func;
+		std::atomic< ::size_t> nRemaining;
+		std::atomic<bool> isFailed;
+		std::exception_ptr error;
+		std::mutex mutex;	// for error
+	};
+
+	/** Identifies the pool and the index of a worker thread. */
+	struct ThreadPoolWorkerId
+	{
+		static const ThreadPool *&GetPool(void)
+		{
+			static IMAGING_THREAD_LOCAL const ThreadPool *pool = nullptr;
+			return pool;
+		}
+
+		static ::size_t &GetIndex(void)
+		{
+			static IMAGING_THREAD_LOCAL ::size_t index = 0;
+			return index;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	// Custom constructors.
+	inline ThreadPool::ThreadPool(::size_t nThreads) : nPending_(0), isStopping_(false),
+		isPinned_(false), nThreads_(1)
+	{
+		this->Start(nThreads);
+	}
+
+	inline ThreadPool::~ThreadPool(void)
+	{
+		this->Stop();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Methods.
+
+	/** The pool is created at the first use, and the workers are joined at exit. */
+	inline ThreadPool &ThreadPool::GetInstance(void)
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	inline ::size_t ThreadPool::GetThreadCount(void) const
+	{
+		return this->nThreads_;
+	}
+
+	inline void ThreadPool::SetThreadCount(::size_t nThreads)
+	{
+		if (nThreads == 0)
+			nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		if (nThreads == this->nThreads_)
+			return;
+		this->Stop();
+		this->Start(nThreads);
+	}
+
+	/** A worker pins itself when it starts, so the workers are restarted. */
+	inline void ThreadPool::SetAffinity(bool isPinned)
+	{
+		if (isPinned == this->isPinned_)
+			return;
+		const ::size_t nThreads = this->nThreads_;
+		this->Stop();
+		this->isPinned_ = isPinned;
+		this->Start(nThreads);
+	}
+
+	inline bool ThreadPool::GetAffinity(void) const
+	{
+		return this->isPinned_;
+	}
+
+	/** A loop of a single task runs on the calling thread without touching the deques. */
+	template <typename Function>
+	void ThreadPool::ParallelFor(::size_t begin, ::size_t end, ::size_t grain,
+		Function &func)
+	{
+		if (begin >= end)
+			return;
+
+		const ::size_t n = end - begin;
+		if (grain == 0)
+			grain = std::max< ::size_t>(n / (4 * this->nThreads_), 1);
+		const ::size_t nTasks = (n - 1) / grain + 1;
+		if (this->workers_.empty() || nTasks == 1)
+		{
+			for (::size_t I = begin; I != end; ++I)
+				func(I);
+			return;
+		}
+
+		Job job;
+		job.run = &ThreadPool::RunRange<Function>;
+		job.func = &func;
+		job.nRemaining = nTasks;
+		job.isFailed = false;
+
+		// A worker pushes the tasks to its own deque, and the other workers steal them.
+		// Another thread distributes the tasks over all deques.
+		const ::size_t index = this->GetWorkerIndex();
+		const ::size_t nWorkers = this->workers_.size();
+		{
+			std::lock_guard<std::mutex> lock(this->mutex_);
+			this->nPending_ += nTasks;
+		}
+		::size_t K = 0;
+		try
+		{
+			for (; K != nTasks; ++K)
+			{
+				const Task task = {&job, begin + K * grain,
+					std::min(begin + (K + 1) * grain, end)};
+				Worker &worker = *this->workers_[index != nWorkers ? index : K % nWorkers];
+				std::lock_guard<std::mutex> lock(worker.mutex);
+				worker.tasks.push_back(task);
+			}
+		}
+		catch (...)
+		{
+			// The tasks not pushed are dropped, and the pushed tasks are skipped but waited
+			// for, since they refer to the job on this stack.
+			this->nPending_ -= nTasks - K;
+			job.nRemaining -= nTasks - K;
+			job.isFailed = true;
+			this->Notify();
+			this->Wait(job, index);
+			throw;
+		}
+		this->Notify();
+
+		this->Wait(job, index);
+		if (job.error)
+			std::rethrow_exception(job.error);
+	}
+
+	/** The workers are created before any of them starts, so the deques are never
+	reallocated while the workers access them. */
+	inline void ThreadPool::Start(::size_t nThreads)
+	{
+		if (nThreads == 0)
+			nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		this->nThreads_ = nThreads;
+		for (::size_t N = 1; N < nThreads; ++N)
+			this->workers_.push_back(std::unique_ptr<Worker>(new Worker));
+		for (::size_t N = 0; N != this->workers_.size(); ++N)
+			this->workers_[N]->thread = std::thread(&ThreadPool::Run, this, N);
+	}
+
+	inline void ThreadPool::Stop(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex_);
+			this->isStopping_ = true;
+		}
+		this->cv_.notify_all();
+		for (auto it = this->workers_.begin(); it != this->workers_.end(); ++it)
+			if ((*it)->thread.joinable())
+				(*it)->thread.join();
+		this->workers_.clear();
+		this->isStopping_ = false;
+		this->nThreads_ = 1;
+	}
+
+	inline void ThreadPool::Run(::size_t index)
+	{
+		ThreadPoolWorkerId::GetPool() = this;
+		ThreadPoolWorkerId::GetIndex() = index;
+		if (this->isPinned_)
+			Pin(index);
+
+		for (;;)
+		{
+			Task task;
+			if (this->TryPop(index, task))
+			{
+				this->Execute(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(this->mutex_);
+			this->cv_.wait(lock, [this]
+			{
+				return this->isStopping_ || this->nPending_.load() != 0;
+			});
+			if (this->isStopping_)
+				return;
+		}
+	}
+
+	/** The own deque is used as a stack for the locality of nested loops, and the other
+	deques are used as queues, so a thief takes the largest remaining work. */
+	inline bool ThreadPool::TryPop(::size_t index, Task &task)
+	{
+		const ::size_t nWorkers = this->workers_.size();
+		if (index != nWorkers)
+		{
+			Worker &worker = *this->workers_[index];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			if (!worker.tasks.empty())
+			{
+				task = worker.tasks.back();
+				worker.tasks.pop_back();
+				--this->nPending_;
+				return true;
+			}
+		}
+
+		for (::size_t K = 1; K <= nWorkers; ++K)
+		{
+			Worker &victim = *this->workers_[(index + K) % nWorkers];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				task = victim.tasks.front();
+				victim.tasks.pop_front();
+				--this->nPending_;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline void ThreadPool::Execute(const Task &task)
+	{
+		Job &job = *task.job;
+		if (!job.isFailed)
+		{
+			try
+			{
+				job.run(job.func, task.begin, task.end);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(job.mutex);
+				if (!job.error)
+					job.error = std::current_exception();
+				job.isFailed = true;
+			}
+		}
+
+		// The job may be destroyed by its waiter as soon as the count becomes zero, so
+		// only the pool is accessed after the decrement.
+		if (--job.nRemaining == 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->mutex_);
+			}
+			this->cvWait_.notify_all();
+		}
+	}
+
+	/** A thread sleeps if all tasks of the job have been taken by other threads, until the
+	job finishes or tasks of another loop are pushed, e.g., by a nested loop of the job. */
+	inline void ThreadPool::Wait(const Job &job, ::size_t index)
+	{
+		while (job.nRemaining.load() != 0)
+		{
+			Task task;
+			if (this->TryPop(index, task))
+			{
+				this->Execute(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(this->mutex_);
+			this->cvWait_.wait(lock, [&]
+			{
+				return job.nRemaining.load() == 0 || this->nPending_.load() != 0;
+			});
+		}
+	}
+
+	inline void ThreadPool::Notify(void)
+	{
+		this->cv_.notify_all();
+		this->cvWait_.notify_all();
+	}
+
+	inline ::size_t ThreadPool::GetWorkerIndex(void) const
+	{
+		return ThreadPoolWorkerId::GetPool() == this ? ThreadPoolWorkerId::GetIndex() :
+			this->workers_.size();
+	}
+
+	template <typename Function>
+	void ThreadPool::RunRange(void *func, ::size_t begin, ::size_t end)
+	{
+		Function &f = *static_cast<Function *>(func);
+		for (::size_t I = begin; I != end; ++I)
+			f(I);
+	}
+
+	inline void ThreadPool::Pin(::size_t index)
+	{
+		const ::size_t nProcessors = std::max(std::thread::hardware_concurrency(), 1u);
+		const ::size_t processor = (index + 1) % nProcessors;
+#if defined(_WIN32)
+		::SetThreadAffinityMask(::GetCurrentThread(),
+			static_cast<DWORD_PTR>(1) << processor % (8 * sizeof(DWORD_PTR)));
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(processor, &set);
+		::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#endif
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// ThreadBuffer<T> class
+
+	template <typename T>
+	std::atomic< ::size_t> ThreadBuffer<T>::nObjects_(0);
+
+	template <typename T>
+	ThreadBuffer<T>::ThreadBuffer(void) : object_(nullptr)
+	{
+		bool &isBorrowed = GetBorrowed();
+		if (isBorrowed)
+		{
+			this->temp_.reset(new T);
+			this->object_ = this->temp_.get();
+			return;
+		}
+
+		this->object_ = &GetLocalObject();
+		isBorrowed = true;
+	}
+
+	template <typename T>
+	ThreadBuffer<T>::~ThreadBuffer(void)
+	{
+		if (!this->temp_)
+			GetBorrowed() = false;
+	}
+
+	template <typename T>
+	T &ThreadBuffer<T>::operator*(void) const
+	{
+		return *this->object_;
+	}
+
+	template <typename T>
+	T *ThreadBuffer<T>::operator->(void) const
+	{
+		return this->object_;
+	}
+
+	template <typename T>
+	::size_t ThreadBuffer<T>::GetObjectCount(void)
+	{
+		return nObjects_;
+	}
+
+#if !defined(_MSC_VER) || _MSC_VER >= 1900	// from VS2015
+	template <typename T>
+	ThreadBuffer<T>::Holder::Holder(void) : object(nullptr)
+	{
+	}
+
+	template <typename T>
+	ThreadBuffer<T>::Holder::~Holder(void)
+	{
+		if (this->object != nullptr)
+			Destroy(this->object);
+	}
+
+	template <typename T>
+	T &ThreadBuffer<T>::GetLocalObject(void)
+	{
+		static thread_local Holder holder;
+		if (holder.object == nullptr)
+		{
+			holder.object = new T;
+			++nObjects_;
+		}
+		return *holder.object;
+	}
+#else
+	/** A thread_local object cannot have a destructor up to VS2013, so the object is kept
+	in a fiber local storage slot whose callback destroys it at the exit of the thread. */
+	template <typename T>
+	T &ThreadBuffer<T>::GetLocalObject(void)
+	{
+		struct Slot
+		{
+			static void WINAPI Free(void *object)
+			{
+				if (object != nullptr)
+					Destroy(static_cast<T *>(object));
+			}
+
+			DWORD index;
+
+			Slot(void) : index(::FlsAlloc(&Slot::Free))
+			{
+				if (this->index == FLS_OUT_OF_INDEXES)
+					throw std::bad_alloc();
+			}
+		};
+
+		static Slot slot;
+		T *object = static_cast<T *>(::FlsGetValue(slot.index));
+		if (object == nullptr)
+		{
+			std::unique_ptr<T> p(new T);
+			if (!::FlsSetValue(slot.index, p.get()))
+				throw std::bad_alloc();
+			object = p.release();
+			++nObjects_;
+		}
+		return *object;
+	}
+#endif
+
+	template <typename T>
+	bool &ThreadBuffer<T>::GetBorrowed(void)
+	{
+		static IMAGING_THREAD_LOCAL bool isBorrowed = false;
+		return isBorrowed;
+	}
+
+	template <typename T>
+	void ThreadBuffer<T>::Destroy(T *object)
+	{
+		delete object;
+		--nObjects_;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Global functions
+
+	inline ::size_t GetThreadCount(void)
+	{
+		return ThreadPool::GetInstance().GetThreadCount();
+	}
+
+	inline void SetThreadCount(::size_t nThreads)
+	{
+		ThreadPool::GetInstance().SetThreadCount(nThreads);
+	}
+
+	template <typename Function>
+	void ParallelFor(::size_t begin, ::size_t end, Function func, ::size_t grain)
+	{
+		ThreadPool::GetInstance().ParallelFor(begin, end, grain, func);
+	}
+}
+
+#endif
@@ -3,8 +3,39 @@
 
 #include <array>
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+// SSE2 is always available for x64, and for x86 if it is enabled by the compiler.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGING_SSE2
+#include <emmintrin.h>
+#endif
+
+// constexpr and noexcept are supported from VS2015.
+#if defined(_MSC_VER) && _MSC_VER < 1900	// up to VS2013
+#define IMAGING_CONSTEXPR inline
+#define IMAGING_NOEXCEPT
+#else
+#define IMAGING_CONSTEXPR constexpr
+#define IMAGING_NOEXCEPT noexcept
+#endif
+
+#include "thread_pool.h"
+
 namespace Imaging
 {
 	////////////////////////////////////////////////////////////////////////////////////////
@@ -450,25 +481,210 @@ namespace Imaging
 	std::array<double, N> Normalize(const std::array<T, N> &src, double p = 2.0);
 
 
+	////////////////////////////////////////////////////////////////////////////////////////
+	// Aligned memory allocation
+
+	/** Default alignment of image data in bytes.
+
+	It is the size of a cache line, and it is also a multiple of the widest SIMD register,
+	so an aligned load can be used from the first element of the data. */
+	const ::size_t DEFAULT_ALIGNMENT = 64;
+
+	/** Allocates a memory block whose address is a multiple of given alignment.
+	
+	@param [in] nBytes
+	@param [in] alignment	alignment in bytes, which must be a power of two
+	@exception std::bad_alloc	if the memory cannot be allocated */
+	void *AlignedMalloc(::size_t nBytes, ::size_t alignment = DEFAULT_ALIGNMENT);
+
+	/** Releases a memory block allocated by AlignedMalloc(). */
+	void AlignedFree(void *p);
+
+	/** Rounds up a value to the nearest multiple of given step. */
+	template <typename T>
+	T RoundUp(T value, T step);
+
+	/** Reverses the byte order of a value, e.g., a big-endian value to little-endian. */
+	template <typename T>
+	T SwapBytes(T value);
+
+	/** Presents a source of aligned memory blocks for AlignedAllocator<T, N>, e.g., a pool
+	recycling image buffers.
+
+	The same size and alignment are given to Deallocate() as given to Allocate(). */
+	class MemoryResource
+	{
+	public:
+		virtual ~MemoryResource(void);
+
+		/** @exception std::bad_alloc	if the memory cannot be allocated */
+		virtual void *Allocate(::size_t nBytes, ::size_t alignment) = 0;
+		virtual void Deallocate(void *p, ::size_t nBytes, ::size_t alignment) = 0;
+	};
+
+	/** Allocates elements at an address aligned at N bytes.
+
+	This class satisfies the allocator requirements, so it can be used as the allocator of
+	an std::vector<T> object, e.g., std::vector<T, AlignedAllocator<T> >.
+	The memory is allocated by AlignedMalloc() unless a MemoryResource object is given.
+	Two allocators are identical if they share the same resource.
+	The allocator follows the memory when a container is moved or swapped, but not when it
+	is copied, i.e., a container keeps its resource for copied data.
+	construct() without a value default-initializes an element, so elements of arithmetic
+	types are left uninitialized by std::vector<T>::resize(). The owner of the container
+	zero-fills the elements if necessary, e.g., Image<T>::resize().
+
+	@NOTE The resource must outlive all containers using it. */
+	template <typename T, ::size_t N = DEFAULT_ALIGNMENT>
+	class AlignedAllocator
+	{
+	public:
+		//////////////////////////////////////////////////
+		// Types and constants.
+		typedef T value_type;
+		typedef T *pointer;
+		typedef const T *const_pointer;
+		typedef T &reference;
+		typedef const T &const_reference;
+		typedef ::size_t size_type;
+		typedef ::ptrdiff_t difference_type;
+		typedef std::false_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef AlignedAllocator<U, N> other;
+		};
+
+		//////////////////////////////////////////////////
+		// Default constructors.
+		AlignedAllocator(void);
+		AlignedAllocator(const AlignedAllocator<T, N> &src);
+		template <typename U>
+		AlignedAllocator(const AlignedAllocator<U, N> &src);
+
+		//////////////////////////////////////////////////
+		// Custom constructors.
+
+		/** @param [in] resource	nullptr for AlignedMalloc() */
+		explicit AlignedAllocator(MemoryResource *resource);
+
+		//////////////////////////////////////////////////
+		// Operators.
+		template <typename U>
+		bool operator==(const AlignedAllocator<U, N> &rhs) const;
+		template <typename U>
+		bool operator!=(const AlignedAllocator<U, N> &rhs) const;
+
+		//////////////////////////////////////////////////
+		// Methods.
+		T *allocate(size_type n, const void *hint = nullptr);
+		void deallocate(T *p, size_type n);
+		size_type max_size(void) const;
+		void construct(T *p);
+		void construct(T *p, const T &val);
+		void destroy(T *p);
+		MemoryResource *GetResource(void) const;
+
+	protected:
+		//////////////////////////////////////////////////
+		// Data.
+		MemoryResource *resource_;
+	};
+
 	////////////////////////////////////////////////////////////////////////////////////////
 	// Global functions and operators for std::vector<T>
 
-	/** Copies lines of data repeatedly from an std::vector<T> to another.
+	/** The number of bytes from which Copy() and CopyLines() divide the work over threads.
+	Smaller copies run on the calling thread because starting threads costs more. */
+	const ::size_t PARALLEL_COPY_THRESHOLD = 4 * 1024 * 1024;
+
+	/** The number of bytes from which CopyLines() writes by non-temporal stores, i.e., a
+	copy larger than the last level cache, which would evict the working set otherwise. */
+	const ::size_t NON_TEMPORAL_COPY_THRESHOLD = 32 * 1024 * 1024;
+
+	/** Copies bytes by non-temporal stores which bypass the cache, or by std::memcpy()
+	without SSE2. The source and the destination must not overlap. */
+	void CopyNonTemporal(const void *src, void *dst, ::size_t nBytes);
+
+	/** Copies lines of data repeatedly from a container to another.
 	
 	This function is usually used to copy an ROI of data where an image is stored in an
-	std::vector<T>. */
+	std::vector<T>. Both source and destination may be iterators of std::vector<T> objects
+	with any allocator or raw pointers.
+	
+	@param [in] it_src			the first element of the first line at the source
+	@param [in] nElemPerLineSrc	the number of elements from a line to the next one at the
+	source, including padding elements
+	@param [out] it_dst			the first element of the first line at the destination
+	@param [in] nElemPerLineDst	the number of elements from a line to the next one at the
+	destination, including padding elements
+	@param [in] nElemWidth		the number of elements to copy for each line
+	@param [in] nLines			the number of lines to copy
+	@NOTE The lines are copied in parallel if there are PARALLEL_COPY_THRESHOLD bytes or
+	more. */
+	template <typename InputIterator, typename OutputIterator>
+	void CopyLines(InputIterator it_src, ::size_t nElemPerLineSrc, OutputIterator it_dst,
+		::size_t nElemPerLineDst, ::size_t nElemWidth, ::size_t nLines);
+
+	/** Copies lines of data repeatedly from a raw pointer to another.
+
+	Trivially copyable elements are copied by std::memcpy(), where continuous lines at both
+	source and destination are copied as a single block, and a copy of
+	NON_TEMPORAL_COPY_THRESHOLD bytes or more is written by CopyNonTemporal(). */
 	template <typename T>
-	void CopyLines(typename std::vector<T>::const_iterator it_src,
-		typename std::vector<T>::size_type nElemPerLineSrc,
-		typename std::vector<T>::iterator it_dst,
-		typename std::vector<T>::size_type nElemPerLineDst,
-		typename std::vector<T>::size_type nElemWidth,
-		typename std::vector<T>::size_type nLines);
-
-	/** Copies lines of data repeatedly from an std::vector<T> to a raw pointer. */
+	void CopyLines(const T *src, ::size_t nElemPerLineSrc, T *dst, ::size_t nElemPerLineDst,
+		::size_t nElemWidth, ::size_t nLines);
+
+#if defined(_MSC_VER)
+	/** Copies lines of data repeatedly from a container to a raw pointer. */
+	template <typename InputIterator, typename T>
+	void CopyLines(InputIterator it_src, ::size_t nElemPerLineSrc, T *dst,
+		::size_t nElemPerLineDst, ::size_t nElemWidth, ::size_t nLines);
+#endif
+
+	/** Copies a 2-D array of nRows x nCols elements to another 2-D array with different
+	steps, e.g., transposes a matrix if the steps are exchanged.
+
+	The element (r, c) is placed at r * stepRow + c * stepCol from the first element.
+	The arrays are copied tile by tile, where a side of a tile is a cache line, so both
+	arrays are accessed by whole cache lines even if one of them is accessed across lines,
+	i.e., a tile of the source and the destination stays in the L1 cache. */
 	template <typename T>
-	void CopyLines(typename std::vector<T>::const_iterator it_src, ::size_t nElemPerLineSrc,
-		T *dst, ::size_t nElemPerLineDst, ::size_t nElemWidth, ::size_t nLines);
+	void CopyTiles(const T *src, ::size_t stepRowSrc, ::size_t stepColSrc, T *dst,
+		::size_t stepRowDst, ::size_t stepColDst, ::size_t nRows, ::size_t nCols);
+
+	/** Transposes a matrix of nRows x nCols blocks in place, where a block is nElemBlock
+	continuous elements, e.g., reorders rows of channels from BIL to BSQ.
+
+	Each block is moved once by following the cycles of the permutation, so the extra
+	memory is a buffer of a block and a bit array marking the moved blocks.
+	@return the number of bytes of the extra memory */
+	template <typename T>
+	::size_t TransposeInPlace(T *data, ::size_t nRows, ::size_t nCols, ::size_t nElemBlock);
+
+	/** Transposes a matrix in place as above with the bit array and the block buffer of the
+	caller, so nothing is allocated, e.g., when the caller allocates every buffer first.
+	isMoved has nRows * nCols bits or more, and buffer has nElemBlock elements or more. */
+	template <typename T>
+	void TransposeInPlace(T *data, ::size_t nRows, ::size_t nCols, ::size_t nElemBlock,
+		std::vector<bool> &isMoved, T *buffer);
+
+	/** Interleaves D planes into pixels of D channels, e.g., RGB planes into RGB pixels.
+
+	The c-th plane starts at src + c * stepChSrc, and the pixels are continuous at dst.
+	D is given at compile time, so the channels are unrolled, and the compiler may
+	vectorize the loop with shuffles. */
+	template < ::size_t D, typename T>
+	void Interleave(const T *src, ::size_t stepChSrc, T *dst, ::size_t width);
+
+	/** Deinterleaves pixels of D channels into D planes, e.g., RGB pixels into RGB planes.
+
+	The pixels are continuous at src, and the c-th plane starts at dst + c * stepChDst. */
+	template < ::size_t D, typename T>
+	void Deinterleave(const T *src, T *dst, ::size_t stepChDst, ::size_t width);
 }
 
 #include "utilities_inl.h"
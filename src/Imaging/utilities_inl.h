@@ -126,16 +126,157 @@ namespace Imaging
 	}
 
 	////////////////////////////////////////////////////////////////////////////////////////
-	// Global functions and operators for std::vector<T, N>
+	// Aligned memory allocation
+
+	inline void *AlignedMalloc(::size_t nBytes, ::size_t alignment)
+	{
+#if defined(_MSC_VER)
+		void *p = ::_aligned_malloc(nBytes, alignment);
+#else
+		void *p = nullptr;
+		if (::posix_memalign(&p, alignment, nBytes) != 0)
+			p = nullptr;
+#endif
+		if (p == nullptr && nBytes != 0)
+			throw std::bad_alloc();
+		return p;
+	}
+
+	inline void AlignedFree(void *p)
+	{
+#if defined(_MSC_VER)
+		::_aligned_free(p);
+#else
+		::free(p);
+#endif
+	}
+
+	template <typename T>
+	T RoundUp(T value, T step)
+	{
+		return (value + step - 1) / step * step;
+	}
+
+	/** The bytes are copied by std::memcpy(), so floating point values are swapped without
+	aliasing them by integers. */
 	template <typename T>
-	void CopyLines(typename std::vector<T>::const_iterator it_src,
-		typename std::vector<T>::size_type nElemPerLineSrc,
-		typename std::vector<T>::iterator it_dst,
-		typename std::vector<T>::size_type nElemPerLineDst,
-		typename std::vector<T>::size_type nElemWidth,
-		typename std::vector<T>::size_type nLines)
-	{
-		for (auto H = 0; H != nLines; ++H)
+	T SwapBytes(T value)
+	{
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		std::reverse(bytes, bytes + sizeof(T));
+		std::memcpy(&value, bytes, sizeof(T));
+		return value;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// MemoryResource class
+
+	inline MemoryResource::~MemoryResource(void) {}
+
+	//////////////////////////////////////////////////////////////////////////
+	// AlignedAllocator<T, N> class
+
+	template <typename T, ::size_t N>
+	AlignedAllocator<T, N>::AlignedAllocator(void) : resource_(nullptr) {}
+
+	template <typename T, ::size_t N>
+	AlignedAllocator<T, N>::AlignedAllocator(const AlignedAllocator<T, N> &src) :
+		resource_(src.resource_) {}
+
+	template <typename T, ::size_t N>
+	template <typename U>
+	AlignedAllocator<T, N>::AlignedAllocator(const AlignedAllocator<U, N> &src) :
+		resource_(src.GetResource()) {}
+
+	template <typename T, ::size_t N>
+	AlignedAllocator<T, N>::AlignedAllocator(MemoryResource *resource) :
+		resource_(resource) {}
+
+	template <typename T, ::size_t N>
+	template <typename U>
+	bool AlignedAllocator<T, N>::operator==(const AlignedAllocator<U, N> &rhs) const
+	{
+		return this->resource_ == rhs.GetResource();
+	}
+
+	template <typename T, ::size_t N>
+	template <typename U>
+	bool AlignedAllocator<T, N>::operator!=(const AlignedAllocator<U, N> &rhs) const
+	{
+		return !this->operator==(rhs);
+	}
+
+	template <typename T, ::size_t N>
+	T *AlignedAllocator<T, N>::allocate(size_type n, const void *)
+	{
+		if (n > this->max_size())
+			throw std::bad_alloc();
+		if (this->resource_ != nullptr)
+			return static_cast<T *>(this->resource_->Allocate(n * sizeof(T), N));
+		return static_cast<T *>(AlignedMalloc(n * sizeof(T), N));
+	}
+
+	template <typename T, ::size_t N>
+	void AlignedAllocator<T, N>::deallocate(T *p, size_type n)
+	{
+		if (this->resource_ != nullptr)
+			this->resource_->Deallocate(p, n * sizeof(T), N);
+		else
+			AlignedFree(p);
+	}
+
+	template <typename T, ::size_t N>
+	typename AlignedAllocator<T, N>::size_type AlignedAllocator<T, N>::max_size(void) const
+	{
+		return std::numeric_limits<size_type>::max() / sizeof(T);
+	}
+
+	// Default initialization without () does not write anything for arithmetic types.
+	template <typename T, ::size_t N>
+	void AlignedAllocator<T, N>::construct(T *p)
+	{
+		::new(static_cast<void *>(p)) T;
+	}
+
+	template <typename T, ::size_t N>
+	void AlignedAllocator<T, N>::construct(T *p, const T &val)
+	{
+		::new(static_cast<void *>(p)) T(val);
+	}
+
+	template <typename T, ::size_t N>
+	void AlignedAllocator<T, N>::destroy(T *p)
+	{
+		p->~T();
+	}
+
+	template <typename T, ::size_t N>
+	MemoryResource *AlignedAllocator<T, N>::GetResource(void) const
+	{
+		return this->resource_;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////
+	// Global functions and operators for std::vector<T, N>
+	/** Large copies are divided into continuous blocks of lines, one for each thread, so
+	every thread reads and writes its own part of the memory sequentially. */
+	template <typename InputIterator, typename OutputIterator>
+	void CopyLines(InputIterator it_src, ::size_t nElemPerLineSrc, OutputIterator it_dst,
+		::size_t nElemPerLineDst, ::size_t nElemWidth, ::size_t nLines)
+	{
+		typedef typename std::iterator_traits<InputIterator>::value_type T;
+		if (nLines > 1 && nElemWidth * nLines * sizeof(T) >= PARALLEL_COPY_THRESHOLD)
+		{
+			ParallelFor(0, nLines, [&](::size_t H)
+			{
+				const InputIterator it = it_src + H * nElemPerLineSrc;
+				std::copy(it, it + nElemWidth, it_dst + H * nElemPerLineDst);
+			});
+			return;
+		}
+
+		for (::size_t H = 0; H != nLines; ++H)
 		{
 			std::copy(it_src, it_src + nElemWidth, it_dst);
 			it_src += nElemPerLineSrc;
@@ -143,13 +284,115 @@ namespace Imaging
 		}
 	}
 
-	// Implemented stdext::checked_array_iterator<> class to bypass C4996 warning.
-#if defined(WIN32)
+	/** Non-temporal stores require the destination aligned to 16 bytes, so the bytes
+	before the first aligned address and after the last 64 byte block are copied by
+	std::memcpy(). The fence makes the stores visible to other threads before returning. */
+	inline void CopyNonTemporal(const void *src, void *dst, ::size_t nBytes)
+	{
+#if defined(IMAGING_SSE2)
+		const unsigned char *p = static_cast<const unsigned char *>(src);
+		unsigned char *q = static_cast<unsigned char *>(dst);
+		const ::size_t nBytesHead = std::min(nBytes,
+			(16 - reinterpret_cast< ::size_t>(q) % 16) % 16);
+		std::memcpy(q, p, nBytesHead);
+		p += nBytesHead;
+		q += nBytesHead;
+		nBytes -= nBytesHead;
+
+		const ::size_t nBytesBody = nBytes / 64 * 64;
+		for (::size_t I = 0; I != nBytesBody; I += 64)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + I));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + I + 16));
+			const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + I + 32));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + I + 48));
+			_mm_stream_si128(reinterpret_cast<__m128i *>(q + I), a);
+			_mm_stream_si128(reinterpret_cast<__m128i *>(q + I + 16), b);
+			_mm_stream_si128(reinterpret_cast<__m128i *>(q + I + 32), c);
+			_mm_stream_si128(reinterpret_cast<__m128i *>(q + I + 48), d);
+		}
+		_mm_sfence();
+		std::memcpy(q + nBytesBody, p + nBytesBody, nBytes - nBytesBody);
+#else
+		std::memcpy(dst, src, nBytes);
+#endif
+	}
+
+	/** Elements which are not trivially copyable are copied by the iterator version.
+	Otherwise, a single block of continuous lines is divided into chunks, one for each
+	thread, if it is large, just like separate lines. */
 	template <typename T>
-	void CopyLines(typename std::vector<T>::const_iterator it_src, ::size_t nElemPerLineSrc,
-		T *dst, ::size_t nElemPerLineDst, ::size_t nElemWidth, ::size_t nLines)
+	void CopyLines(const T *src, ::size_t nElemPerLineSrc, T *dst, ::size_t nElemPerLineDst,
+		::size_t nElemWidth, ::size_t nLines)
+	{
+		if (!std::is_trivially_copyable<T>::value)
+		{
+			CopyLines<const T *, T *>(src, nElemPerLineSrc, dst, nElemPerLineDst, nElemWidth,
+				nLines);
+			return;
+		}
+
+		if (nElemPerLineSrc == nElemWidth && nElemPerLineDst == nElemWidth)
+		{
+			nElemWidth *= nLines;
+			nElemPerLineSrc = nElemPerLineDst = nElemWidth;
+			nLines = 1;
+		}
+		const ::size_t nBytes = nElemWidth * nLines * sizeof(T);
+		if (nBytes == 0)
+			return;
+
+		const bool isNonTemporal = nBytes >= NON_TEMPORAL_COPY_THRESHOLD;
+		const auto copy = [&](const T *p, T *q, ::size_t nElem)
+		{
+			if (isNonTemporal)
+				CopyNonTemporal(p, q, nElem * sizeof(T));
+			else
+				std::memcpy(q, p, nElem * sizeof(T));
+		};
+
+		if (nBytes < PARALLEL_COPY_THRESHOLD)
+		{
+			for (::size_t H = 0; H != nLines; ++H)
+				copy(src + H * nElemPerLineSrc, dst + H * nElemPerLineDst, nElemWidth);
+		}
+		else if (nLines == 1)
+		{
+			const ::size_t nChunks = GetThreadCount();
+			ParallelFor(0, nChunks, [&](::size_t N)
+			{
+				const ::size_t I0 = nElemWidth * N / nChunks;
+				const ::size_t I1 = nElemWidth * (N + 1) / nChunks;
+				copy(src + I0, dst + I0, I1 - I0);
+			});
+		}
+		else
+		{
+			ParallelFor(0, nLines, [&](::size_t H)
+			{
+				copy(src + H * nElemPerLineSrc, dst + H * nElemPerLineDst, nElemWidth);
+			});
+		}
+	}
+
+	// Implemented stdext::checked_array_iterator<> class to bypass C4996 warning.
+#if defined(_MSC_VER)
+	template <typename InputIterator, typename T>
+	void CopyLines(InputIterator it_src, ::size_t nElemPerLineSrc, T *dst,
+		::size_t nElemPerLineDst, ::size_t nElemWidth, ::size_t nLines)
 	{
-		for (auto H = 0; H != nLines; ++H)
+		if (nLines > 1 && nElemWidth * nLines * sizeof(T) >= PARALLEL_COPY_THRESHOLD)
+		{
+			ParallelFor(0, nLines, [&](::size_t H)
+			{
+				const InputIterator it = it_src + H * nElemPerLineSrc;
+				std::copy(it, it + nElemWidth, stdext::checked_array_iterator<T *>(
+					dst + H * nElemPerLineDst, nElemPerLineDst));
+			});
+			return;
+		}
+
+		for (::size_t H = 0; H != nLines; ++H)
 		{
 			std::copy(it_src, it_src + nElemWidth,
 				stdext::checked_array_iterator<T *>(dst, nElemPerLineDst));
@@ -158,6 +401,100 @@ namespace Imaging
 		}
 	}
 #endif
+
+	/** The inner loop runs along the smaller step at the destination, so the writes are
+	sequential, while the reads are confined in a tile. */
+	template <typename T>
+	void CopyTiles(const T *src, ::size_t stepRowSrc, ::size_t stepColSrc, T *dst,
+		::size_t stepRowDst, ::size_t stepColDst, ::size_t nRows, ::size_t nCols)
+	{
+		const ::size_t nTile = std::max< ::size_t>(DEFAULT_ALIGNMENT / sizeof(T), 8);
+		const bool isRowInner = stepRowDst < stepColDst;
+		for (::size_t R0 = 0; R0 < nRows; R0 += nTile)
+		{
+			const ::size_t R1 = std::min(R0 + nTile, nRows);
+			for (::size_t C0 = 0; C0 < nCols; C0 += nTile)
+			{
+				const ::size_t C1 = std::min(C0 + nTile, nCols);
+				if (isRowInner)
+				{
+					for (::size_t C = C0; C != C1; ++C)
+						for (::size_t R = R0; R != R1; ++R)
+							dst[R * stepRowDst + C * stepColDst] =
+								src[R * stepRowSrc + C * stepColSrc];
+				}
+				else
+				{
+					for (::size_t R = R0; R != R1; ++R)
+						for (::size_t C = C0; C != C1; ++C)
+							dst[R * stepRowDst + C * stepColDst] =
+								src[R * stepRowSrc + C * stepColSrc];
+				}
+			}
+		}
+	}
+
+	template <typename T>
+	::size_t TransposeInPlace(T *data, ::size_t nRows, ::size_t nCols, ::size_t nElemBlock)
+	{
+		const ::size_t nBlocks = nRows * nCols;
+		if (nBlocks < 3 || nRows == 1 || nCols == 1 || nElemBlock == 0)
+			return 0;
+
+		std::vector<bool> isMoved(nBlocks);
+		std::vector<T> buffer(nElemBlock);
+		TransposeInPlace(data, nRows, nCols, nElemBlock, isMoved, buffer.data());
+		return nElemBlock * sizeof(T) + (nBlocks + 7) / 8;
+	}
+
+	/** The block at index i moves to (i % nCols) * nRows + i / nCols, so the block placed
+	at index j comes from (j % nRows) * nCols + j / nRows.
+	The first and the last blocks never move. */
+	template <typename T>
+	void TransposeInPlace(T *data, ::size_t nRows, ::size_t nCols, ::size_t nElemBlock,
+		std::vector<bool> &isMoved, T *buffer)
+	{
+		const ::size_t nBlocks = nRows * nCols;
+		if (nBlocks < 3 || nRows == 1 || nCols == 1 || nElemBlock == 0)
+			return;
+
+		std::fill(isMoved.begin(), isMoved.begin() + nBlocks, false);
+		for (::size_t start = 1; start + 1 < nBlocks; ++start)
+		{
+			if (isMoved[start])
+				continue;
+
+			std::copy(data + start * nElemBlock, data + (start + 1) * nElemBlock, buffer);
+			::size_t J = start;
+			for (;;)
+			{
+				const ::size_t I = (J % nRows) * nCols + J / nRows;
+				isMoved[J] = true;
+				if (I == start)
+					break;
+				std::copy(data + I * nElemBlock, data + (I + 1) * nElemBlock,
+					data + J * nElemBlock);
+				J = I;
+			}
+			std::copy(buffer, buffer + nElemBlock, data + J * nElemBlock);
+		}
+	}
+
+	template < ::size_t D, typename T>
+	void Interleave(const T *src, ::size_t stepChSrc, T *dst, ::size_t width)
+	{
+		for (::size_t W = 0; W != width; ++W)
+			for (::size_t C = 0; C != D; ++C)
+				dst[D * W + C] = src[C * stepChSrc + W];
+	}
+
+	template < ::size_t D, typename T>
+	void Deinterleave(const T *src, T *dst, ::size_t stepChDst, ::size_t width)
+	{
+		for (::size_t W = 0; W != width; ++W)
+			for (::size_t C = 0; C != D; ++C)
+				dst[C * stepChDst + W] = src[D * W + C];
+	}
 }
 
-#endif
+#endif
\ No newline at end of file
@@ -4,6 +4,7 @@ coordinates.h */
 
 #include <stdexcept>
 #include <iostream>
+#include <vector>
 
 void TestPoint2D(void)
 {
@@ -88,25 +89,104 @@ void TestRegion(T x, T y, U width, U height)
 		<< roi3.size.width << ", " << roi3.size.height << "]}" << std::endl;
 }
 
-void TestCoordinates(void)
+template <typename T, typename U>
+void TestRegionAlgebra(T x, T y)
 {
-	std::cout << std::endl << "Test for coordinates.h has started." << std::endl;
-	try
-	{
-		TestPoint2D();
-		TestPoint3D();
-		TestSize2D();
-		TestSize3D();
-		TestRegion<int, unsigned int>(0, 0, 4, 8);
-		TestRegion<int, int>(-1, -1, 4, 8);
-	}
-	catch (const std::logic_error &ex)
-	{
-		std::cout << ex.what() << std::endl;
-	}
-	catch (...)
+	using namespace Imaging;
+
+	// Intersection, bounding box and clipping.
+	const Region<T, U> roi1(x, y, 10, 6), roi2(x + 4, y + 2, 10, 10);
+	if ((roi1 & roi2) != Region<T, U>(x + 4, y + 2, 6, 4) ||
+		(roi1 | roi2) != Region<T, U>(x, y, 14, 12))
+		throw std::logic_error("Region<T, U>::operator&()");
+	const Region<T, U> roi3(x + 10, y, 3, 3);
+	if (roi1.Intersects(roi3) || !(roi1 & roi3).IsEmpty() || !roi1.Intersects(roi2) ||
+		(roi1 | Region<T, U>(x, y, 0, 3)) != roi1)
+		throw std::logic_error("Region<T, U>::Intersects()");
+	if (!roi1.Contains(Point2D<T>(x + 9, y + 5)) || roi1.Contains(Point2D<T>(x + 10, y)) ||
+		!(roi1 | roi2).Contains(roi2) || roi1.Contains(roi2))
+		throw std::logic_error("Region<T, U>::Contains()");
+
+	Region<T, U> roi4(x + 5, y + 5, 100, 100);
+	roi4.Clip(static_cast<U>(x + 20), static_cast<U>(y + 10));
+	if (roi4 != Region<T, U>(x + 5, y + 5, 15, 5))
+		throw std::logic_error("Region<T, U>::Clip()");
+
+	// Tiles cover the ROI once, and the inputs are clipped by the bounds.
+	const Region<T, U> bounds(x, y, 40, 30), roi(x + 1, y + 2, 37, 25);
+	const Size2D<U> tileSize(16, 8);
+	std::vector<RegionTile<T, U> > tiles = SplitIntoTiles(roi, tileSize, U(2), bounds);
+	if (tiles.size() != 3 * 4 || GetTileCount(roi, tileSize) != tiles.size() ||
+		SplitIntoTiles(roi, tileSize).size() != tiles.size())
+		throw std::logic_error("SplitIntoTiles()");
+	std::vector<int> counts(40 * 30, 0);
+	for (auto it = tiles.begin(); it != tiles.end(); ++it)
 	{
-		throw;
+		if (!it->input.Contains(it->region) || !bounds.Contains(it->input))
+			throw std::logic_error("SplitIntoTiles() halo");
+		for (U H = 0; H != it->region.size.height; ++H)
+			for (U W = 0; W != it->region.size.width; ++W)
+				++counts[static_cast< ::size_t>((it->region.origin.y - y + H) * 40 +
+					it->region.origin.x - x + W)];
 	}
+	for (::size_t H = 0; H != 30; ++H)
+		for (::size_t W = 0; W != 40; ++W)
+			if (counts[H * 40 + W] != (roi.Contains(Point2D<T>(x + W, y + H)) ? 1 : 0))
+				throw std::logic_error("SplitIntoTiles() coverage");
+	if (tiles[0].input != Region<T, U>(x, y, 19, 12) ||
+		tiles[5].input != Region<T, U>(x + 31, y + 8, 9, 12))
+		throw std::logic_error("SplitIntoTiles() halo");
+
+	// Merging close regions.
+	std::vector<Region<T, U> > rois;
+	rois.push_back(Region<T, U>(x + 20, y, 5, 5));
+	rois.push_back(Region<T, U>(x, y, 5, 5));
+	rois.push_back(Region<T, U>(x + 6, y + 1, 5, 5));
+	rois.push_back(Region<T, U>(x, y + 30, 2, 2));
+	rois.push_back(Region<T, U>(x + 1, y + 1, 2, 2));
+	rois.push_back(Region<T, U>(x + 50, y, 0, 0));
+	std::vector<Region<T, U> > merged = MergeRegions(rois);
+	if (merged.size() != 4 || merged[0] != Region<T, U>(x, y, 5, 5))
+		throw std::logic_error("MergeRegions()");
+	merged = MergeRegions(rois, U(1));
+	if (merged.size() != 3 || merged[0] != Region<T, U>(x, y, 11, 6) ||
+		merged[1] != Region<T, U>(x + 20, y, 5, 5) || merged[2] != Region<T, U>(x, y + 30, 2, 2))
+		throw std::logic_error("MergeRegions()");
+	merged = MergeRegions(rois, U(100));
+	if (merged.size() != 1 || merged[0] != Region<T, U>(x, y, 25, 32))
+		throw std::logic_error("MergeRegions()");
+}
+
+void TestCacheTileSize(void)
+{
+	using namespace Imaging;
+
+	// Entire lines fit in the cache, or a square tile with its halo does.
+	Size2D< ::size_t> sz = GetCacheTileSize(Size2D< ::size_t>(256, 1000), 4);
+	if (sz != Size2D< ::size_t>(256, 128))
+		throw std::logic_error("GetCacheTileSize()");
+	sz = GetCacheTileSize(Size2D< ::size_t>(100000, 1000), 4, ::size_t(3));
+	if (sz.width != sz.height || (sz.width + 6) * (sz.height + 6) * 4 > DEFAULT_TILE_BYTES)
+		throw std::logic_error("GetCacheTileSize()");
+	sz = GetCacheTileSize(Size2D< ::size_t>(10, 5), 4);
+	if (sz != Size2D< ::size_t>(10, 5))
+		throw std::logic_error("GetCacheTileSize()");
+}
+
+void TestCoordinates(void)
+{
+	std::cout << std::endl << "Test for coordinates.h has started." << std::endl;
+
+	TestPoint2D();
+	TestPoint3D();
+	TestSize2D();
+	TestSize3D();
+	TestRegion<int, unsigned int>(0, 0, 4, 8);
+	TestRegion<int, int>(-1, -1, 4, 8);
+	TestRegionAlgebra<int, unsigned int>(-3, 2);
+	TestRegionAlgebra< ::size_t, ::size_t>(0, 0);
+	TestRegionAlgebra<double, double>(1.5, 0.5);
+	TestCacheTileSize();
+
 	std::cout << "Test for coordinates.h has been completed." << std::endl;
 }
@@ -0,0 +1,160 @@
+/** This file contains the test functions to test classes and functions defined in
+frame_batch.h */
+
+#include "../Imaging/frame_batch.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+
+/** Fills frame n with values of n, so the frame of a result is known. */
+template <typename T>
+void FillFrame(Imaging::ImageFrame<T> &frame, ::size_t n)
+{
+	for (::size_t C = 0; C != frame.size.depth; ++C)
+		for (::size_t H = 0; H != frame.size.height; ++H)
+			for (::size_t W = 0; W != frame.size.width; ++W)
+				frame(W, H, C) = static_cast<T>(n * 10 + (W + H + C) % 7);
+}
+
+void TestTransformBlocks(void)
+{
+	using namespace Imaging;
+
+	const Size3D< ::size_t> sz(31, 17, 2);
+	ImageBlock<unsigned char> block;
+	block.Resize(sz, 9);
+	for (::size_t N = 0; N != 9; ++N)
+		FillFrame(block[N], N);
+
+	// Type conversion of every other frame into preallocated frames.
+	ImageBlock<float> converted;
+	const std::vector< ::size_t> frames = GetFrames(9, 1, 2);
+	TransformFrames(block, frames, converted, sz, [](
+		const ImageView<const unsigned char> &src, const ImageView<float> &dst)
+	{
+		for (::size_t C = 0; C != src.size.depth; ++C)
+			for (::size_t H = 0; H != src.size.height; ++H)
+				for (::size_t W = 0; W != src.size.width; ++W)
+					dst(W, H, C) = src(W, H, C) * 0.5f;
+	});
+	if (converted.GetFrameCount() != 4 || converted[3].size != sz)
+		throw std::logic_error("TransformFrames() frames");
+	for (::size_t N = 0; N != 4; ++N)
+		if (converted[N](5, 6, 1) != block[frames[N]](5, 6, 1) * 0.5f)
+			throw std::logic_error("TransformFrames() values");
+
+	// An operation sizing its destination frames by itself.
+	ImageBlock<unsigned char> copied;
+	TransformFrames(block, copied, [](const ImageFrame<unsigned char> &src,
+		ImageFrame<unsigned char> &dst)
+	{
+		dst = src;
+	});
+	for (::size_t N = 0; N != 9; ++N)
+		if (copied[N].data != block[N].data)
+			throw std::logic_error("TransformFrames() into frames of their own sizes");
+
+	// Resizing by a plan shared by all frames.
+	ImageBlock<unsigned char> resized;
+	ResizeFrames(block, Point2D<double>(0.5, 1.5), resized, Interpolation::CUBIC);
+	for (::size_t N = 0; N != 9; ++N)
+	{
+		Image<unsigned char> img;
+		Resize(block[N].GetView(), Point2D<double>(0.5, 1.5), img, Interpolation::CUBIC);
+		const ImageView<const unsigned char> view = resized[N].GetView();
+		if (view.size != img.size)
+			throw std::logic_error("ResizeFrames() size");
+		for (::size_t C = 0; C != 2; ++C)
+			for (::size_t H = 0; H != img.size.height; ++H)
+				for (::size_t W = 0; W != img.size.width; ++W)
+					if (view(W, H, C) != img(W, H, C))
+						throw std::logic_error("ResizeFrames() values");
+	}
+
+	try
+	{
+		std::vector< ::size_t> outOfRange(1, 9);
+		TransformFrames(block, outOfRange, copied, [](const ImageFrame<unsigned char> &,
+			ImageFrame<unsigned char> &) {});
+		throw std::logic_error("TransformFrames() should check the frames.");
+	}
+	catch (std::out_of_range &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+void TestTransformOutOfCore(void)
+{
+	using namespace Imaging;
+
+	const char *pathSrc = "test_frame_batch_src.bin";
+	const char *pathDst = "test_frame_batch_dst.bin";
+	const Size3D< ::size_t> sz(40, 30, 3);
+	const ::size_t nFrames = 25, nBytesFrame = 40 * 30 * 3 * sizeof(unsigned short);
+	{
+		// The budget holds less than a half of the frames.
+		OutOfCoreBlock<unsigned short> src(pathSrc, sz, nFrames, 10 * nBytesFrame);
+		for (::size_t N = 0; N != nFrames; ++N)
+			FillFrame(*src.Write(N), N);
+		src.SetPrefetchDepth(0);
+
+		ImageBlock<unsigned short> dst;
+		const std::vector< ::size_t> frames = GetFrames(nFrames, 0, 3);
+		TransformFrames(src, frames, dst, sz, [](
+			const ImageView<const unsigned short> &viewSrc,
+			const ImageView<unsigned short> &viewDst)
+		{
+			Copy(viewSrc, viewDst);
+		});
+		if (dst.GetFrameCount() != frames.size() || src.GetPrefetchDepth() != 0)
+			throw std::logic_error("TransformFrames(OutOfCoreBlock<T>, ...)");
+		for (::size_t N = 0; N != frames.size(); ++N)
+			if (dst[N](7, 8, 2) != static_cast<unsigned short>(frames[N] * 10 + 17 % 7))
+				throw std::logic_error("TransformFrames(OutOfCoreBlock<T>, ...) values");
+
+		// The destination frames are overwritten without being read.
+		OutOfCoreBlock<unsigned short> dstFile(pathDst, sz, nFrames, 10 * nBytesFrame);
+		const ::size_t nPrefetch = dstFile.GetPrefetchDepth();
+		TransformFrames(src, GetFrames(nFrames), dstFile, [](
+			const ImageView<const unsigned short> &viewSrc,
+			const ImageView<unsigned short> &viewDst)
+		{
+			for (::size_t C = 0; C != viewSrc.size.depth; ++C)
+				for (::size_t H = 0; H != viewSrc.size.height; ++H)
+					for (::size_t W = 0; W != viewSrc.size.width; ++W)
+						viewDst(W, H, C) = static_cast<unsigned short>(viewSrc(W, H, C) + 1);
+		});
+		if (dstFile.GetStatistics().nBytesRead != 0 ||
+			dstFile.GetPrefetchDepth() != nPrefetch)
+			throw std::logic_error(
+				"TransformFrames(OutOfCoreBlock<T>, OutOfCoreBlock<U>) read the destination");
+		dstFile.Flush();
+		for (::size_t N = 0; N != nFrames; ++N)
+			if ((*dstFile.Read(N))(39, 29, 0) != (*src.Read(N))(39, 29, 0) + 1)
+				throw std::logic_error(
+					"TransformFrames(OutOfCoreBlock<T>, OutOfCoreBlock<U>)");
+	}
+	std::remove(pathSrc);
+	std::remove(pathDst);
+}
+
+void TestFrameBatch(void)
+{
+	using namespace Imaging;
+
+	std::cout << std::endl << "Test for frame_batch.h has started." << std::endl;
+
+	const ::size_t nThreads = GetThreadCount();
+	const ::size_t nThreadsTested[] = {1, 4};
+	for (auto n : nThreadsTested)
+	{
+		SetThreadCount(n);
+		TestTransformBlocks();
+		TestTransformOutOfCore();
+	}
+	SetThreadCount(nThreads);
+
+	std::cout << std::endl << "Test for frame_batch.h has been completed." << std::endl;
+}
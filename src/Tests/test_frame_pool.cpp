@@ -0,0 +1,120 @@
+/** This file contains the test functions to test classes and functions defined in
+frame_pool.h */
+
+#include "../Imaging/frame_pool.h"
+#include "../Imaging/image2.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+
+template <typename T>
+void TestFramePool(::size_t alignment)
+{
+	using namespace Imaging;
+
+	FramePool pool;
+	AlignedAllocator<T> alloc(&pool);
+	const Size3D<::size_t> sz(640, 480, 3);
+
+	// Warm up with two frames in flight.
+	{
+		ImageFrame<T> img1(sz, alignment, alloc), img2(sz, alignment, alloc);
+		if (img1.GetAllocator() != alloc || pool.GetStatistics().nBlocksInUse != 2)
+			throw std::logic_error("FramePool::Allocate()");
+	}
+	FramePool::Statistics stats = pool.GetStatistics();
+	if (stats.nMisses != 2 || stats.nBlocksInUse != 0 || stats.nBlocksCached != 2)
+		throw std::logic_error("FramePool::Deallocate()");
+
+	// Steady state: every frame reuses a cached block.
+	pool.ResetStatistics();
+	std::vector<const T *> buffers;
+	for (auto n = 0; n != 100; ++n)
+	{
+		ImageFrame<T> img3(sz, alignment, alloc);
+		img3(639, 479, 2) = static_cast<T>(n);
+		ImageFrame<T> img4 = std::move(img3);
+		buffers.push_back(img4.data.data());
+	}
+	stats = pool.GetStatistics();
+	if (stats.nMisses != 0 || stats.nHits != 100 || stats.GetHitRate() != 1.0 ||
+		stats.nBlocksCached != 2)
+		throw std::logic_error("FramePool::Allocate()");
+	if (buffers.front() != buffers.back())
+		throw std::logic_error("FramePool::Allocate()");
+
+	// Images use the pool as well.
+	Image<T> img5(sz, ImageFormat::BSQ, alignment, alloc);
+	if (img5.GetAllocator().GetResource() != &pool)
+		throw std::logic_error("Image<T>::GetAllocator()");
+
+	// Another size class misses.
+	ImageFrame<T> img6(320, 240, 3, alignment, alloc);
+	stats = pool.GetStatistics();
+	if (stats.nMisses != 1 || stats.nBlocksInUse != 2)
+		throw std::logic_error("FramePool::Allocate()");
+
+	std::cout << "hit rate = " << stats.GetHitRate() << ", in use = " <<
+		stats.nBytesInUse << " bytes, cached = " << stats.nBytesCached << " bytes" <<
+		std::endl;
+}
+
+void TestFramePoolReserve(void)
+{
+	using namespace Imaging;
+
+	FramePool pool;
+	pool.Reserve(1024 * 1024, 4);
+	FramePool::Statistics stats = pool.GetStatistics();
+	if (stats.nBlocksCached != 4 || stats.nBytesCached != 4 * 1024 * 1024)
+		throw std::logic_error("FramePool::Reserve()");
+
+	{
+		ImageFrame<unsigned char> img1(1024, 1024, 1, 0,
+			AlignedAllocator<unsigned char>(&pool));
+		if (pool.GetStatistics().nHits != 1 || pool.GetStatistics().nMisses != 0)
+			throw std::logic_error("FramePool::Reserve()");
+	}
+
+	pool.Release();
+	stats = pool.GetStatistics();
+	if (stats.nBlocksCached != 0 || stats.nBytesCached != 0)
+		throw std::logic_error("FramePool::Release()");
+}
+
+void TestFramePoolLimit(void)
+{
+	using namespace Imaging;
+
+	// A burst of frames caches up to the limit, and frees the other blocks.
+	FramePool pool(2);
+	AlignedAllocator<float> alloc(&pool);
+	{
+		std::vector<ImageFrame<float> > frames;
+		for (auto n = 0; n != 5; ++n)
+			frames.push_back(ImageFrame<float>(100, 50, 2, 0, alloc));
+	}
+	FramePool::Statistics stats = pool.GetStatistics();
+	if (pool.GetCacheLimit() != 2 || stats.nBlocksInUse != 0 || stats.nBlocksCached != 2)
+		throw std::logic_error("FramePool::Deallocate() with the limit");
+
+	pool.SetCacheLimit(1);
+	stats = pool.GetStatistics();
+	if (stats.nBlocksCached != 1 || stats.nBytesCached != 100 * 50 * 2 * sizeof(float))
+		throw std::logic_error("FramePool::SetCacheLimit()");
+	if (FramePool().GetCacheLimit() != FRAME_POOL_CACHE_LIMIT)
+		throw std::logic_error("FramePool::GetCacheLimit()");
+}
+
+void TestFramePool(void)
+{
+	std::cout << std::endl << "Test for frame_pool.h has started." << std::endl;
+
+	TestFramePool<unsigned char>(0);
+	TestFramePool<float>(64);
+	TestFramePoolReserve();
+	TestFramePoolLimit();
+
+	std::cout << std::endl << "Test for frame_pool.h has been completed." << std::endl;
+}
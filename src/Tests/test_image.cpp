@@ -1,7 +1,9 @@
 /** This file contains the test functions to test classes and functions defined in
 image.h */
+#include "../Imaging/frame_pool.h"
 #include "../Imaging/image_processing.h"
 
+#include <chrono>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
@@ -69,6 +71,477 @@ void TestCopy(void)
 	Region<Image<T>::SizeType, Image<T>::SizeType> roiSrc(10, 10, 40, 20);
 	Copy(img1, roiSrc, img2, Point2D<Image<T>::SizeType>(10, 10));
 	Copy(img1, roiSrc, img3, Point2D<Image<T>::SizeType>(0, 0));	
+
+	// An ROI to a raw data block without padding.
+	img1(10, 29, 2) = static_cast<T>(7);
+	std::vector<T> data(40 * 20 * 3);
+	Copy(img1, roiSrc, data.data());
+	if (data[(19 * 40 + 0) * 3 + 2] != static_cast<T>(7))
+		throw std::logic_error("Copy(Image<T>, Region<T>, T *)");
+}
+
+template <typename T>
+void TestAlignment(Imaging::ImageFormat fmt, ::size_t alignment)
+{
+	using namespace Imaging;
+
+	Image<T> img1(61, 40, 3, fmt, alignment), img2(61, 40, 3, fmt), img3;
+	img3.SetAlignment(alignment);
+
+	// Every line should start at an aligned address.
+	for (::size_t H = 0; H != img1.size.height; ++H)
+		if (reinterpret_cast<::size_t>(img1.GetPointer(0, H)) % alignment != 0)
+			throw std::logic_error("Image<T>::GetElemPerLine()");
+	if (img1.GetBytesPerLine() % alignment != 0 || img1.IsContinuous())
+		throw std::logic_error("Image<T>::GetBytesPerLine()");
+
+	for (::size_t C = 0; C != img1.size.depth; ++C)
+		for (::size_t H = 0; H != img1.size.height; ++H)
+			for (::size_t W = 0; W != img1.size.width; ++W)
+				img1(W, H, C) = static_cast<T>(W + H + C);
+
+	// padded -> packed -> padded
+	Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roiSrc(10, 10, 40, 20);
+	Copy(img1, roiSrc, img2, Point2D<typename Image<T>::SizeType>(10, 10));
+	Copy(img2, roiSrc, img3);
+	for (::size_t C = 0; C != img3.size.depth; ++C)
+		for (::size_t H = 0; H != img3.size.height; ++H)
+			for (::size_t W = 0; W != img3.size.width; ++W)
+				if (img3(W, H, C) != img1(W + 10, H + 10, C))
+					throw std::logic_error("Copy(Image<T>, ROI, Image<T>)");
+
+	// padded -> raw data block -> padded
+	std::vector<T> raw(img3.size.width * img3.size.height * img3.size.depth);
+	Copy(img3, raw.data());
+	Image<T> img4(1, 1, 1, fmt, alignment);
+	Copy(raw.data(), img3.size, img4, fmt);
+	for (::size_t C = 0; C != img4.size.depth; ++C)
+		for (::size_t H = 0; H != img4.size.height; ++H)
+			for (::size_t W = 0; W != img4.size.width; ++W)
+				if (img4(W, H, C) != img3(W, H, C))
+					throw std::logic_error("Copy(T *, Size3D, Image<T>)");
+}
+
+template <typename T>
+void TestView(Imaging::ImageFormat fmt)
+{
+	using namespace Imaging;
+
+	Image<T> img1(60, 40, 3, fmt, 64);
+	for (::size_t C = 0; C != img1.size.depth; ++C)
+		for (::size_t H = 0; H != img1.size.height; ++H)
+			for (::size_t W = 0; W != img1.size.width; ++W)
+				img1(W, H, C) = static_cast<T>(W + H + C);
+
+	// A view of an ROI refers to the same data without copying.
+	Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roi(10, 10, 40, 20);
+	ImageView<T> view1 = img1.GetView(roi);
+	if (&view1(0, 0, 1) != &img1(10, 10, 1) || &view1(39, 19, 2) != &img1(49, 29, 2))
+		throw std::logic_error("Image<T>::GetView()");
+
+	// A view of a view.
+	Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roi2(5, 5, 10, 10);
+	ImageView<const T> view2 = view1.GetView(roi2);
+	if (&view2(0, 0, 0) != &img1(15, 15, 0))
+		throw std::logic_error("ImageView<T>::GetView()");
+
+	// view -> image -> view
+	Image<T> img2, img3(40, 20, 3, fmt);
+	Copy(view1, img2);
+	Copy(img2.GetView(), img3.GetView());
+	for (::size_t C = 0; C != img3.size.depth; ++C)
+		for (::size_t H = 0; H != img3.size.height; ++H)
+			for (::size_t W = 0; W != img3.size.width; ++W)
+				if (img3(W, H, C) != img1(W + 10, H + 10, C))
+					throw std::logic_error("Copy(ImageView<T>, ImageView<T>)");
+
+	// An image constructed by default has an empty view.
+	const Image<T> imgEmpty;
+	if (imgEmpty.GetView().size != Size3D< ::size_t>(0, 0, 0) ||
+		Image<T>().GetView().size != Size3D< ::size_t>(0, 0, 0))
+		throw std::logic_error("Image<T>::GetView() of an empty image");
+
+	try
+	{
+		img1.GetView(Region<typename Image<T>::SizeType, typename Image<T>::SizeType>(
+			50, 0, 20, 10));
+		throw std::logic_error("Image<T>::GetView()");
+	}
+	catch (const std::out_of_range &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+template <typename T>
+void TestRangeCheck(Imaging::ImageFormat fmt)
+{
+	using namespace Imaging;
+
+	Image<T> img1(50, 30, 2, fmt, 32);
+	for (::size_t C = 0; C != img1.size.depth; ++C)
+		for (::size_t H = 0; H != img1.size.height; ++H)
+			for (::size_t W = 0; W != img1.size.width; ++W)
+				img1.template At<RangeCheck::UNCHECKED>(W, H, C) = static_cast<T>(W + H + C);
+	if (img1(49, 29, 1) != static_cast<T>(49 + 29 + 1) ||
+		img1.template GetPointer<RangeCheck::DEBUG_CHECKED>(3, 2, 1) != &img1(3, 2, 1))
+		throw std::logic_error("Image<T>::At<R>()");
+
+	// A validated ROI is accessed without any range check.
+	Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roi(10, 5, 30, 20);
+	ImageView<T, RangeCheck::UNCHECKED> view1 = img1.CheckRange(roi);
+	for (::size_t C = 0; C != view1.size.depth; ++C)
+		for (::size_t H = 0; H != view1.size.height; ++H)
+			for (::size_t W = 0; W != view1.size.width; ++W)
+				if (&view1(W, H, C) != &img1(W + 10, H + 5, C))
+					throw std::logic_error("Image<T>::CheckRange(Region)");
+
+	try
+	{
+		img1.template At<RangeCheck::CHECKED>(50, 0);
+		throw std::logic_error("Image<T>::At<RangeCheck::CHECKED>()");
+	}
+	catch (const std::out_of_range &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+
+	try
+	{
+		roi.size.width = 41;
+		img1.CheckRange(roi);
+		throw std::logic_error("Image<T>::CheckRange(Region)");
+	}
+	catch (const std::out_of_range &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+template <typename T>
+void TestMove(void)
+{
+	using namespace Imaging;
+
+	Image<T> img1(64, 48, 3, ImageFormat::BSQ, 32);
+	img1(63, 47, 2) = static_cast<T>(1);
+	const T *p = img1.data.data();
+
+	Image<T> img2 = std::move(img1), img3;
+	img3 = std::move(img2);
+	if (img3.data.data() != p || img3.format != ImageFormat::BSQ ||
+		img3.GetAlignment() != 32 || img3(63, 47, 2) != static_cast<T>(1) ||
+		!img1.data.empty() || img2.size.width != 0)
+		throw std::logic_error("Image<T>::Image(Image<T> &&)");
+
+	// runtime format -> fixed format without copying
+	Image<T, ImageFormat::BSQ> img4 = std::move(img3);
+	if (img4.data.data() != p)
+		throw std::logic_error("Image<T, F>::Image(Image<T> &&)");
+
+	Image<T, ImageFormat::BSQ> img5(2, 2, 1);
+	swap(img4, img5);
+	if (img5.data.data() != p || img4.size.width != 2)
+		throw std::logic_error("swap(Image<T, F>, Image<T, F>)");
+
+	Image<T> img6(2, 2, 1, ImageFormat::BIL);
+	img3 = std::move(img5);
+	swap(img3, img6);
+	if (img6.data.data() != p || img6.format != ImageFormat::BSQ ||
+		img3.format != ImageFormat::BIL)
+		throw std::logic_error("swap(Image<T>, Image<T>)");
+}
+
+template <typename T>
+void TestResizeMode(void)
+{
+	using namespace Imaging;
+
+	// A pool hands out the same block again, so the previous values are visible if the
+	// block is not zero-filled.
+	FramePool pool;
+	AlignedAllocator<T> alloc(&pool);
+	{
+		Image<T> img1(32, 24, 3, ImageFormat::BIP, 0, alloc);
+		std::fill(img1.GetPointer(0, 0), img1.GetPointer(0, 0) + img1.data.size(),
+			static_cast<T>(7));
+	}
+	{
+		Image<T, ImageFormat::BIP> img2(alloc);
+		img2.resize(32, 24, 3, ResizeMode::UNINITIALIZED);
+		if (img2(31, 23, 2) != static_cast<T>(7))
+			throw std::logic_error("Image<T>::resize(ResizeMode::UNINITIALIZED)");
+	}
+
+	// Zero-filled by default.
+	{
+		Image<T, ImageFormat::BIP> img3(alloc);
+		img3.resize(32, 24, 3);
+		for (auto it = img3.data.cbegin(); it != img3.data.cend(); ++it)
+			if (*it != 0)
+				throw std::logic_error("Image<T>::resize()");
+		std::fill(img3.GetPointer(0, 0), img3.GetPointer(0, 0) + img3.data.size(),
+			static_cast<T>(7));
+	}
+
+	// Copy() does not zero-fill the destination because it overwrites all elements.
+	Image<T> img4(32, 24, 3, ImageFormat::BSQ), img5(alloc);
+	Copy(img4, img4.GetRoi(), img5);
+	if (img5.size != img4.size || img5(0, 0, 0) != 0 || img5(31, 23, 2) != 0 ||
+		pool.GetStatistics().nHits != 3)
+		throw std::logic_error("Copy(Image<T>, Region, Image<T>)");
+}
+
+template <typename T>
+void TestConvertFormat(::size_t depth, ::size_t alignment)
+{
+	using namespace Imaging;
+
+	const ImageFormat fmts[] = {ImageFormat::BIP, ImageFormat::BSQ, ImageFormat::BIL};
+	for (auto fmtSrc : fmts)
+	{
+		for (auto fmtDst : fmts)
+		{
+			Image<T> img(37, 21, depth, fmtSrc, alignment);
+			for (::size_t C = 0; C != img.size.depth; ++C)
+				for (::size_t H = 0; H != img.size.height; ++H)
+					for (::size_t W = 0; W != img.size.width; ++W)
+						img(W, H, C) = static_cast<T>(W + 3 * H + 7 * C);
+			const ::size_t nElem = img.data.size();
+
+			const ::size_t nBytesExtra = img.ConvertFormat(fmtDst);
+			if (img.format != fmtDst || img.data.size() != nElem)
+				throw std::logic_error("Image<T>::ConvertFormat(ImageFormat)");
+			if (nBytesExtra * 4 > nElem * sizeof(T))
+			{
+				std::ostringstream errMsg;
+				errMsg << "Image<T>::ConvertFormat(ImageFormat) used " << nBytesExtra <<
+					" bytes for an image of " << nElem * sizeof(T) << " bytes";
+				throw std::logic_error(errMsg.str());
+			}
+			for (::size_t C = 0; C != img.size.depth; ++C)
+				for (::size_t H = 0; H != img.size.height; ++H)
+					for (::size_t W = 0; W != img.size.width; ++W)
+						if (img(W, H, C) != static_cast<T>(W + 3 * H + 7 * C))
+						{
+							std::ostringstream errMsg;
+							errMsg << "Image<T>::ConvertFormat(ImageFormat) from " <<
+								static_cast<int>(fmtSrc) << " to " <<
+								static_cast<int>(fmtDst) << " at (" << W << ", " << H <<
+								", " << C << ")";
+							throw std::logic_error(errMsg.str());
+						}
+		}
+	}
+
+	Image<T, ImageFormat::BIP> imgBip(4, 4, depth);
+	for (::size_t C = 0; C != depth; ++C)
+		for (::size_t H = 0; H != 4; ++H)
+			for (::size_t W = 0; W != 4; ++W)
+				imgBip(W, H, C) = static_cast<T>(W + 3 * H + 7 * C);
+	try
+	{
+		imgBip.ConvertFormat(ImageFormat::BSQ);
+		throw std::logic_error("Image<T, BIP>::ConvertFormat(BSQ) should fail.");
+	}
+	catch (std::invalid_argument &) {}
+	for (::size_t C = 0; C != depth; ++C)
+		for (::size_t H = 0; H != 4; ++H)
+			for (::size_t W = 0; W != 4; ++W)
+				if (imgBip(W, H, C) != static_cast<T>(W + 3 * H + 7 * C))
+					throw std::logic_error("Image<T, BIP>::ConvertFormat(BSQ) values");
+}
+
+template <typename T>
+void TestCopyAcrossFormats(::size_t depth, ::size_t alignment)
+{
+	using namespace Imaging;
+
+	const ImageFormat fmts[] = {ImageFormat::BIP, ImageFormat::BSQ, ImageFormat::BIL};
+	Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roi(3, 2, 37, 21);
+	for (auto fmtSrc : fmts)
+	{
+		Image<T> img1(45, 30, depth, fmtSrc, alignment);
+		for (::size_t C = 0; C != img1.size.depth; ++C)
+			for (::size_t H = 0; H != img1.size.height; ++H)
+				for (::size_t W = 0; W != img1.size.width; ++W)
+					img1(W, H, C) = static_cast<T>(W + 3 * H + 7 * C);
+
+		for (auto fmtDst : fmts)
+		{
+			Image<T> img2(0, 0, 1, fmtDst, alignment);
+			Copy(img1, roi, img2, fmtDst);
+			if (img2.format != fmtDst || img2.size.width != roi.size.width ||
+				img2.size.height != roi.size.height || img2.size.depth != depth)
+				throw std::logic_error("Copy(Image<T>, Region, Image<T>, ImageFormat)");
+			for (::size_t C = 0; C != img2.size.depth; ++C)
+				for (::size_t H = 0; H != img2.size.height; ++H)
+					for (::size_t W = 0; W != img2.size.width; ++W)
+						if (img2(W, H, C) != img1(W + 3, H + 2, C))
+						{
+							std::ostringstream errMsg;
+							errMsg << "Copy(Image<T>, Region, Image<T>, ImageFormat) from " <<
+								static_cast<int>(fmtSrc) << " to " <<
+								static_cast<int>(fmtDst) << " at (" << W << ", " << H <<
+								", " << C << ")";
+							throw std::logic_error(errMsg.str());
+						}
+		}
+	}
+}
+
+template <typename T>
+void TestFormattedImage(void)
+{
+	using namespace Imaging;
+
+	Image<T, ImageFormat::BSQ> img1(30, 20, 3);
+	if (img1.format != ImageFormat::BSQ)
+		throw std::logic_error("Image<T, F>::format");
+	for (::size_t C = 0; C != img1.size.depth; ++C)
+		for (::size_t H = 0; H != img1.size.height; ++H)
+			for (::size_t W = 0; W != img1.size.width; ++W)
+				img1(W, H, C) = static_cast<T>(W + H + C);
+	if (&img1(1, 0, 0) != &img1(0, 0, 0) + 1 ||
+		&img1(0, 0, 1) != &img1(0, 0, 0) + img1.size.width * img1.size.height)
+		throw std::logic_error("Image<T, F>::operator()");
+
+	// fixed format -> runtime format -> fixed format
+	Image<T> img2 = img1;
+	if (img2.format != ImageFormat::BSQ || img2(29, 19, 2) != img1(29, 19, 2))
+		throw std::logic_error("Image<T>::Image(const Image<T, F> &)");
+	Image<T, ImageFormat::BSQ> img3;
+	img3 = img2;
+	Copy(img1, img1.GetRoi(), img3);
+	if (img3(15, 10, 1) != img1(15, 10, 1))
+		throw std::logic_error("Copy(Image<T, F>, Region, Image<T, F>)");
+
+	// The format of a fixed format image cannot be changed.
+	try
+	{
+		Image<T, ImageFormat::BIP> img4 = img2;
+		throw std::logic_error("Image<T, F>::Image(const Image<T> &)");
+	}
+	catch (const std::invalid_argument &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+/** Copies an ROI of a large image with 1 to N threads, and prints the throughput. */
+template <typename T>
+void TestParallelCopy(Imaging::ImageFormat fmt, ::size_t depth)
+{
+	using namespace Imaging;
+
+	Image<T> imgSrc(4096, 2048, depth, fmt, 64);
+	for (::size_t C = 0; C != depth; ++C)
+		for (::size_t H = 0; H < imgSrc.size.height; H += 7)
+			imgSrc(H % imgSrc.size.width, H, C) = static_cast<T>(H + C);
+	const Region< ::size_t, ::size_t> roi(16, 8, 4000, 2000);
+	const double nBytes = 4000.0 * 2000.0 * depth * sizeof(T);
+
+	const ::size_t nThreadsMax = GetThreadCount();
+	for (::size_t nThreads = 1; ; nThreads = std::min(2 * nThreads, nThreadsMax))
+	{
+		SetThreadCount(nThreads);
+		Image<T> imgDst;
+		Copy(imgSrc.GetView(roi), imgDst);	// allocates the destination.
+		const auto start = std::chrono::steady_clock::now();
+		Copy(imgSrc.GetView(roi), imgDst.GetView());
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << "format " << static_cast<int>(fmt) << ", " << depth << " channels, " <<
+			nThreads << " threads: " << nBytes / elapsed.count() / (1 << 30) << " GiB/s" <<
+			std::endl;
+
+		for (::size_t C = 0; C != depth; ++C)
+			for (::size_t H = 0; H < roi.size.height; H += 7)
+				for (::size_t W = 0; W < roi.size.width; W += 5)
+					if (imgDst(W, H, C) != imgSrc(W + 16, H + 8, C))
+						throw std::logic_error("Copy() in parallel");
+		if (nThreads == nThreadsMax)
+			break;
+	}
+	SetThreadCount(nThreadsMax);
+}
+
+/** A kernel instantiated for each data type, which sums all elements of a view. */
+struct SumElements
+{
+	template <typename T>
+	double operator()(const Imaging::ImageView<const T> &view) const
+	{
+		double sum = 0.0;
+		for (::size_t C = 0; C != view.size.depth; ++C)
+			for (::size_t H = 0; H != view.size.height; ++H)
+				for (::size_t W = 0; W != view.size.width; ++W)
+					sum += view(W, H, C);
+		return sum;
+	}
+};
+
+/** A kernel which doubles all elements of a view in place. */
+struct DoubleElements
+{
+	template <typename T>
+	void operator()(const Imaging::ImageView<T> &view) const
+	{
+		for (::size_t C = 0; C != view.size.depth; ++C)
+			for (::size_t H = 0; H != view.size.height; ++H)
+				for (::size_t W = 0; W != view.size.width; ++W)
+					view(W, H, C) *= 2;
+	}
+};
+
+void TestImageRaw(void)
+{
+	using namespace Imaging;
+
+	// The data type is given at run time.
+	ImageRaw raw(ImageDataType::UINT16, Size3D< ::size_t>(5, 4, 3), ImageFormat::BSQ);
+	if (raw.size != Size3D< ::size_t>(5, 4, 3) || raw.format != ImageFormat::BSQ ||
+		!raw.IsDataType<unsigned short>() || raw.GetBytesPerCh() != 2 ||
+		static_cast<const ImageRaw &>(raw).Visit(SumElements()) != 0.0)
+		throw std::logic_error("ImageRaw(ImageDataType, Size3D<T>, ImageFormat)");
+	raw.operator()<unsigned short>(4, 3, 2) = 10;
+	raw.Visit(DoubleElements());
+	if (static_cast<const ImageRaw &>(raw).Visit(SumElements()) != 20.0)
+		throw std::logic_error("ImageRaw::Visit()");
+
+	bool isRejected = false;
+	try
+	{
+		raw.GetView<float>();
+	}
+	catch (std::logic_error &ex)
+	{
+		std::cout << ex.what() << std::endl;
+		isRejected = true;
+	}
+	if (!isRejected)
+		throw std::logic_error("ImageRaw::GetView<T>() should check the data type.");
+
+	// An image is moved in and out without copying data.
+	Image<float> img(7, 6, 2, ImageFormat::BIL, 64);
+	img(6, 5, 1) = 1.5f;
+	const float *data = img.GetPointer(0, 0);
+	ImageRaw raw2(std::move(img));
+	if (raw2.datatype != ImageDataType::FLOAT32 || raw2.format != ImageFormat::BIL ||
+		raw2.GetPointer<float>(0, 0) != data)
+		throw std::logic_error("ImageRaw(Image<T> &&)");
+
+	ImageRaw raw3(raw2);
+	if (raw3.GetPointer<float>(0, 0) == data || raw3.operator()<float>(6, 5, 1) != 1.5f)
+		throw std::logic_error("ImageRaw(const ImageRaw &)");
+	raw3.ConvertFormat(ImageFormat::BIP);
+	raw3.Resize(3, 2, 2);
+	if (raw3.format != ImageFormat::BIP || raw3.size != Size3D< ::size_t>(3, 2, 2))
+		throw std::logic_error("ImageRaw::Resize()");
+
+	img = raw2.Release<float>();
+	if (img.GetPointer(0, 0) != data || img(6, 5, 1) != 1.5f || raw2.size.width != 0 ||
+		raw2.GetView<float>().size.width != 0)
+		throw std::logic_error("ImageRaw::Release<T>()");
 }
 
 void TestCopyWithImage(void)
@@ -110,14 +583,46 @@ void TestCopyWithImage(void)
 
 void TestImage(void)
 {
+	using namespace Imaging;
+
 	std::cout << std::endl << "Test for image.h has started." << std::endl;
 
 	TestImage1<unsigned char>(32, 16, 3);
 	TestImage1<int>(32, 16);
 	TestCopy<unsigned char>();
 	TestCopy<int>();
-
-	TestCopyWithImage();
+	TestAlignment<unsigned char>(ImageFormat::BIP, 64);
+	TestAlignment<unsigned short>(ImageFormat::BSQ, 32);
+	TestAlignment<float>(ImageFormat::BIL, 64);
+	TestView<unsigned char>(ImageFormat::BIP);
+	TestView<short>(ImageFormat::BSQ);
+	TestView<double>(ImageFormat::BIL);
+	TestRangeCheck<unsigned char>(ImageFormat::BIP);
+	TestRangeCheck<int>(ImageFormat::BIL);
+	TestFormattedImage<unsigned char>();
+	TestFormattedImage<float>();
+	TestMove<unsigned char>();
+	TestMove<double>();
+	TestResizeMode<unsigned short>();
+	TestResizeMode<float>();
+	TestCopyAcrossFormats<unsigned char>(3, 0);
+	TestCopyAcrossFormats<unsigned char>(4, 64);
+	TestCopyAcrossFormats<short>(1, 0);
+	TestCopyAcrossFormats<float>(5, 32);
+	TestCopyAcrossFormats<unsigned short>(200, 64);
+	TestConvertFormat<unsigned char>(3, 0);
+	TestConvertFormat<short>(5, 64);
+	TestConvertFormat<unsigned short>(40, 32);
+	TestImageRaw();
+	TestParallelCopy<unsigned short>(ImageFormat::BIP, 16);
+	TestParallelCopy<unsigned short>(ImageFormat::BSQ, 16);
+	TestParallelCopy<float>(ImageFormat::BIL, 8);
 
 	std::cout << std::endl << "Test for image.h has been completed." << std::endl;
+}
+
+/** Shows the copies of an image in windows, which are checked by eyes. */
+void TestImageWithOpenCV(void)
+{
+	TestCopyWithImage();
 }
\ No newline at end of file
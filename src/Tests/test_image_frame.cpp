@@ -3,9 +3,11 @@ image2.h */
 
 #include "../Imaging/image2.h"
 
+#include <chrono>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 template <typename T>
 void TestImageFrame1(::size_t width, ::size_t height, ::size_t depth = 1)
@@ -62,6 +64,295 @@ void TestImageFrame1(::size_t width, ::size_t height, ::size_t depth = 1)
 	//Imaging::ImageFrame<T>::Iterator it = img1.GetIterator(1, 1);
 }
 
+template <typename T>
+void TestImageFrameAlignment(::size_t alignment)
+{
+	using namespace Imaging;
+
+	ImageFrame<T> img1(61, 40, 3, alignment);
+	for (::size_t H = 0; H != img1.size.height; ++H)
+		if (reinterpret_cast<::size_t>(&img1(0, H)) % alignment != 0)
+			throw std::logic_error("ImageFrame<T>::GetElemPerLine()");
+
+	img1(60, 39, 2) = static_cast<T>(1);
+	ImageFrame<T> img2 = img1;
+	if (img2.GetBytesPerLine() != img1.GetBytesPerLine() || img2(60, 39, 2) != img1(60, 39, 2))
+		throw std::logic_error("ImageFrame<T>");
+}
+
+/** A stage of a pipeline, which takes a frame by value and returns it by value.
+It touches a single element only, so the cost of passing the frame is dominant. */
+template <typename T>
+Imaging::ImageFrame<T> Increment(Imaging::ImageFrame<T> frame)
+{
+	++frame(0, 0);
+	return frame;
+}
+
+template <typename T>
+void TestImageFrameMove(void)
+{
+	using namespace Imaging;
+
+	ImageFrame<T> img1(640, 480, 3, 64);
+	const T *p = img1.data.data();
+
+	// Move construction and assignment hand over the buffer.
+	ImageFrame<T> img2 = std::move(img1), img3;
+	img3 = std::move(img2);
+	if (img3.data.data() != p || img3.size != Size3D<::size_t>(640, 480, 3) ||
+		img3.GetAlignment() != 64 || !img1.data.empty() || img2.size.width != 0)
+		throw std::logic_error("ImageFrame<T>::ImageFrame(ImageFrame<T> &&)");
+
+	ImageFrame<T> img4(2, 2);
+	swap(img3, img4);
+	if (img4.data.data() != p || img3.size.width != 2)
+		throw std::logic_error("swap(ImageFrame<T>, ImageFrame<T>)");
+
+	// Frames pass through a pipeline without copying the buffer.
+	img4 = Increment(Increment(Increment(std::move(img4))));
+	if (img4.data.data() != p || img4(0, 0) != static_cast<T>(3))
+		throw std::logic_error("ImageFrame<T>::operator=(ImageFrame<T> &&)");
+
+	// A growing container moves frames.
+	std::vector<ImageFrame<T> > frames;
+	frames.push_back(std::move(img4));
+	for (auto n = 0; n != 16; ++n)
+		frames.push_back(ImageFrame<T>(64, 48, 3));
+	if (frames.front().data.data() != p)
+		throw std::logic_error("std::vector<ImageFrame<T> >::push_back()");
+
+	ImageBlock<T> block1, block2;
+	block2 = std::move(block1);
+	ImageBlock<T> block3 = std::move(block2);
+	swap(block1, block3);
+
+	// Benchmark: a pipeline of 3 stages, where the frames are copied or moved.
+	const int nFrames = 100;
+	ImageFrame<T> img5(1920, 1080, 3);
+	auto start = std::chrono::high_resolution_clock::now();
+	for (::size_t n = 0; n != nFrames; ++n)
+		img5 = Increment(Increment(Increment(img5)));
+	auto copied = std::chrono::high_resolution_clock::now() - start;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (::size_t n = 0; n != nFrames; ++n)
+		img5 = Increment(Increment(Increment(std::move(img5))));
+	auto moved = std::chrono::high_resolution_clock::now() - start;
+
+	std::cout << nFrames << " frames through 3 stages: copied in " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(copied).count() <<
+		" ms, moved in " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(moved).count() << " ms" <<
+		std::endl;
+}
+
+template <typename T>
+void TestImageConversion(::size_t width, ::size_t height, ::size_t depth)
+{
+	using namespace Imaging;
+
+	const Size3D< ::size_t> sz(width, height, depth);
+	const ImageFormat fmts[] = {ImageFormat::BIP, ImageFormat::BSQ, ImageFormat::BIL};
+	for (auto fmt : fmts)
+	{
+		std::vector<T> data(width * height * depth);
+		ImageView<T> view = GetStorageView(data.data(), data.size(), sz, fmt);
+		for (::size_t C = 0; C != depth; ++C)
+			for (::size_t H = 0; H != height; ++H)
+				for (::size_t W = 0; W != width; ++W)
+					view(W, H, C) = static_cast<T>(W + 3 * H + 7 * C);
+
+		// band <-> channel
+		ImageFrame<T> frame(0, 0, 1, 64);
+		ConvertBand2Channel(data, sz, fmt, frame);
+		if (frame.size != sz)
+			throw std::logic_error("ConvertBand2Channel(std::vector<T>, ImageFrame<T>)");
+		for (::size_t C = 0; C != depth; ++C)
+			for (::size_t H = 0; H != height; ++H)
+				for (::size_t W = 0; W != width; ++W)
+					if (frame(W, H, C) != view(W, H, C))
+						throw std::logic_error(
+						"ConvertBand2Channel(std::vector<T>, ImageFrame<T>)");
+		for (auto fmtDst : fmts)
+		{
+			std::vector<T> data2;
+			ConvertChannel2Band(frame, data2, fmtDst);
+			ImageView<T> view2 = GetStorageView(data2.data(), data2.size(), sz, fmtDst);
+			for (::size_t C = 0; C != depth; ++C)
+				for (::size_t H = 0; H != height; ++H)
+					for (::size_t W = 0; W != width; ++W)
+						if (view2(W, H, C) != view(W, H, C))
+							throw std::logic_error(
+							"ConvertChannel2Band(ImageFrame<T>, std::vector<T>)");
+		}
+
+		// band <-> frame
+		ImageBlock<T> block;
+		ConvertBand2Frame(data, sz, fmt, block);
+		if (block.GetFrameCount() != depth)
+			throw std::logic_error("ConvertBand2Frame(std::vector<T>, ImageBlock<T>)");
+		for (::size_t C = 0; C != depth; ++C)
+			for (::size_t H = 0; H != height; ++H)
+				for (::size_t W = 0; W != width; ++W)
+					if (block[C](W, H) != view(W, H, C))
+						throw std::logic_error(
+						"ConvertBand2Frame(std::vector<T>, ImageBlock<T>)");
+		for (auto fmtDst : fmts)
+		{
+			std::vector<T> data2;
+			ConvertFrame2Band(block, data2, fmtDst);
+			ImageView<T> view2 = GetStorageView(data2.data(), data2.size(), sz, fmtDst);
+			for (::size_t C = 0; C != depth; ++C)
+				for (::size_t H = 0; H != height; ++H)
+					for (::size_t W = 0; W != width; ++W)
+						if (view2(W, H, C) != view(W, H, C))
+							throw std::logic_error(
+							"ConvertFrame2Band(ImageBlock<T>, std::vector<T>)");
+		}
+
+		// multi data sets <-> block
+		std::vector<std::vector<T> > series(3, data);
+		for (auto it = series[1].begin(); it != series[1].end(); ++it)
+			*it += static_cast<T>(1);
+		ConvertBand2Channel(series, sz, fmt, block);
+		if (block.GetFrameCount() != series.size() || block[1](0, 0) != view(0, 0) + 1)
+			throw std::logic_error(
+			"ConvertBand2Channel(std::vector<std::vector<T> >, ImageBlock<T>)");
+		std::vector<std::vector<T> > series2;
+		ConvertChannel2Band(block, series2, fmt);
+		if (series2 != series)
+			throw std::logic_error(
+			"ConvertChannel2Band(ImageBlock<T>, std::vector<std::vector<T> >)");
+	}
+
+	try
+	{
+		ImageFrame<T> frame;
+		ConvertBand2Channel(std::vector<T>(width * height), sz, ImageFormat::BIP, frame);
+		if (depth != 1)
+			throw std::logic_error("ConvertBand2Channel() should check the size.");
+	}
+	catch (std::invalid_argument &) {}
+
+	// Benchmark: a cube of many bands to frames and back.
+	const Size3D< ::size_t> szCube(512, 256, 200);
+	std::vector<T> cube(szCube.width * szCube.height * szCube.depth);
+	ImageBlock<T> block;
+	for (auto fmt : fmts)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		ConvertBand2Frame(cube, szCube, fmt, block);
+		auto split = std::chrono::high_resolution_clock::now() - start;
+		start = std::chrono::high_resolution_clock::now();
+		ConvertFrame2Band(block, cube, fmt);
+		auto merged = std::chrono::high_resolution_clock::now() - start;
+
+		std::cout << "512 x 256 x 200 " << static_cast<int>(fmt) <<
+			": band to frame in " <<
+			std::chrono::duration_cast<std::chrono::milliseconds>(split).count() <<
+			" ms, frame to band in " <<
+			std::chrono::duration_cast<std::chrono::milliseconds>(merged).count() << " ms" <<
+			std::endl;
+	}
+}
+
+template <typename T>
+void TestContinuousImageBlock(::size_t width, ::size_t height, ::size_t depth)
+{
+	using namespace Imaging;
+
+	const Size3D< ::size_t> sz(width, height, depth);
+	ContinuousImageBlock<T> block(Size3D< ::size_t>(width, height, 1), depth, 16);
+	if (block.GetFrameCount() != depth || block.GetElemPerFrame() < block.GetElemPerLine() *
+		height || block.data.size() != block.GetElemPerFrame() * depth)
+		throw std::logic_error("ContinuousImageBlock<T>(Size3D<T>, ::size_t, ::size_t)");
+
+	// Every frame starts at a cache line, and the frames are evenly spaced.
+	for (::size_t N = 0; N != depth; ++N)
+	{
+		const T *p = block[N].GetPointer(0, 0);
+		if (reinterpret_cast< ::size_t>(p) % DEFAULT_ALIGNMENT != 0 ||
+			p != block.data.data() + N * block.GetElemPerFrame())
+			throw std::logic_error("ContinuousImageBlock<T>::operator[](::size_t)");
+	}
+
+	std::vector<T> spectrum(depth), spectrum2(depth);
+	for (::size_t N = 0; N != depth; ++N)
+		spectrum[N] = static_cast<T>(N + 1);
+	block.SetSpectrum(width - 1, height - 1, 0, spectrum.data());
+	block.GetSpectrum(width - 1, height - 1, 0, spectrum2.data());
+	if (spectrum2 != spectrum || block[depth - 1](width - 1, height - 1) != depth)
+		throw std::logic_error("ContinuousImageBlock<T>::GetSpectrum()");
+
+	// band <-> frame gives the same result as ImageBlock<T>.
+	const ImageFormat fmts[] = {ImageFormat::BIP, ImageFormat::BSQ, ImageFormat::BIL};
+	for (auto fmt : fmts)
+	{
+		std::vector<T> data(width * height * depth);
+		for (::size_t N = 0; N != data.size(); ++N)
+			data[N] = static_cast<T>(N % 251);
+
+		ImageBlock<T> block1;
+		ConvertBand2Frame(data, sz, fmt, block1);
+		ConvertBand2Frame(data, sz, fmt, block);
+		for (::size_t C = 0; C != depth; ++C)
+			for (::size_t H = 0; H != height; ++H)
+				for (::size_t W = 0; W != width; ++W)
+					if (block[C](W, H) != block1[C](W, H))
+						throw std::logic_error(
+						"ConvertBand2Frame(std::vector<T>, ContinuousImageBlock<T>)");
+
+		std::vector<T> data2;
+		ConvertFrame2Band(block, data2, fmt);
+		if (data2 != data)
+			throw std::logic_error(
+			"ConvertFrame2Band(ContinuousImageBlock<T>, std::vector<T>)");
+	}
+
+	const T *p = block.data.data();
+	ContinuousImageBlock<T> block2 = std::move(block);
+	if (block2.data.data() != p || block.GetFrameCount() != 0)
+		throw std::logic_error("ContinuousImageBlock<T>(ContinuousImageBlock<T> &&)");
+	swap(block, block2);
+	if (block.data.data() != p || block2.GetFrameCount() != 0)
+		throw std::logic_error("swap(ContinuousImageBlock<T>, ContinuousImageBlock<T>)");
+
+	// Benchmark: spectra of all pixels from frames of separate buffers and of a block.
+	const Size3D< ::size_t> szCube(256, 256, 200);
+	std::vector<T> cube(szCube.width * szCube.height * szCube.depth);
+	ImageBlock<T> block3;
+	ConvertBand2Frame(cube, szCube, ImageFormat::BSQ, block3);
+	ConvertBand2Frame(cube, szCube, ImageFormat::BSQ, block);
+	spectrum.resize(szCube.depth);
+	double sum = 0.0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (::size_t H = 0; H != szCube.height; ++H)
+		for (::size_t W = 0; W != szCube.width; ++W)
+			for (::size_t N = 0; N != szCube.depth; ++N)
+				sum += block3[N](W, H);
+	auto separate = std::chrono::high_resolution_clock::now() - start;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (::size_t H = 0; H != szCube.height; ++H)
+	{
+		for (::size_t W = 0; W != szCube.width; ++W)
+		{
+			block.GetSpectrum(W, H, 0, spectrum.data());
+			for (::size_t N = 0; N != szCube.depth; ++N)
+				sum += spectrum[N];
+		}
+	}
+	auto continuous = std::chrono::high_resolution_clock::now() - start;
+
+	std::cout << "Spectra of 256 x 256 x 200: separate frames in " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(separate).count() <<
+		" ms, continuous frames in " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(continuous).count() <<
+		" ms (" << sum << ")" << std::endl;
+}
+
 void TestImageFrame(void)
 {
 	using namespace Imaging;
@@ -70,6 +361,15 @@ void TestImageFrame(void)
 
 	TestImageFrame1<unsigned char>(32, 16, 3);
 	TestImageFrame1<int>(32, 16);
+	TestImageFrameAlignment<unsigned char>(64);
+	TestImageFrameAlignment<double>(32);
+	TestImageFrameMove<unsigned char>();
+	TestImageFrameMove<float>();
+	TestImageConversion<unsigned char>(37, 21, 3);
+	TestImageConversion<unsigned short>(19, 7, 5);
+	TestImageConversion<float>(8, 3, 1);
+	TestContinuousImageBlock<unsigned char>(37, 21, 5);
+	TestContinuousImageBlock<unsigned short>(13, 7, 40);
 
 	std::cout << std::endl << "Test for image2.h has been completed." << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,401 @@
+/** This file contains the test functions to test classes and functions defined in
+image_processing.h */
+
+#include "../Imaging/image_processing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+/** Fills an image with a pattern giving every channel a different value. */
+template <typename T>
+void FillPattern(Imaging::Image<T> &img, double maxValue)
+{
+	for (::size_t C = 0; C != img.size.depth; ++C)
+		for (::size_t H = 0; H != img.size.height; ++H)
+			for (::size_t W = 0; W != img.size.width; ++W)
+				img(W, H, C) = static_cast<T>(std::fmod(W * 7.0 + H * 13.0 + C * 50.0 +
+					(W * H % 5) * 3.0, maxValue));
+}
+
+template <typename T>
+bool IsNear(T a, T b, double tolerance)
+{
+	return std::abs(static_cast<double>(a) - static_cast<double>(b)) <= tolerance;
+}
+
+/** A flat image stays flat for every interpolation, the layouts give the same result,
+and the threads do not change the result. */
+template <typename T>
+void TestResizeLayouts(double maxValue)
+{
+	using namespace Imaging;
+
+	const Interpolation interps[] = {Interpolation::NEAREST, Interpolation::LINEAR,
+		Interpolation::AREA, Interpolation::CUBIC, Interpolation::LANCZO};
+	const Point2D<double> zms[] = {Point2D<double>(2.0, 2.0), Point2D<double>(0.5, 0.5),
+		Point2D<double>(0.3, 1.7), Point2D<double>(1.25, 0.75)};
+	const ::size_t nThreadsMax = GetThreadCount();
+
+	// Floating-point sums may be rounded differently by vectorized loops.
+	const double tolerance = std::numeric_limits<T>::is_integer ? 0.0 : maxValue * 1e-5;
+	for (auto interp : interps)
+	{
+		const T value = static_cast<T>(maxValue / 3);
+		Image<T> flat(37, 23, 3);
+		for (::size_t C = 0; C != 3; ++C)
+			for (::size_t H = 0; H != flat.size.height; ++H)
+				for (::size_t W = 0; W != flat.size.width; ++W)
+					flat(W, H, C) = value;
+		Image<T> imgDst;
+		Resize(flat, Point2D<double>(1.7, 0.6), imgDst, interp);
+		for (::size_t C = 0; C != 3; ++C)
+			for (::size_t H = 0; H != imgDst.size.height; ++H)
+				for (::size_t W = 0; W != imgDst.size.width; ++W)
+					if (!IsNear(imgDst(W, H, C), value, tolerance))
+						throw std::logic_error("Resize() of a flat image");
+
+		for (auto &zm : zms)
+		{
+			Image<T> img(150, 97, 3, ImageFormat::BIP, 32);
+			FillPattern(img, maxValue);
+
+			SetThreadCount(1);
+			Image<T> imgBip;
+			Resize(img, zm, imgBip, interp);
+			if (imgBip.size.width != static_cast< ::size_t>(150 * zm.x + 0.5) ||
+				imgBip.size.height != static_cast< ::size_t>(97 * zm.y + 0.5))
+				throw std::logic_error("Resize() destination size");
+
+			SetThreadCount(4);
+			const ImageFormat fmts[] = {ImageFormat::BIP, ImageFormat::BSQ, ImageFormat::BIL};
+			for (auto fmt : fmts)
+			{
+				Image<T> imgFmt, imgDstFmt;
+				Copy(img, img.GetRoi(), imgFmt, fmt);
+				Resize(imgFmt, zm, imgDstFmt, interp);
+				if (imgDstFmt.format != fmt || imgDstFmt.size != imgBip.size)
+					throw std::logic_error("Resize() format");
+				for (::size_t C = 0; C != 3; ++C)
+					for (::size_t H = 0; H != imgBip.size.height; ++H)
+						for (::size_t W = 0; W != imgBip.size.width; ++W)
+							if (!IsNear(imgDstFmt(W, H, C), imgBip(W, H, C), tolerance))
+								throw std::logic_error("Resize() across formats or threads");
+			}
+		}
+	}
+	SetThreadCount(nThreadsMax);
+}
+
+/** Checks interpolations whose results are known exactly. */
+void TestResizeValues(void)
+{
+	using namespace Imaging;
+
+	Image<unsigned char> img(8, 6, 2);
+	FillPattern(img, 255.0);
+
+	// Nearest neighbor replicates pixels by an integer zoom.
+	Image<unsigned char> imgDst;
+	Resize(img, Point2D<double>(3.0, 2.0), imgDst, Interpolation::NEAREST);
+	for (::size_t C = 0; C != 2; ++C)
+		for (::size_t H = 0; H != imgDst.size.height; ++H)
+			for (::size_t W = 0; W != imgDst.size.width; ++W)
+				if (imgDst(W, H, C) != img(W / 3, H / 2, C))
+					throw std::logic_error("Resize() NEAREST");
+
+	// Area averages 2 x 2 pixels.
+	Resize(img, Point2D<double>(0.5, 0.5), imgDst, Interpolation::AREA);
+	for (::size_t C = 0; C != 2; ++C)
+		for (::size_t H = 0; H != imgDst.size.height; ++H)
+			for (::size_t W = 0; W != imgDst.size.width; ++W)
+			{
+				const int sum = img(2 * W, 2 * H, C) + img(2 * W + 1, 2 * H, C) +
+					img(2 * W, 2 * H + 1, C) + img(2 * W + 1, 2 * H + 1, C);
+				if (std::abs(imgDst(W, H, C) * 4 - sum) > 2)
+					throw std::logic_error("Resize() AREA");
+			}
+
+	// Linear interpolation of a ramp is the ramp inside the image.
+	Image<float> ramp(16, 10, 1);
+	for (::size_t H = 0; H != 10; ++H)
+		for (::size_t W = 0; W != 16; ++W)
+			ramp(W, H) = static_cast<float>(2 * W + 3 * H);
+	Image<float> rampDst;
+	Resize(ramp, Point2D<double>(2.0, 2.0), rampDst, Interpolation::LINEAR);
+	for (::size_t H = 1; H + 1 < rampDst.size.height; ++H)
+		for (::size_t W = 1; W + 1 < rampDst.size.width; ++W)
+		{
+			const double x = (W + 0.5) / 2 - 0.5, y = (H + 0.5) / 2 - 0.5;
+			if (std::abs(rampDst(W, H) - (2 * x + 3 * y)) > 1e-4)
+				throw std::logic_error("Resize() LINEAR");
+		}
+
+	// A view of an ROI is resized into an ROI of a larger image.
+	Image<unsigned short> canvas(40, 30, 1);
+	Image<unsigned short> src(20, 20, 1);
+	FillPattern(src, 60000.0);
+	Resize(src.GetView(Region< ::size_t, ::size_t>(5, 5, 10, 10)),
+		canvas.GetView(Region< ::size_t, ::size_t>(3, 4, 20, 20)), Interpolation::CUBIC);
+	for (::size_t H = 0; H != 30; ++H)
+		for (::size_t W = 0; W != 40; ++W)
+			if ((W < 3 || W >= 23 || H < 4 || H >= 24) && canvas(W, H) != 0)
+				throw std::logic_error("Resize() into an ROI");
+
+	try
+	{
+		Image<unsigned short> other(20, 20, 2);
+		Resize(src.GetView(), other.GetView());
+		throw std::logic_error("Resize() should check the number of channels.");
+	}
+	catch (std::invalid_argument &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+/** Fixed-point resampling of 16-bit elements is within 1 of resampling in double, where a
+checkerboard of the extreme values makes the largest sums of the taps. */
+template <typename T>
+void TestResizeReference(void)
+{
+	using namespace Imaging;
+
+	const Interpolation interps[] = {Interpolation::LINEAR, Interpolation::AREA,
+		Interpolation::CUBIC, Interpolation::LANCZO};
+	const Point2D<double> zms[] = {Point2D<double>(1.7, 0.6), Point2D<double>(0.45, 2.3)};
+	Image<T> img(37, 29, 1);
+	Image<double> imgRef(37, 29, 1);
+	for (::size_t H = 0; H != img.size.height; ++H)
+		for (::size_t W = 0; W != img.size.width; ++W)
+		{
+			img(W, H, 0) = (W + H) % 2 == 0 ? std::numeric_limits<T>::max() :
+				std::numeric_limits<T>::min();
+			imgRef(W, H, 0) = img(W, H, 0);
+		}
+
+	for (auto interp : interps)
+		for (auto &zm : zms)
+		{
+			Image<T> imgDst;
+			Image<double> imgDstRef;
+			Resize(img, zm, imgDst, interp);
+			Resize(imgRef, zm, imgDstRef, interp);
+			for (::size_t H = 0; H != imgDst.size.height; ++H)
+				for (::size_t W = 0; W != imgDst.size.width; ++W)
+				{
+					const double value = std::min(std::max(
+						std::floor(imgDstRef(W, H, 0) + 0.5),
+						static_cast<double>(std::numeric_limits<T>::min())),
+						static_cast<double>(std::numeric_limits<T>::max()));
+					if (!IsNear(static_cast<double>(imgDst(W, H, 0)), value, 1.0))
+						throw std::logic_error("Resize() against the reference in double");
+				}
+		}
+}
+
+/** Composes zoomed tiles into a canvas in place, where a tile is the same as the tile
+resized into its own image. */
+template <typename T>
+void TestResizeIntoRoi(Imaging::ImageFormat fmt)
+{
+	using namespace Imaging;
+
+	Image<T> img(64, 48, 3, fmt);
+	FillPattern(img, 200.0);
+	Image<T> canvas(100, 80, 3, fmt);
+	const T background = 7;
+	for (::size_t C = 0; C != 3; ++C)
+		for (::size_t H = 0; H != canvas.size.height; ++H)
+			for (::size_t W = 0; W != canvas.size.width; ++W)
+				canvas(W, H, C) = background;
+
+	const Region< ::size_t, ::size_t> roiSrcs[] = {Region< ::size_t, ::size_t>(0, 0, 32, 24),
+		Region< ::size_t, ::size_t>(32, 0, 32, 24), Region< ::size_t, ::size_t>(10, 20, 40, 24)};
+	const Point2D< ::size_t> orgnDsts[] = {Point2D< ::size_t>(0, 0), Point2D< ::size_t>(48, 0),
+		Point2D< ::size_t>(20, 40)};
+	const Point2D<double> zm(1.5, 1.5);
+	for (int N = 0; N != 3; ++N)
+	{
+		// Repeated calls reuse the buffers of the thread.
+		for (int M = 0; M != 2; ++M)
+			Resize(img, roiSrcs[N], zm, canvas, orgnDsts[N], Interpolation::CUBIC);
+
+		Image<T> tile;
+		Resize(img, roiSrcs[N], zm, tile, Interpolation::CUBIC);
+		for (::size_t C = 0; C != 3; ++C)
+			for (::size_t H = 0; H != tile.size.height; ++H)
+				for (::size_t W = 0; W != tile.size.width; ++W)
+					if (canvas(orgnDsts[N].x + W, orgnDsts[N].y + H, C) != tile(W, H, C))
+						throw std::logic_error("Resize() into a destination ROI");
+	}
+	for (::size_t C = 0; C != 3; ++C)
+		if (canvas(99, 79, C) != background || canvas(0, 79, C) != background)
+			throw std::logic_error("Resize() out of a destination ROI");
+
+	try
+	{
+		Resize(img, img.GetRoi(), zm, canvas, Point2D< ::size_t>(10, 10));
+		throw std::logic_error("Resize() should check the destination ROI.");
+	}
+	catch (std::out_of_range &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+/** Resizes into a view of some channels of a BIP image, which keeps the other channels
+between the pixels of the view, where the other channel differs for every pixel. */
+void TestResizeIntoChannels(void)
+{
+	using namespace Imaging;
+
+	const Interpolation interps[] = {Interpolation::NEAREST, Interpolation::LINEAR,
+		Interpolation::AREA, Interpolation::CUBIC, Interpolation::LANCZO};
+	Image<unsigned char> img(4, 4, 2);
+	FillPattern(img, 200.0);
+	for (auto interp : interps)
+	{
+		Image<unsigned char> canvas(8, 8, 3);
+		for (::size_t H = 0; H != 8; ++H)
+			for (::size_t W = 0; W != 8; ++W)
+				canvas(W, H, 2) = static_cast<unsigned char>(W + 10 * H);
+		const ImageView<unsigned char> view(canvas.GetPointer(0, 0),
+			Size3D< ::size_t>(8, 8, 2), ImageFormat::BIP, canvas.GetView().step);
+		Resize(img.GetView(), view, interp);
+
+		Image<unsigned char> full;
+		Resize(img, Point2D<double>(2.0, 2.0), full, interp);
+		for (::size_t H = 0; H != 8; ++H)
+			for (::size_t W = 0; W != 8; ++W)
+				if (canvas(W, H, 0) != full(W, H, 0) || canvas(W, H, 1) != full(W, H, 1) ||
+					canvas(W, H, 2) != W + 10 * H)
+					throw std::logic_error("Resize() into a view of some channels");
+	}
+}
+
+/** A plan gives the same result as Resize() for every frame, and checks the sizes. */
+void TestResizePlan(void)
+{
+	using namespace Imaging;
+
+	const Size2D< ::size_t> szSrc(45, 31);
+	const Point2D<double> zm(1.3, 0.7);
+	const ResizePlan<unsigned short> plan(szSrc, zm, Interpolation::LANCZO);
+	if (plan.GetDestinationSize() != Size2D< ::size_t>(59, 22) ||
+		plan.GetInterpolation() != Interpolation::LANCZO)
+		throw std::logic_error("ResizePlan<T>::ResizePlan()");
+
+	Image<unsigned short> frame(45, 31, 2), imgPlan, imgDst;
+	for (int N = 0; N != 3; ++N)
+	{
+		FillPattern(frame, 1000.0 * (N + 1));
+		plan.Execute(frame, imgPlan);
+		Resize(frame, zm, imgDst, Interpolation::LANCZO);
+		if (imgPlan.size != imgDst.size || imgPlan.data != imgDst.data)
+			throw std::logic_error("ResizePlan<T>::Execute()");
+	}
+
+	try
+	{
+		Image<unsigned short> other(44, 31, 2);
+		plan.Execute(other, imgPlan);
+		throw std::logic_error("ResizePlan<T>::Execute() should check the source size.");
+	}
+	catch (std::invalid_argument &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+
+	// More geometries than the cache are used in turn.
+	ResizePlan<unsigned short> plan2;
+	for (int M = 0; M != 2; ++M)
+		for (::size_t N = 0; N != RESIZE_PLAN_CACHE_SIZE + 2; ++N)
+		{
+			const Size2D< ::size_t> szDst(20 + N, 10 + N);
+			plan2.Reset(szSrc, szDst, Interpolation::CUBIC);
+			plan2.Execute(frame, imgPlan);
+			Resize(frame.GetView(), imgDst.GetView(Region< ::size_t, ::size_t>(0, 0, szDst.width,
+				szDst.height)), Interpolation::CUBIC);
+			for (::size_t C = 0; C != 2; ++C)
+				for (::size_t H = 0; H != szDst.height; ++H)
+					for (::size_t W = 0; W != szDst.width; ++W)
+						if (imgPlan(W, H, C) != imgDst(W, H, C))
+							throw std::logic_error("ResizePlanCache<T>");
+		}
+}
+
+/** Compares the time with cv::resize() for a frame of the typical size. */
+template <typename T>
+void BenchmarkResize(int cvType, Imaging::Interpolation interp, int cvInterp,
+	const Imaging::Point2D<double> &zm)
+{
+	using namespace Imaging;
+
+	const int nFrames = 20;
+	Image<T> img(1920, 1080, 3);
+	FillPattern(img, 200.0);
+	Image<T> imgDst;
+	Resize(img, zm, imgDst, interp);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (::size_t n = 0; n != nFrames; ++n)
+		Resize(img, zm, imgDst, interp);
+	auto native = std::chrono::high_resolution_clock::now() - start;
+
+	cv::Mat cvSrc(SafeCast_<int>(img.size.height), SafeCast_<int>(img.size.width), cvType,
+		img.GetPointer(0, 0), img.GetBytesPerLine());
+	cv::Mat cvDst(SafeCast_<int>(imgDst.size.height), SafeCast_<int>(imgDst.size.width),
+		cvType, imgDst.GetPointer(0, 0), imgDst.GetBytesPerLine());
+	start = std::chrono::high_resolution_clock::now();
+	for (::size_t n = 0; n != nFrames; ++n)
+		cv::resize(cvSrc, cvDst, cvDst.size(), 0, 0, cvInterp);
+	auto opencv = std::chrono::high_resolution_clock::now() - start;
+
+	std::cout << "Resize() of " << nFrames << " frames of " << sizeof(T) <<
+		"-byte elements by (" << zm.x << ", " << zm.y << ") with interpolation " <<
+		static_cast<int>(interp) << ": " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(native).count() <<
+		" ms, cv::resize() " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(opencv).count() << " ms" <<
+		std::endl;
+}
+
+void TestImageProcessing(void)
+{
+	using namespace Imaging;
+
+	std::cout << std::endl << "Test for image_processing.h has started." << std::endl;
+
+	TestResizeLayouts<unsigned char>(255.0);
+	TestResizeLayouts<short>(30000.0);
+	TestResizeLayouts<unsigned short>(65535.0);
+	TestResizeLayouts<int>(1e6);
+	TestResizeLayouts<float>(1000.0);
+	TestResizeLayouts<double>(1000.0);
+	TestResizeValues();
+	TestResizeReference<unsigned short>();
+	TestResizeReference<short>();
+	TestResizeIntoRoi<unsigned char>(ImageFormat::BIP);
+	TestResizeIntoRoi<unsigned char>(ImageFormat::BSQ);
+	TestResizeIntoRoi<float>(ImageFormat::BIL);
+	TestResizeIntoChannels();
+	TestResizePlan();
+
+	const Point2D<double> zmHalf(0.5, 0.5), zmUp(1.5, 1.5);
+	BenchmarkResize<unsigned char>(CV_8UC3, Interpolation::LINEAR, cv::INTER_LINEAR, zmHalf);
+	BenchmarkResize<unsigned char>(CV_8UC3, Interpolation::LINEAR, cv::INTER_LINEAR, zmUp);
+	BenchmarkResize<unsigned char>(CV_8UC3, Interpolation::AREA, cv::INTER_AREA, zmHalf);
+	BenchmarkResize<unsigned char>(CV_8UC3, Interpolation::CUBIC, cv::INTER_CUBIC, zmUp);
+	BenchmarkResize<unsigned short>(CV_16UC3, Interpolation::LINEAR, cv::INTER_LINEAR, zmUp);
+	BenchmarkResize<float>(CV_32FC3, Interpolation::LANCZO, cv::INTER_LANCZOS4, zmUp);
+
+	std::cout << std::endl << "Test for image_processing.h has been completed." << std::endl;
+}
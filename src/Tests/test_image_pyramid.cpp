@@ -0,0 +1,177 @@
+/** This file contains the test functions to test classes and functions defined in
+image_pyramid.h */
+
+#include "../Imaging/image_pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <iostream>
+
+/** Computes a pixel of the next level by the definition of the filters. */
+template <typename T>
+double ReducePixel(const Imaging::ImageView<const T> &src, ::size_t x, ::size_t y,
+	::size_t c, Imaging::PyramidFilter filter)
+{
+	const double box[] = {1.0, 1.0};
+	const double gaussian[] = {1.0, 3.0, 3.0, 1.0};
+	const bool isBox = filter == Imaging::PyramidFilter::BOX;
+	const double *w = isBox ? box : gaussian;
+	const long long n = isBox ? 2 : 4, offset = isBox ? 0 : 1;
+	const long long wLast = src.size.width - 1, hLast = src.size.height - 1;
+	double sum = 0.0, sumWeights = 0.0;
+	for (long long J = 0; J != n; ++J)
+		for (long long I = 0; I != n; ++I)
+		{
+			const long long xs = std::min(std::max(2 * static_cast<long long>(x) + I - offset,
+				0LL), wLast);
+			const long long ys = std::min(std::max(2 * static_cast<long long>(y) + J - offset,
+				0LL), hLast);
+			sum += w[I] * w[J] * src(static_cast< ::size_t>(xs), static_cast< ::size_t>(ys),
+				c);
+			sumWeights += w[I] * w[J];
+		}
+	return sum / sumWeights;
+}
+
+template <typename T>
+void CheckPyramid(const Imaging::ImagePyramid<T> &pyramid, double tolerance)
+{
+	using namespace Imaging;
+
+	for (::size_t L = 1; L != pyramid.GetLevelCount(); ++L)
+	{
+		const ImageView<const T> src = pyramid[L - 1], dst = pyramid[L];
+		if (dst.size.width != (src.size.width + 1) / 2 ||
+			dst.size.height != (src.size.height + 1) / 2 || dst.size.depth != src.size.depth)
+			throw std::logic_error("ImagePyramid<T> level size");
+		for (::size_t C = 0; C != dst.size.depth; ++C)
+			for (::size_t H = 0; H != dst.size.height; ++H)
+				for (::size_t W = 0; W != dst.size.width; ++W)
+					if (std::abs(dst(W, H, C) - ReducePixel(src, W, H, C,
+						pyramid.GetFilter())) > tolerance)
+						throw std::logic_error("ImagePyramid<T> level value");
+	}
+}
+
+template <typename T>
+void TestPyramidBuild(Imaging::ImageFormat fmt, Imaging::PyramidFilter filter,
+	double tolerance)
+{
+	using namespace Imaging;
+
+	Image<T> img(37, 23, 3, fmt);
+	for (::size_t C = 0; C != 3; ++C)
+		for (::size_t H = 0; H != 23; ++H)
+			for (::size_t W = 0; W != 37; ++W)
+				img(W, H, C) = static_cast<T>((W * 7 + H * 13 + C * 50 + W * H % 11) % 200);
+
+	ImagePyramid<T> pyramid(img.GetView(), 0, filter);
+	if (pyramid.GetLevelCount() != 7 || pyramid[6].size != Size3D< ::size_t>(1, 1, 3) ||
+		pyramid[0].format != fmt)
+		throw std::logic_error("ImagePyramid<T>::Build()");
+	for (::size_t C = 0; C != 3; ++C)
+		for (::size_t H = 0; H != 23; ++H)
+			for (::size_t W = 0; W != 37; ++W)
+				if (pyramid[0](W, H, C) != img(W, H, C))
+					throw std::logic_error("ImagePyramid<T> level 0");
+	CheckPyramid(pyramid, tolerance);
+
+	// An update gives the same levels as building them again.
+	const Region< ::size_t, ::size_t> rois[] = {Region< ::size_t, ::size_t>(5, 3, 4, 2),
+		Region< ::size_t, ::size_t>(0, 0, 1, 1), Region< ::size_t, ::size_t>(30, 18, 20, 20),
+		Region< ::size_t, ::size_t>(36, 22, 1, 1)};
+	for (auto &roi : rois)
+	{
+		for (::size_t C = 0; C != 3; ++C)
+			for (::size_t H = roi.origin.y; H < std::min< ::size_t>(roi.origin.y +
+				roi.size.height, 23); ++H)
+				for (::size_t W = roi.origin.x; W < std::min< ::size_t>(roi.origin.x +
+					roi.size.width, 37); ++W)
+					img(W, H, C) = static_cast<T>(255 - img(W, H, C));
+		pyramid.Update(img.GetView(), roi);
+
+		const ImagePyramid<T> rebuilt(img.GetView(), 0, filter);
+		for (::size_t L = 0; L != rebuilt.GetLevelCount(); ++L)
+			for (::size_t C = 0; C != 3; ++C)
+				for (::size_t H = 0; H != rebuilt[L].size.height; ++H)
+					for (::size_t W = 0; W != rebuilt[L].size.width; ++W)
+						if (pyramid[L](W, H, C) != rebuilt[L](W, H, C))
+							throw std::logic_error("ImagePyramid<T>::Update()");
+	}
+}
+
+void TestPyramidLevels(void)
+{
+	using namespace Imaging;
+
+	Image<unsigned char> img(100, 60, 1);
+	ImagePyramid<unsigned char> pyramid(img.GetView(), 3);
+	if (pyramid.GetLevelCount() != 3 || pyramid[2].size != Size3D< ::size_t>(25, 15, 1))
+		throw std::logic_error("ImagePyramid<T>::Build() with levels");
+	if (pyramid.GetLevel(2.0) != 0 || pyramid.GetLevel(1.0) != 0 ||
+		pyramid.GetLevel(0.5) != 1 || pyramid.GetLevel(0.3) != 1 ||
+		pyramid.GetLevel(0.25) != 2 || pyramid.GetLevel(0.01) != 2)
+		throw std::logic_error("ImagePyramid<T>::GetLevel()");
+	if (pyramid.GetLevelRegion(Region< ::size_t, ::size_t>(10, 5, 11, 50), 2) !=
+		Region< ::size_t, ::size_t>(2, 1, 4, 13))
+		throw std::logic_error("ImagePyramid<T>::GetLevelRegion()");
+
+	// A flat image stays flat.
+	Image<float> flat(9, 5, 2);
+	for (::size_t C = 0; C != 2; ++C)
+		for (::size_t H = 0; H != 5; ++H)
+			for (::size_t W = 0; W != 9; ++W)
+				flat(W, H, C) = 0.75f;
+	const ImagePyramid<float> flatPyramid(flat.GetView(), 0, PyramidFilter::GAUSSIAN);
+	for (::size_t L = 0; L != flatPyramid.GetLevelCount(); ++L)
+		for (::size_t C = 0; C != 2; ++C)
+			for (::size_t H = 0; H != flatPyramid[L].size.height; ++H)
+				for (::size_t W = 0; W != flatPyramid[L].size.width; ++W)
+					if (flatPyramid[L](W, H, C) != 0.75f)
+						throw std::logic_error("ImagePyramid<T> flat");
+
+	// A large image is built by many tiles on several threads.
+	const ::size_t nThreads = GetThreadCount();
+	Image<unsigned short> large(600, 400, 3);
+	for (::size_t C = 0; C != 3; ++C)
+		for (::size_t H = 0; H != 400; ++H)
+			for (::size_t W = 0; W != 600; ++W)
+				large(W, H, C) = static_cast<unsigned short>((W * W + H * 31 + C) % 60000);
+	SetThreadCount(4);
+	const ImagePyramid<unsigned short> largePyramid(large.GetView(), 0,
+		PyramidFilter::GAUSSIAN);
+	SetThreadCount(nThreads);
+	CheckPyramid(largePyramid, 0.5);
+
+	try
+	{
+		Image<unsigned char> other(100, 61, 1);
+		pyramid.Update(other.GetView(), other.GetRoi());
+		throw std::logic_error("ImagePyramid<T>::Update() should check the size.");
+	}
+	catch (std::invalid_argument &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+void TestImagePyramid(void)
+{
+	using namespace Imaging;
+
+	std::cout << std::endl << "Test for image_pyramid.h has started." << std::endl;
+
+	const ImageFormat fmts[] = {ImageFormat::BIP, ImageFormat::BSQ, ImageFormat::BIL};
+	for (auto fmt : fmts)
+	{
+		TestPyramidBuild<unsigned char>(fmt, PyramidFilter::BOX, 0.5);
+		TestPyramidBuild<unsigned char>(fmt, PyramidFilter::GAUSSIAN, 0.5);
+		TestPyramidBuild<int>(fmt, PyramidFilter::GAUSSIAN, 0.5);
+		TestPyramidBuild<float>(fmt, PyramidFilter::BOX, 1e-4);
+		TestPyramidBuild<double>(fmt, PyramidFilter::GAUSSIAN, 1e-9);
+	}
+	TestPyramidLevels();
+
+	std::cout << std::endl << "Test for image_pyramid.h has been completed." << std::endl;
+}
@@ -0,0 +1,121 @@
+/** This file contains the test functions to test classes and functions defined in
+image_range.h */
+
+#include "../Imaging/image_range.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <numeric>
+
+template <typename T>
+void TestLines(Imaging::ImageFormat fmt)
+{
+	using namespace Imaging;
+
+	Image<T> img1(40, 30, 3, fmt, 64);
+	Region<typename Image<T>::SizeType, typename Image<T>::SizeType> roi(5, 10, 20, 15);
+	ImageView<T> view1 = img1.GetView(roi);
+
+	// Lines in the order of memory.
+	SpanRange<T> lines = GetLines(view1);
+	const ::size_t nLines = fmt == ImageFormat::BIP ? roi.size.height :
+		roi.size.height * img1.size.depth;
+	const ::size_t nElemWidth = fmt == ImageFormat::BIP ? roi.size.width * img1.size.depth :
+		roi.size.width;
+	if (lines.size() != nLines || lines[0].size() != nElemWidth)
+		throw std::logic_error("GetLines()");
+
+	// The same value for each line by a standard algorithm.
+	T value = 0;
+	std::for_each(lines.begin(), lines.end(), [&value](Span<T> line)
+	{
+		std::fill(line.begin(), line.end(), value++);
+	});
+
+	for (::size_t C = 0; C != view1.size.depth; ++C)
+		for (::size_t H = 0; H != view1.size.height; ++H)
+			for (::size_t W = 0; W != view1.size.width; ++W)
+			{
+				::size_t n;
+				switch (fmt)
+				{
+				case ImageFormat::BIP:
+					n = H;
+					break;
+				case ImageFormat::BSQ:
+					n = H + view1.size.height * C;
+					break;
+				default:
+					n = C + view1.size.depth * H;
+					break;
+				}
+				if (view1(W, H, C) != static_cast<T>(n))
+					throw std::logic_error("SpanIterator<T>");
+			}
+
+	// The elements outside of the ROI are not touched.
+	if (img1(4, 10, 0) != 0 || img1(25, 24, 2) != 0 || img1(5, 9, 1) != 0)
+		throw std::logic_error("GetLines()");
+
+	// Random access.
+	auto it = lines.begin() + 3;
+	if ((*it).data() != lines[3].data() ||
+		lines.end() - it != static_cast< ::ptrdiff_t>(nLines - 3) || !(it < lines.end()))
+		throw std::logic_error("SpanIterator<T>");
+}
+
+template <typename T>
+void TestPixels(void)
+{
+	using namespace Imaging;
+
+	Image<T> img1(20, 10, 4);
+	ImageView<const T> view1 = img1.GetView();
+	for (::size_t H = 0; H != img1.size.height; ++H)
+		for (::size_t W = 0; W != img1.size.width; ++W)
+			for (::size_t C = 0; C != img1.size.depth; ++C)
+				img1(W, H, C) = static_cast<T>(W + C);
+
+	// Each pixel is a span of channels.
+	SpanRange<const T> pixels = GetPixels(view1, 7);
+	if (pixels.size() != img1.size.width)
+		throw std::logic_error("GetPixels()");
+	::size_t W = 0;
+	for (auto pixel : pixels)
+	{
+		if (pixel.size() != img1.size.depth || pixel.data() != &img1(W, 7, 0) ||
+			std::accumulate(pixel.begin(), pixel.end(), 0) != static_cast<int>(4 * W + 6))
+			throw std::logic_error("GetPixels()");
+		++W;
+	}
+
+	bool isRejected = false;
+	try
+	{
+		Image<T> img2(20, 10, 4, ImageFormat::BSQ);
+		GetPixels(img2.GetView(), 0);
+	}
+	catch (const std::logic_error &ex)
+	{
+		std::cout << ex.what() << std::endl;
+		isRejected = true;
+	}
+	if (!isRejected)
+		throw std::logic_error("GetPixels() should reject a view other than BIP.");
+}
+
+void TestImageRange(void)
+{
+	using namespace Imaging;
+
+	std::cout << std::endl << "Test for image_range.h has started." << std::endl;
+
+	TestLines<unsigned char>(ImageFormat::BIP);
+	TestLines<short>(ImageFormat::BSQ);
+	TestLines<float>(ImageFormat::BIL);
+	TestPixels<unsigned char>();
+	TestPixels<int>();
+
+	std::cout << std::endl << "Test for image_range.h has been completed." << std::endl;
+}
@@ -0,0 +1,165 @@
+/** This file contains the test functions to test classes and functions defined in
+out_of_core_block.h */
+
+#include "../Imaging/out_of_core_block.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+template <typename T>
+void TestOutOfCoreBlock(::size_t width, ::size_t height, ::size_t depth)
+{
+	using namespace Imaging;
+
+	const char *path = "test_out_of_core_block.bin";
+	const Size3D< ::size_t> sz(width, height, depth);
+	const ::size_t nBytesFrame = width * height * depth * sizeof(T);
+	const ::size_t nFrames = 20;
+
+	{
+		OutOfCoreBlock<T> block(path, sz, nFrames, 4 * nBytesFrame);
+		if (block.GetFrameCount() != nFrames || block.size != sz)
+			throw std::logic_error("OutOfCoreBlock<T>(std::string, Size3D<T>, ...)");
+
+		// Frames never written are zeros.
+		if ((*block.Read(nFrames - 1))(width - 1, height - 1, depth - 1) != T())
+			throw std::logic_error("OutOfCoreBlock<T>::Read()");
+
+		// Write all frames sequentially, so the residency stays within the budget.
+		for (::size_t N = 0; N != nFrames; ++N)
+		{
+			auto frame = block.Write(N);
+			for (::size_t H = 0; H != height; ++H)
+				for (::size_t W = 0; W != width; ++W)
+					for (::size_t C = 0; C != depth; ++C)
+						(*frame)(W, H, C) = static_cast<T>(N + W + H + C);
+		}
+		auto stats = block.GetStatistics();
+		if (stats.nBytesResident > 4 * nBytesFrame || stats.nEvictions == 0 ||
+			stats.nBytesWritten == 0)
+			throw std::logic_error("OutOfCoreBlock<T>::Write()");
+
+		// Read back with a stride, so the next frames are prefetched.
+		block.ResetStatistics();
+		for (::size_t N = 0; N < nFrames; N += 3)
+		{
+			auto frame = block.Read(N);
+			if ((*frame)(width - 1, height - 1, depth - 1) !=
+				static_cast<T>(N + width + height + depth - 3))
+				throw std::logic_error("OutOfCoreBlock<T>::Read()");
+		}
+		stats = block.GetStatistics();
+		std::cout << "strided reads: hit rate = " << stats.GetHitRate() << ", prefetched = " <<
+			stats.nPrefetches << ", read = " << stats.nBytesRead << " bytes, written = " <<
+			stats.nBytesWritten << " bytes" << std::endl;
+
+		// A frame held outside the block is pinned.
+		auto pinned = block.Read(0);
+		for (::size_t N = 1; N != nFrames; ++N)
+			block.Read(N);
+		if (!block.IsResident(0) || &(*pinned)(0, 0) != &(*block.Read(0))(0, 0))
+			throw std::logic_error("OutOfCoreBlock<T>::Read()");
+		pinned.reset();
+
+		block.SetMemoryBudget(nBytesFrame);
+		if (block.GetStatistics().nFramesResident > 1)
+			throw std::logic_error("OutOfCoreBlock<T>::SetMemoryBudget()");
+
+		try
+		{
+			block.Read(nFrames);
+			throw std::logic_error("OutOfCoreBlock<T>::Read() should check the range.");
+		}
+		catch (std::out_of_range &) {}
+
+		// A frame on the file is overwritten without being read.
+		block.ResetStatistics();
+		{
+			auto frame = block.Overwrite(9);
+			for (::size_t H = 0; H != height; ++H)
+				for (::size_t W = 0; W != width; ++W)
+					for (::size_t C = 0; C != depth; ++C)
+						(*frame)(W, H, C) = static_cast<T>(2);
+		}
+		stats = block.GetStatistics();
+		if (stats.nBytesRead != 0 || stats.nHits != 0 || stats.nMisses != 0)
+			throw std::logic_error("OutOfCoreBlock<T>::Overwrite()");
+
+		block.Write(7)->operator()(0, 0) = static_cast<T>(1);
+	}
+
+	// Modified frames have been written back at the destruction.
+	{
+		OutOfCoreBlock<T> block(path, sz, nFrames, 2 * nBytesFrame, FileMode::OPEN);
+		if ((*block.Read(7))(0, 0) != static_cast<T>(1) ||
+			(*block.Read(8))(1, 0) != static_cast<T>(9) ||
+			(*block.Read(9))(width - 1, height - 1, depth - 1) != static_cast<T>(2))
+			throw std::logic_error("OutOfCoreBlock<T>(std::string, ..., FileMode::OPEN)");
+	}
+
+	try
+	{
+		OutOfCoreBlock<T> block(path, sz, nFrames + 1, nBytesFrame, FileMode::OPEN);
+		throw std::logic_error("OutOfCoreBlock<T>() should check the file size.");
+	}
+	catch (std::runtime_error &) {}
+
+	std::remove(path);
+}
+
+/** Threads write and read frames of a block whose budget holds 2 frames, so the
+modified frames are evicted and written back while the other threads access frames. */
+void TestOutOfCoreBlockThreads(void)
+{
+	using namespace Imaging;
+
+	const char *path = "test_out_of_core_block_threads.bin";
+	const Size3D< ::size_t> sz(50, 40, 2);
+	const ::size_t nBytesFrame = 50 * 40 * 2 * sizeof(int);
+	const ::size_t nFrames = 24, nThreads = 4;
+	{
+		OutOfCoreBlock<int> block(path, sz, nFrames, 2 * nBytesFrame);
+		std::vector<std::thread> threads;
+		for (::size_t I = 0; I != nThreads; ++I)
+			threads.push_back(std::thread([&block, I]()
+			{
+				for (::size_t N = I; N < nFrames; N += nThreads)
+				{
+					auto frame = block.Write(N);
+					for (::size_t H = 0; H != 40; ++H)
+						for (::size_t W = 0; W != 50; ++W)
+							(*frame)(W, H, 1) = static_cast<int>(N * 10000 + H * 50 + W);
+					frame.reset();
+					block.Read((N + 5) % nFrames);
+				}
+			}));
+		for (auto it = threads.begin(); it != threads.end(); ++it)
+			it->join();
+		block.Flush();
+
+		if (block.GetStatistics().nBytesWritten < nFrames * nBytesFrame)
+			throw std::logic_error("OutOfCoreBlock<T> on threads");
+		for (::size_t N = 0; N != nFrames; ++N)
+		{
+			auto frame = block.Read(N);
+			if ((*frame)(49, 39, 1) != static_cast<int>(N * 10000 + 39 * 50 + 49) ||
+				(*frame)(3, 2, 0) != 0)
+				throw std::logic_error("OutOfCoreBlock<T> written back on threads");
+		}
+	}
+	std::remove(path);
+}
+
+void TestOutOfCoreBlock(void)
+{
+	std::cout << std::endl << "Test for out_of_core_block.h has started." << std::endl;
+
+	TestOutOfCoreBlock<unsigned char>(64, 48, 3);
+	TestOutOfCoreBlock<float>(33, 17, 1);
+	TestOutOfCoreBlockThreads();
+
+	std::cout << std::endl << "Test for out_of_core_block.h has been completed." << std::endl;
+}
@@ -0,0 +1,205 @@
+/** This file contains the test functions to test classes and functions defined in
+raw_file.h */
+
+#include "../Imaging/raw_file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+
+template <typename T>
+void TestMappedImage(Imaging::ImageFormat fmt, Imaging::ByteOrder byteOrder)
+{
+	using namespace Imaging;
+
+	const char *path = "test_raw_file.raw";
+	const char *pathHeader = "test_raw_file.hdr";
+	const Size3D< ::size_t> sz(13, 7, 4);
+	const ::size_t headerOffset = 64;
+
+	// Write a raw file with a header block, and its ENVI header.
+	std::vector<T> data(sz.width * sz.height * sz.depth);
+	ImageView<T> view(data.data(), sz, fmt,
+		fmt == ImageFormat::BIP ? sz.width * sz.depth : sz.width);
+	for (::size_t C = 0; C != sz.depth; ++C)
+		for (::size_t H = 0; H != sz.height; ++H)
+			for (::size_t W = 0; W != sz.width; ++W)
+				view(W, H, C) = static_cast<T>(W + 20 * H + 300 * C);
+	if (byteOrder != GetNativeByteOrder())
+		SwapBytes(view);
+	{
+		std::ofstream file(path, std::ios_base::binary);
+		file << std::string(headerOffset, 'H');
+		file.write(reinterpret_cast<const char *>(data.data()), data.size() * sizeof(T));
+	}
+	{
+		std::ofstream file(pathHeader);
+		file << "ENVI" << std::endl <<
+			"description = {a test image," << std::endl << " written by TestMappedImage}" <<
+			std::endl << "samples = " << sz.width << std::endl << "lines   = " << sz.height <<
+			std::endl << "bands   = " << sz.depth << std::endl << "header offset = " <<
+			headerOffset << std::endl << "file type = ENVI Standard" << std::endl <<
+			"data type = " << (sizeof(T) == 2 ? 12 : 4) << std::endl << "interleave = " <<
+			(fmt == ImageFormat::BIP ? "bip" : fmt == ImageFormat::BSQ ? "BSQ" : "bil") <<
+			std::endl << "byte order = " << (byteOrder == ByteOrder::BIG ? 1 : 0) << std::endl;
+	}
+
+	RawFileInfo info = ReadEnviHeader(pathHeader);
+	if (info.size != sz || info.format != fmt || info.headerOffset != headerOffset ||
+		info.byteOrder != byteOrder || info.dataType != DataTypeOf<T>::value)
+		throw std::logic_error("ReadEnviHeader()");
+
+	{
+		MappedImage<T> img(path, info, AccessPattern::SEQUENTIAL);
+		if (img.size != sz || img.format != fmt ||
+			img.IsByteSwapped() != (byteOrder != GetNativeByteOrder()))
+			throw std::logic_error("MappedImage<T>(std::string, RawFileInfo)");
+
+		// An ROI is loaded with the bytes swapped if necessary.
+		Region< ::size_t, ::size_t> roi(2, 3, 9, 4);
+		img.Advise(AccessPattern::WILL_NEED, roi);
+		Image<T> img2;
+		img.Load(roi, img2);
+		for (::size_t C = 0; C != sz.depth; ++C)
+			for (::size_t H = 0; H != roi.size.height; ++H)
+				for (::size_t W = 0; W != roi.size.width; ++W)
+					if (img2(W, H, C) != static_cast<T>(W + 2 + 20 * (H + 3) + 300 * C))
+						throw std::logic_error("MappedImage<T>::Load()");
+
+		// The file is viewed without copying if the byte order is native.
+		if (!img.IsByteSwapped())
+		{
+			ImageView<const T> view2 = img.GetView();
+			if (view2(12, 6, 3) != static_cast<T>(12 + 20 * 6 + 300 * 3) ||
+				img.GetView(roi)(0, 0) != static_cast<T>(2 + 20 * 3))
+				throw std::logic_error("MappedImage<T>::GetView()");
+		}
+		else
+		{
+			bool isRejected = false;
+			try
+			{
+				img.GetView();
+			}
+			catch (std::logic_error &ex)
+			{
+				std::cout << ex.what() << std::endl;
+				isRejected = true;
+			}
+			if (!isRejected)
+				throw std::logic_error("MappedImage<T>::GetView() should fail.");
+		}
+	}
+
+	// A file smaller than the image is rejected.
+	try
+	{
+		MappedImage<T> img(path, Size3D< ::size_t>(sz.width, sz.height, sz.depth + 1), fmt,
+			headerOffset);
+		throw std::logic_error("MappedImage<T>() should check the file size.");
+	}
+	catch (std::runtime_error &) {}
+
+	std::remove(path);
+	std::remove(pathHeader);
+}
+
+template <typename T>
+void TestRawImageFile(Imaging::ImageFormat fmt, Imaging::ByteOrder byteOrder)
+{
+	using namespace Imaging;
+
+	const char *path = "test_raw_image_file.raw";
+	const Size3D< ::size_t> sz(300, 40, 6);
+	const ::size_t headerOffset = 16;
+
+	std::vector<T> data(sz.width * sz.height * sz.depth);
+	ImageView<T> view(data.data(), sz, fmt,
+		fmt == ImageFormat::BIP ? sz.width * sz.depth : sz.width);
+	for (::size_t C = 0; C != sz.depth; ++C)
+		for (::size_t H = 0; H != sz.height; ++H)
+			for (::size_t W = 0; W != sz.width; ++W)
+				view(W, H, C) = static_cast<T>(W + 300 * H + 12000 * C);
+	if (byteOrder != GetNativeByteOrder())
+		SwapBytes(view);
+	{
+		std::ofstream file(path, std::ios_base::binary);
+		file << std::string(headerOffset, 'H');
+		file.write(reinterpret_cast<const char *>(data.data()), data.size() * sizeof(T));
+	}
+
+	{
+		RawImageFile<T> file(path, sz, fmt, headerOffset, byteOrder);
+		const Region< ::size_t, ::size_t> roi(250, 5, 40, 30);
+		std::vector< ::size_t> bands;
+		bands.push_back(4);
+		bands.push_back(1);
+		bands.push_back(2);
+		bands.push_back(4);
+
+		// Lines are coalesced by default, or read one by one without a gap allowed.
+		const ::size_t nMaxGaps[] = {RawImageFile<T>::DEFAULT_MAX_GAP, 0};
+		for (auto nMaxGap : nMaxGaps)
+		{
+			file.SetMaxGap(nMaxGap);
+			file.SetBufferSize(4096);
+			file.ResetStatistics();
+			Image<T> img;
+			file.Read(roi, bands, img);
+			if (img.size != Size3D< ::size_t>(roi.size.width, roi.size.height, bands.size()) ||
+				img.format != fmt)
+				throw std::logic_error("RawImageFile<T>::Read()");
+			for (::size_t C = 0; C != bands.size(); ++C)
+				for (::size_t H = 0; H != roi.size.height; ++H)
+					for (::size_t W = 0; W != roi.size.width; ++W)
+						if (img(W, H, C) != static_cast<T>(W + 250 + 300 * (H + 5) +
+							12000 * bands[C]))
+							throw std::logic_error("RawImageFile<T>::Read()");
+
+			auto stats = file.GetStatistics();
+			std::cout << "max gap = " << nMaxGap << ": " << stats.nReads << " reads, " <<
+				stats.nBytesRead << " bytes" << std::endl;
+			if (nMaxGap == 0 && stats.nReads < roi.size.height)
+				throw std::logic_error("RawImageFile<T>::SetMaxGap()");
+		}
+
+		// All bands of the entire image.
+		Image<T> img;
+		file.Read(Region< ::size_t, ::size_t>(0, 0, sz.width, sz.height), img);
+		if (img.size != sz || img(299, 39, 5) != static_cast<T>(299 + 300 * 39 + 12000 * 5))
+			throw std::logic_error("RawImageFile<T>::Read()");
+
+		try
+		{
+			file.Read(Region< ::size_t, ::size_t>(0, 1, sz.width, sz.height), img);
+			throw std::logic_error("RawImageFile<T>::Read() should check the ROI.");
+		}
+		catch (std::out_of_range &) {}
+	}
+
+	std::remove(path);
+}
+
+void TestRawFile(void)
+{
+	using namespace Imaging;
+
+	std::cout << std::endl << "Test for raw_file.h has started." << std::endl;
+
+	if (SwapBytes<unsigned short>(0x1234) != 0x3412 || SwapBytes(SwapBytes(1.5f)) != 1.5f)
+		throw std::logic_error("SwapBytes()");
+
+	const ImageFormat fmts[] = {ImageFormat::BIP, ImageFormat::BSQ, ImageFormat::BIL};
+	for (auto fmt : fmts)
+	{
+		TestMappedImage<unsigned short>(fmt, ByteOrder::LITTLE);
+		TestMappedImage<unsigned short>(fmt, ByteOrder::BIG);
+		TestMappedImage<float>(fmt, GetNativeByteOrder());
+		TestRawImageFile<unsigned int>(fmt, ByteOrder::LITTLE);
+		TestRawImageFile<unsigned int>(fmt, ByteOrder::BIG);
+	}
+
+	std::cout << std::endl << "Test for raw_file.h has been completed." << std::endl;
+}
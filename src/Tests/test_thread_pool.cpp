@@ -0,0 +1,261 @@
+/** This file contains the test functions to test classes and functions defined in
+thread_pool.h */
+
+#include "../Imaging/thread_pool.h"
+#include "../Imaging/image2.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+void TestParallelForIndices(::size_t nThreads)
+{
+	using namespace Imaging;
+
+	SetThreadCount(nThreads);
+	if (GetThreadCount() != nThreads)
+		throw std::logic_error("SetThreadCount()");
+
+	// Every index is visited once for any grain.
+	const ::size_t grains[] = {0, 1, 7, 1000, 5000};
+	for (auto grain : grains)
+	{
+		std::vector<std::atomic<int> > counts(1000);
+		for (auto it = counts.begin(); it != counts.end(); ++it)
+			*it = 0;
+		ParallelFor(3, 1000, [&](::size_t I)
+		{
+			++counts[I];
+		}, grain);
+		for (::size_t I = 0; I != counts.size(); ++I)
+			if (counts[I] != (I < 3 ? 0 : 1))
+				throw std::logic_error("ParallelFor()");
+	}
+	ParallelFor(5, 5, [](::size_t)
+	{
+		throw std::logic_error("ParallelFor() should not call an empty range.");
+	});
+
+	// The first exception is rethrown after all tasks have finished.
+	std::atomic<int> nCalls(0);
+	try
+	{
+		ParallelFor(0, 100, [&](::size_t I)
+		{
+			++nCalls;
+			if (I == 10)
+				throw std::out_of_range("index 10");
+		}, 1);
+		throw std::logic_error("ParallelFor() should rethrow an exception.");
+	}
+	catch (std::out_of_range &) {}
+	if (nCalls == 0 || nCalls > 100)
+		throw std::logic_error("ParallelFor()");
+
+	// A nested loop runs on the same threads without a deadlock.
+	std::atomic< ::size_t> sum(0);
+	ParallelFor(0, 16, [&](::size_t I)
+	{
+		ParallelFor(0, 64, [&](::size_t J)
+		{
+			sum += I * 64 + J;
+		}, 4);
+	}, 1);
+	if (sum != 1024 * 1023 / 2)
+		throw std::logic_error("ParallelFor() nested");
+
+	// Loops started by several threads at the same time share the workers.
+	std::vector<std::thread> threads;
+	std::atomic< ::size_t> sum2(0);
+	for (::size_t N = 0; N != 3; ++N)
+		threads.push_back(std::thread([&]
+		{
+			ParallelFor(0, 1000, [&](::size_t I)
+			{
+				sum2 += I;
+			}, 10);
+		}));
+	for (auto it = threads.begin(); it != threads.end(); ++it)
+		it->join();
+	if (sum2 != 3 * 1000 * 999 / 2)
+		throw std::logic_error("ParallelFor() from several threads");
+}
+
+void TestParallelForTiles(void)
+{
+	using namespace Imaging;
+
+	// Tiles cover an ROI once, and the tiles at the edges are clipped.
+	const Region< ::size_t, ::size_t> roi(5, 3, 100, 50);
+	Image<unsigned char> img(Size3D< ::size_t>(110, 60, 1));
+	std::atomic< ::size_t> nTiles(0);
+	ParallelFor(roi, Size2D< ::size_t>(32, 16), [&](const Region< ::size_t, ::size_t> &tile)
+	{
+		if (tile.size.width > 32 || tile.size.height > 16)
+			throw std::logic_error("ParallelFor() tile size");
+		for (::size_t H = 0; H != tile.size.height; ++H)
+			for (::size_t W = 0; W != tile.size.width; ++W)
+				++img(tile.origin.x + W, tile.origin.y + H);
+		++nTiles;
+	});
+	if (nTiles != 4 * 4)
+		throw std::logic_error("ParallelFor() tiles");
+	for (::size_t H = 0; H != img.size.height; ++H)
+		for (::size_t W = 0; W != img.size.width; ++W)
+		{
+			const bool isInside = W >= 5 && W < 105 && H >= 3 && H < 53;
+			if (img(W, H) != (isInside ? 1 : 0))
+				throw std::logic_error("ParallelFor() tile coverage");
+		}
+
+	try
+	{
+		ParallelFor(roi, Size2D< ::size_t>(0, 16), [](const Region< ::size_t, ::size_t> &) {});
+		throw std::logic_error("ParallelFor() should check the tile size.");
+	}
+	catch (std::invalid_argument &ex)
+	{
+		std::cout << ex.what() << std::endl;
+	}
+}
+
+void TestParallelForFrames(void)
+{
+	using namespace Imaging;
+
+	const Size3D< ::size_t> sz(20, 10, 2);
+	ImageBlock<int> block;
+	block.Resize(sz, 9);
+	ParallelFor(block, [](::size_t N, ImageFrame<int> &frame)
+	{
+		for (::size_t H = 0; H != frame.size.height; ++H)
+			for (::size_t W = 0; W != frame.size.width; ++W)
+				frame(W, H, 1) = static_cast<int>(N);
+	});
+	std::atomic<int> sum(0);
+	const ImageBlock<int> &cblock = block;
+	ParallelFor(cblock, [&](::size_t, const ImageFrame<int> &frame)
+	{
+		sum += frame(19, 9, 1);
+	});
+	if (sum != 9 * 8 / 2 || block[4](0, 0, 0) != 0)
+		throw std::logic_error("ParallelFor(ImageBlock<T>)");
+
+	ContinuousImageBlock<int> cont(sz, 9);
+	ParallelFor(cont, [](::size_t N, const ImageView<int> &view)
+	{
+		view(3, 4, 0) = static_cast<int>(N * 2);
+	});
+	std::vector<int> spectrum(9);
+	cont.GetSpectrum(3, 4, 0, spectrum.data());
+	for (::size_t N = 0; N != spectrum.size(); ++N)
+		if (spectrum[N] != static_cast<int>(N * 2))
+			throw std::logic_error("ParallelFor(ContinuousImageBlock<T>)");
+}
+
+void TestThreadBuffer(void)
+{
+	using namespace Imaging;
+
+	// A thread gets its own object again, and a nested borrow gets a temporary one.
+	std::vector<int> *first = nullptr;
+	{
+		ThreadBuffer<std::vector<int> > buffer;
+		buffer->assign(100, 1);
+		first = &*buffer;
+		ThreadBuffer<std::vector<int> > nested;
+		if (&*nested == first || !nested->empty())
+			throw std::logic_error("ThreadBuffer<T> nested");
+	}
+	{
+		ThreadBuffer<std::vector<int> > buffer;
+		if (&*buffer != first || buffer->size() != 100)
+			throw std::logic_error("ThreadBuffer<T>");
+	}
+
+	// The workers borrow their own objects in a loop.
+	SetThreadCount(4);
+	std::mutex mutex;
+	std::vector<std::vector<int> *> objects;
+	ParallelFor(0, 64, [&](::size_t)
+	{
+		ThreadBuffer<std::vector<int> > buffer;
+		buffer->resize(10);
+		std::this_thread::yield();
+		std::lock_guard<std::mutex> lock(mutex);
+		objects.push_back(&*buffer);
+	}, 1);
+	if (objects.size() != 64)
+		throw std::logic_error("ThreadBuffer<T> in ParallelFor()");
+
+	// The objects of stopped workers and of exited threads are destroyed.
+	for (::size_t I = 0; I != 5; ++I)
+	{
+		SetThreadCount(I % 2 == 0 ? 3 : 4);
+		ParallelFor(0, 64, [](::size_t)
+		{
+			ThreadBuffer<std::vector<int> > buffer;
+			buffer->resize(10);
+			std::this_thread::yield();
+		}, 1);
+		if (ThreadBuffer<std::vector<int> >::GetObjectCount() > 4)
+			throw std::logic_error("ThreadBuffer<T> of stopped workers");
+	}
+	const ::size_t nObjects = ThreadBuffer<std::vector<int> >::GetObjectCount();
+	for (::size_t I = 0; I != 5; ++I)
+	{
+		std::thread thread([]()
+		{
+			ThreadBuffer<std::vector<int> > buffer;
+			buffer->resize(10);
+		});
+		thread.join();
+	}
+	if (ThreadBuffer<std::vector<int> >::GetObjectCount() != nObjects)
+		throw std::logic_error("ThreadBuffer<T> of exited threads");
+}
+
+void TestThreadPool(void)
+{
+	using namespace Imaging;
+
+	std::cout << std::endl << "Test for thread_pool.h has started." << std::endl;
+
+	const ::size_t nThreadsDefault = GetThreadCount();
+	const ::size_t nThreads[] = {1, 2, 4};
+	for (auto n : nThreads)
+	{
+		TestParallelForIndices(n);
+		TestParallelForTiles();
+		TestParallelForFrames();
+	}
+
+	// Pinned workers run the same loops.
+	ThreadPool &pool = ThreadPool::GetInstance();
+	pool.SetAffinity(true);
+	if (!pool.GetAffinity() || pool.GetThreadCount() != 4)
+		throw std::logic_error("ThreadPool::SetAffinity()");
+	TestParallelForIndices(4);
+	pool.SetAffinity(false);
+
+	// A private pool is independent of the shared one.
+	{
+		ThreadPool pool2(3);
+		std::atomic< ::size_t> sum(0);
+		auto add = [&](::size_t I)
+		{
+			sum += I;
+		};
+		pool2.ParallelFor(0, 100, 0, add);
+		if (pool2.GetThreadCount() != 3 || sum != 100 * 99 / 2)
+			throw std::logic_error("ThreadPool::ParallelFor()");
+	}
+
+	TestThreadBuffer();
+	SetThreadCount(nThreadsDefault);
+
+	std::cout << std::endl << "Test for thread_pool.h has been completed." << std::endl;
+}
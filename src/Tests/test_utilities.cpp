@@ -3,6 +3,8 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <string>
+#include <vector>
 
 template <typename T, typename U>
 void TestSafeCast(const T src, U &dst)
@@ -206,11 +208,53 @@ void TestStdArray(void)
 		<< std::endl;
 }
 
+/** Copies lines of ROIs for each path of CopyLines(), i.e., strided or continuous lines,
+small or large enough to be copied in parallel by non-temporal stores, and elements which
+are not trivially copyable. */
+void TestCopyLines(void)
+{
+	std::cout << "Test for CopyLines() has started." << std::endl;
+
+	const ::size_t nElemWidths[] = {1000, 2 * 1024 * 1024};
+	for (auto nElemWidth : nElemWidths)
+	{
+		const ::size_t nLines = 5;
+		std::vector<int> src((nElemWidth + 3) * nLines), dst((nElemWidth + 1) * nLines);
+		for (::size_t I = 0; I != src.size(); ++I)
+			src[I] = static_cast<int>(I);
+
+		// Strided lines.
+		Imaging::CopyLines(src.data() + 1, nElemWidth + 3, dst.data(), nElemWidth + 1,
+			nElemWidth, nLines);
+		for (::size_t H = 0; H != nLines; ++H)
+			if (dst[H * (nElemWidth + 1)] != static_cast<int>(H * (nElemWidth + 3) + 1) ||
+				dst[H * (nElemWidth + 1) + nElemWidth - 1] !=
+				static_cast<int>(H * (nElemWidth + 3) + nElemWidth))
+				throw std::logic_error("CopyLines(const T *, ..., T *, ...)");
+
+		// Continuous lines starting at an unaligned address.
+		Imaging::CopyLines(src.data() + 3, nElemWidth, dst.data() + 1, nElemWidth,
+			nElemWidth, nLines);
+		if (!std::equal(dst.begin() + 1, dst.begin() + 1 + nElemWidth * nLines,
+			src.begin() + 3))
+			throw std::logic_error("CopyLines(const T *, ..., T *, ...)");
+	}
+
+	std::vector<std::string> src(12, "line"), dst(8);
+	src[9] = "last";
+	Imaging::CopyLines(src.begin(), 3, dst.data(), 2, 2, 4);
+	if (dst[0] != "line" || dst[6] != "last")
+		throw std::logic_error("CopyLines(InputIterator, ..., T *, ...)");
+
+	std::cout << "Test for CopyLines() has been completed." << std::endl;
+}
+
 void TestUtilities(void)
 {
 	std::cout << std::endl << "Test for utilities.h has started." << std::endl;
 	TestsSafeCast();
 	TestSafeArithmetic();
 	TestStdArray();
+	TestCopyLines();
 	std::cout << "Test for utilities.h has been completed." << std::endl;
 }
\ No newline at end of file
@@ -9,17 +9,29 @@ int main(void)
 {
 	try
 	{
-		//TestUtilities();
-		//TestCoordinates();
-		//TestImage();
+		TestUtilities();
+		TestCoordinates();
+		TestImage();
+		//TestImageWithOpenCV();
 		TestImageFrame();
+		TestImageRange();
+		TestFramePool();
+		TestOutOfCoreBlock();
+		TestRawFile();
+		TestThreadPool();
+		TestImageProcessing();
+		TestImagePyramid();
+		TestFrameBatch();
 	}
 	catch (const std::exception &ex)
 	{
 		std::cout << ex.what() << std::endl;
+		return 1;
 	}
 	catch (...)
 	{
 		std::cout << "Unknown exception" << std::endl;
+		return 1;
 	}
+	return 0;
 }
\ No newline at end of file
@@ -1,4 +1,13 @@
 void TestUtilities(void);
 void TestCoordinates(void);
 void TestImage(void);
+void TestImageWithOpenCV(void);
 void TestImageFrame(void);
+void TestImageRange(void);
+void TestFramePool(void);
+void TestOutOfCoreBlock(void);
+void TestRawFile(void);
+void TestThreadPool(void);
+void TestImageProcessing(void);
+void TestImagePyramid(void);
+void TestFrameBatch(void);